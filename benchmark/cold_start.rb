@@ -0,0 +1,84 @@
+#!/usr/bin/env ruby
+# frozen_string_literal: true
+
+require_relative "helpers"
+include BenchmarkHelpers
+
+# Benchmark: Cold Start in Forked Workers
+# Measures the first request of a freshly forked worker (as in Puma cluster
+# mode or Unicorn): without preloading it builds its contexts and digests its
+# dictionaries; after VibeZstd.preload! in the master it inherits them.
+
+WORKERS = 4
+LEVELS = [3, 19].freeze
+
+BenchmarkHelpers.run_comparison(title: "Cold Start in Forked Workers") do |results|
+  dict_path = File.join(__dir__, "..", "test", "fixtures", "sample.dict")
+  unless File.exist?(dict_path)
+    puts "⚠️  Dictionary fixture not found. Run: ruby benchmark/generate_fixture.rb"
+    exit 1
+  end
+  dict_data = File.binread(dict_path)
+  payload = 20.times.map { |i| {id: i, name: "User #{i}", email: "user#{i}@example.com", status: "active"}.to_json }.join("\n")
+
+  puts "Dictionary size: #{Formatter.format_bytes(dict_data.bytesize)}"
+  puts "Payload size: #{Formatter.format_bytes(payload.bytesize)}"
+  puts "Workers per run: #{WORKERS}\n\n"
+
+  # One request: compress and decompress payload at level with the dictionary,
+  # through the shared pool. Dictionaries are digested on first use unless
+  # they were preloaded.
+  request = lambda do |dicts, level|
+    cdict = dicts[level] ||= VibeZstd::CDict.new(dict_data, level)
+    ddict = dicts[:ddict] ||= VibeZstd::DDict.new(dict_data)
+    frame = VibeZstd::Pool.default.compress(payload, dict: cdict)
+    VibeZstd::Pool.default.decompress(frame, dict: ddict)
+  end
+
+  # Fork WORKERS children; each reports the time of its first and second
+  # request (milliseconds). Returns the medians.
+  run_workers = lambda do |dicts, level|
+    readers = WORKERS.times.map do
+      reader, writer = IO.pipe
+      fork do
+        reader.close
+        first = Benchmark.realtime { request.call(dicts, level) }
+        second = Benchmark.realtime { request.call(dicts, level) }
+        writer.write([first, second].pack("E2"))
+        exit!(0)
+      end
+      writer.close
+      reader
+    end
+    times = readers.map { |reader| reader.read.unpack("E2").tap { reader.close } }
+    Process.waitall
+    median = ->(values) { values.sort[values.size / 2] * 1000 }
+    [median.call(times.map(&:first)), median.call(times.map(&:last))]
+  end
+
+  LEVELS.each do |level|
+    Formatter.section("Level #{level}: cold workers")
+    cold_first, warm = run_workers.call({}, level)
+    puts "First request: #{cold_first.round(3)} ms, second: #{warm.round(3)} ms"
+
+    Formatter.section("Level #{level}: after VibeZstd.preload!")
+    preloaded = VibeZstd.preload!(levels: [level], dicts: [dict_data])
+    dicts = {level => preloaded[:cdicts].first, :ddict => preloaded[:ddicts].first}
+    preload_first, preload_warm = run_workers.call(dicts, level)
+    puts "First request: #{preload_first.round(3)} ms, second: #{preload_warm.round(3)} ms"
+    VibeZstd::Pool.default.clear
+
+    results << BenchmarkResult.new(
+      :name => "Level #{level}, cold",
+      :iterations_per_sec => 1000 / cold_first,
+      "First request" => "#{cold_first.round(3)} ms",
+      "Warm request" => "#{warm.round(3)} ms"
+    )
+    results << BenchmarkResult.new(
+      :name => "Level #{level}, preloaded",
+      :iterations_per_sec => 1000 / preload_first,
+      "First request" => "#{preload_first.round(3)} ms",
+      "Warm request" => "#{preload_warm.round(3)} ms"
+    )
+  end
+end
@@ -52,6 +52,11 @@ benchmarks = [
     name: "Dictionary Training",
     file: "dictionary_training.rb",
     description: "Compare dictionary training algorithms"
+  },
+  {
+    name: "Cold Start",
+    file: "cold_start.rb",
+    description: "First request in forked workers, with and without preload!"
   }
 ]
 
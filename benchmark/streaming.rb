@@ -4,6 +4,7 @@
 require_relative "helpers"
 require "stringio"
 require "tempfile"
+require "etc"
 
 # Benchmark: Streaming vs One-Shot Compression
 # Compares streaming API vs convenience methods for different use cases
@@ -142,6 +143,55 @@ BenchmarkHelpers.run_comparison(title: "Streaming vs One-Shot Compression") do |
   puts "  Memory savings: #{Formatter.format_bytes(oneshot_memory - streaming_memory)} (#{((oneshot_memory - streaming_memory).to_f / oneshot_memory * 100).round(1)}%)"
 end
 
+# Thread scaling: CompressWriter releases the GVL while compressing, so
+# writers on separate threads run in parallel and other Ruby threads keep
+# getting scheduled.
+BenchmarkHelpers.run_comparison(title: "Streaming Thread Scaling") do |results|
+  payload = DataGenerator.mixed_data(size: 2_000_000)
+  chunks = payload.scan(/.{1,65536}/m)
+  puts "Per-thread payload: #{Formatter.format_bytes(payload.bytesize)} (level 9, 64KB writes)"
+  puts "CPU cores: #{Etc.nprocessors}\n\n"
+
+  compress_stream = lambda do
+    writer = VibeZstd::CompressWriter.new(StringIO.new, level: 9)
+    chunks.each { |chunk| writer.write(chunk) }
+    writer.finish
+  end
+
+  baseline = nil
+  [1, 2, 4].each do |thread_count|
+    Formatter.section("Testing: #{thread_count} writer thread(s)")
+
+    # A heartbeat thread measures how much Ruby work runs alongside the writers
+    ticks = 0
+    running = true
+    heartbeat = Thread.new do
+      while running
+        ticks += 1
+        sleep 0.001
+      end
+    end
+
+    elapsed = Benchmark.realtime do
+      thread_count.times.map { Thread.new { compress_stream.call } }.each(&:join)
+    end
+    running = false
+    heartbeat.join
+
+    throughput = payload.bytesize * thread_count / elapsed
+    baseline ||= throughput
+    puts "Completed in #{elapsed.round(3)}s (#{Formatter.format_bytes(throughput)}/s), heartbeat ticks: #{ticks}"
+
+    results << BenchmarkResult.new(
+      :name => "#{thread_count} thread(s)",
+      :iterations_per_sec => thread_count / elapsed,
+      "Throughput" => "#{Formatter.format_bytes(throughput)}/s",
+      "Scaling" => "#{(throughput / baseline).round(2)}x",
+      "Heartbeats/s" => (ticks / elapsed).round
+    )
+  end
+end
+
 puts "\n💡 When to use each approach:"
 puts "  One-shot compression (VibeZstd.compress):"
 puts "    ✓ Small data (< 1MB)"
@@ -4,6 +4,8 @@
 // TypedData type - defined in vibe_zstd.c
 extern rb_data_type_t vibe_zstd_cctx_type;
 
+static void vibe_zstd_cctx_after_fork(VALUE self, vibe_zstd_cctx* cctx);
+
 // Helper to set CCtx parameter from Ruby keyword argument
 static int
 vibe_zstd_cctx_init_param_iter(VALUE key, VALUE value, VALUE self) {
@@ -44,6 +46,17 @@ vibe_zstd_cctx_estimate_memory(VALUE self, VALUE level) {
     return SIZET2NUM(estimate);
 }
 
+// CCtx#memory_size - Bytes currently allocated by this context
+// (ZSTD_sizeof_CCtx). The workspace grows to fit the largest level and window
+// the context has compressed with and is kept until the context is freed.
+static VALUE
+vibe_zstd_cctx_memory_size(VALUE self) {
+    vibe_zstd_cctx* cctx;
+    TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+    vibe_zstd_cctx_after_fork(self, cctx);
+    return SIZET2NUM(ZSTD_sizeof_CCtx(cctx->cctx));
+}
+
 // Compress args for GVL release
 // This structure packages all arguments needed for compression so we can
 // call ZSTD functions without holding Ruby's Global VM Lock (GVL).
@@ -72,98 +85,240 @@ compress_without_gvl(void* arg) {
     return NULL;
 }
 
-// CCtx compress - Compress data using this context
-//
-// Honors all parameters configured on the context (sticky parameters), e.g.
-// compression_level, checksum_flag, window_log, workers, etc.
-//
-// Supports per-operation overrides via keyword arguments:
-// - level: Compression level for this call only (restored afterward)
-// - dict: CDict to use for this call only (un-referenced afterward)
-// - pledged_size: Expected input size (enforced; resets after the frame)
-//
-// Per-call overrides are applied around the compression and then restored so
-// repeated one-shot calls on the same context remain independent.
-//
-// Uses ZSTD_compressBound to allocate worst-case output buffer size,
-// which is the recommended approach for one-shot compression.
-// Releases GVL during compression to allow other Ruby threads to run.
-static VALUE
-vibe_zstd_cctx_compress(int argc, VALUE* argv, VALUE self) {
-    VALUE data, options = Qnil;
-    rb_scan_args(argc, argv, "1:", &data, &options);
-    vibe_zstd_cctx* cctx;
-    TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
-    StringValue(data);
-
-    // Extract keyword arguments (all optional, all per-call overrides)
-    int has_level = 0;
-    int lvl = 0;
-    ZSTD_CDict* cdict = NULL;
-    int has_pledged = 0;
-    unsigned long long pledged_size = ZSTD_CONTENTSIZE_UNKNOWN;
+// Per-call overrides accepted by compress / compress_batch.
+// Parsed once per Ruby call, applied to the context around the compression and
+// restored afterward so repeated one-shot calls on the same context remain
+// independent.
+typedef struct {
+    int has_level;
+    int level;
+    int prev_level;
+    ZSTD_CDict* cdict;
+    int has_pledged;
+    unsigned long long pledged_size;
+    long auto_max_workers;  // workers = :auto: most workers to pick (0 = off)
+    int auto_pool_workers;  // workers = :auto on a ThreadPool: the nbWorkers to use (0 = no pool)
+} cctx_call_opts;
 
-    if (!NIL_P(options)) {
-        VALUE level_val = rb_hash_aref(options, ID2SYM(rb_intern("level")));
-        if (!NIL_P(level_val)) {
-            has_level = 1;
-            lvl = NUM2INT(level_val);
-        }
+static void
+cctx_parse_call_opts(VALUE options, cctx_call_opts* opts) {
+    opts->has_level = 0;
+    opts->level = 0;
+    opts->prev_level = 0;
+    opts->cdict = NULL;
+    opts->has_pledged = 0;
+    opts->pledged_size = ZSTD_CONTENTSIZE_UNKNOWN;
+    opts->auto_max_workers = 0;
+    opts->auto_pool_workers = 0;
+
+    if (NIL_P(options)) return;
+
+    VALUE level_val = rb_hash_aref(options, ID2SYM(rb_intern("level")));
+    if (!NIL_P(level_val)) {
+        opts->has_level = 1;
+        opts->level = NUM2INT(level_val);
+    }
 
-        VALUE dict_val = rb_hash_aref(options, ID2SYM(rb_intern("dict")));
-        if (!NIL_P(dict_val)) {
-            vibe_zstd_cdict* cdict_struct;
-            TypedData_Get_Struct(dict_val, vibe_zstd_cdict, &vibe_zstd_cdict_type, cdict_struct);
-            cdict = cdict_struct->cdict;
-        }
+    VALUE dict_val = rb_hash_aref(options, ID2SYM(rb_intern("dict")));
+    if (!NIL_P(dict_val)) {
+        vibe_zstd_cdict* cdict_struct;
+        TypedData_Get_Struct(dict_val, vibe_zstd_cdict, &vibe_zstd_cdict_type, cdict_struct);
+        opts->cdict = cdict_struct->cdict;
+    }
 
-        VALUE pledged_size_val = rb_hash_aref(options, ID2SYM(rb_intern("pledged_size")));
-        if (!NIL_P(pledged_size_val)) {
-            has_pledged = 1;
-            pledged_size = NUM2ULL(pledged_size_val);
-        }
+    VALUE pledged_size_val = rb_hash_aref(options, ID2SYM(rb_intern("pledged_size")));
+    if (!NIL_P(pledged_size_val)) {
+        opts->has_pledged = 1;
+        opts->pledged_size = NUM2ULL(pledged_size_val);
     }
+}
+
+// Undo cctx_apply_call_opts: un-reference the per-call dictionary and restore
+// the context's configured level.
+static void
+cctx_restore_call_opts(ZSTD_CCtx* zcctx, const cctx_call_opts* opts) {
+    if (opts->cdict) ZSTD_CCtx_refCDict(zcctx, NULL);
+    if (opts->has_level) ZSTD_CCtx_setParameter(zcctx, ZSTD_c_compressionLevel, opts->prev_level);
+}
 
+// Apply per-call overrides to the context. On failure, anything already applied
+// is rolled back before raising.
+static void
+cctx_apply_call_opts(ZSTD_CCtx* zcctx, cctx_call_opts* opts) {
     // Apply per-call compression level override without permanently mutating the
     // context's configured level. The previous value is captured and restored.
-    int prev_level = 0;
-    if (has_level) {
-        size_t gp = ZSTD_CCtx_getParameter(cctx->cctx, ZSTD_c_compressionLevel, &prev_level);
+    if (opts->has_level) {
+        size_t gp = ZSTD_CCtx_getParameter(zcctx, ZSTD_c_compressionLevel, &opts->prev_level);
         if (ZSTD_isError(gp)) {
             rb_raise(rb_eRuntimeError, "Failed to read compression level: %s", ZSTD_getErrorName(gp));
         }
-        size_t sp = ZSTD_CCtx_setParameter(cctx->cctx, ZSTD_c_compressionLevel, lvl);
+        size_t sp = ZSTD_CCtx_setParameter(zcctx, ZSTD_c_compressionLevel, opts->level);
         if (ZSTD_isError(sp)) {
-            rb_raise(rb_eArgError, "Invalid level %d: %s", lvl, ZSTD_getErrorName(sp));
+            rb_raise(rb_eArgError, "Invalid level %d: %s", opts->level, ZSTD_getErrorName(sp));
         }
     }
 
     // Reference a per-call dictionary; un-referenced after compression so the
     // context returns to no-dictionary mode for subsequent calls.
-    if (cdict) {
-        size_t rc = ZSTD_CCtx_refCDict(cctx->cctx, cdict);
+    if (opts->cdict) {
+        size_t rc = ZSTD_CCtx_refCDict(zcctx, opts->cdict);
         if (ZSTD_isError(rc)) {
-            if (has_level) ZSTD_CCtx_setParameter(cctx->cctx, ZSTD_c_compressionLevel, prev_level);
+            if (opts->has_level) ZSTD_CCtx_setParameter(zcctx, ZSTD_c_compressionLevel, opts->prev_level);
             rb_raise(rb_eRuntimeError, "Failed to set dictionary: %s", ZSTD_getErrorName(rc));
         }
     }
 
     // Set pledged size if provided (resets to UNKNOWN automatically after the frame)
-    if (has_pledged) {
-        size_t sps = ZSTD_CCtx_setPledgedSrcSize(cctx->cctx, pledged_size);
+    if (opts->has_pledged) {
+        size_t sps = ZSTD_CCtx_setPledgedSrcSize(zcctx, opts->pledged_size);
         if (ZSTD_isError(sps)) {
-            if (cdict) ZSTD_CCtx_refCDict(cctx->cctx, NULL);
-            if (has_level) ZSTD_CCtx_setParameter(cctx->cctx, ZSTD_c_compressionLevel, prev_level);
-            rb_raise(rb_eRuntimeError, "Failed to set pledged_size %llu: %s", pledged_size, ZSTD_getErrorName(sps));
+            cctx_restore_call_opts(zcctx, opts);
+            rb_raise(rb_eRuntimeError, "Failed to set pledged_size %llu: %s", opts->pledged_size, ZSTD_getErrorName(sps));
         }
     }
+}
+
+// workers = :auto
+//
+// Smallest input a worker is given at each level. Below 2 * this the frame
+// stays single-threaded: handing out jobs, re-reading each job's overlap and
+// (on first use) building the multi-threading state costs more than it saves.
+// Faster levels need larger jobs to amortize that fixed cost; at level 19 a
+// ZSTDMT_JOBSIZE_MIN (512 KiB) job already takes tens of milliseconds.
+#define VIBE_ZSTD_AUTO_JOB_MIN_FAST (2 << 20)   // levels <= 3 (and negative)
+#define VIBE_ZSTD_AUTO_JOB_MIN_MID  (1 << 20)   // levels 4-9
+#define VIBE_ZSTD_AUTO_JOB_MIN_HIGH (512 << 10) // levels >= 10
+
+// Record that this call picks its own workers, and how many it may use: the
+// attached ThreadPool's size, else the online CPUs. On a pool nbWorkers only
+// ever switches between 0 and the pool's size (see
+// vibe_zstd_thread_pool_workers); the pick then sets just the job size.
+static void
+cctx_prepare_auto_workers(VALUE self, vibe_zstd_cctx* cctx, cctx_call_opts* opts) {
+    if (!cctx->auto_workers) return;
+    VALUE thread_pool = rb_attr_get(self, rb_intern("@thread_pool"));
+    long max_workers;
+    if (!NIL_P(thread_pool)) {
+        vibe_zstd_thread_pool* tp;
+        TypedData_Get_Struct(thread_pool, vibe_zstd_thread_pool, &vibe_zstd_thread_pool_type, tp);
+        max_workers = (long)tp->threads;
+        opts->auto_pool_workers = vibe_zstd_thread_pool_workers(thread_pool, 1);
+    } else {
+        max_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    opts->auto_max_workers = max_workers > 1 ? max_workers : 1;
+}
+
+// Pick nbWorkers and jobSize for an input of src_size bytes at level. Splits
+// the input into one job per worker, but never below the level's minimum job
+// size, and leaves jobSize to zstd (0: 4x the window) once that already yields
+// a job per worker.
+static void
+cctx_auto_workers_pick(int level, size_t src_size, long max_workers, int* workers_out, size_t* job_size_out) {
+    if (level == 0) level = ZSTD_CLEVEL_DEFAULT;
+    size_t min_job = level <= 3 ? VIBE_ZSTD_AUTO_JOB_MIN_FAST
+                   : level <= 9 ? VIBE_ZSTD_AUTO_JOB_MIN_MID
+                   : VIBE_ZSTD_AUTO_JOB_MIN_HIGH;
+    size_t workers = src_size / min_job;
+    if (workers > (size_t)max_workers) workers = (size_t)max_workers;
+    *workers_out = 0;
+    *job_size_out = 0;
+    if (workers < 2) return;
+
+    ZSTD_compressionParameters cparams = ZSTD_getCParams(level, src_size, 0);
+    unsigned job_log = cparams.windowLog + 2 > 20 ? cparams.windowLog + 2 : 20;
+    // Rounds up without src_size + workers overflowing on SIZE_MAX (unknown size)
+    size_t job_size = src_size / workers + (src_size % workers != 0);
+    if (job_size >= ((size_t)1 << job_log)) {
+        job_size = 0;
+    } else if (job_size < min_job) {
+        job_size = min_job;
+    }
+    *workers_out = (int)workers;
+    *job_size_out = job_size;
+}
+
+// Apply the pick for this call's input at the context's current level. Plain
+// C, so compress_batch can call it between frames without the GVL.
+static void
+cctx_apply_auto_workers(ZSTD_CCtx* zcctx, const cctx_call_opts* opts, size_t src_size) {
+    if (!opts->auto_max_workers) return;
+    int level = ZSTD_CLEVEL_DEFAULT;
+    ZSTD_CCtx_getParameter(zcctx, ZSTD_c_compressionLevel, &level);
+    int workers;
+    size_t job_size;
+    cctx_auto_workers_pick(level, src_size, opts->auto_max_workers, &workers, &job_size);
+    // The job size still splits the input into the picked number of jobs
+    if (workers && opts->auto_pool_workers) workers = opts->auto_pool_workers;
+    ZSTD_CCtx_setParameter(zcctx, ZSTD_c_nbWorkers, workers);
+    if (workers) ZSTD_CCtx_setParameter(zcctx, ZSTD_c_jobSize, (int)job_size);
+}
+
+// CCtx.auto_workers(size, level: 3, threads: nil) - What workers = :auto picks
+// for an input of size bytes: { workers:, job_size: } (job_size 0 = zstd's
+// default). threads is the cap, default the online CPUs.
+static VALUE
+vibe_zstd_cctx_s_auto_workers(int argc, VALUE* argv, VALUE klass) {
+    VALUE size_val, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &size_val, &options);
+    int level = ZSTD_CLEVEL_DEFAULT;
+    long max_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (!NIL_P(options)) {
+        VALUE level_val = rb_hash_aref(options, ID2SYM(rb_intern("level")));
+        if (!NIL_P(level_val)) level = NUM2INT(level_val);
+        VALUE threads_val = rb_hash_aref(options, ID2SYM(rb_intern("threads")));
+        if (!NIL_P(threads_val)) max_workers = NUM2LONG(threads_val);
+    }
+    if (max_workers < 1) max_workers = 1;
+
+    int workers;
+    size_t job_size;
+    cctx_auto_workers_pick(level, NUM2SIZET(size_val), max_workers, &workers, &job_size);
+    VALUE result = rb_hash_new();
+    rb_hash_aset(result, ID2SYM(rb_intern("workers")), INT2NUM(workers));
+    rb_hash_aset(result, ID2SYM(rb_intern("job_size")), SIZET2NUM(job_size));
+    return result;
+}
+
+// CCtx compress - Compress data using this context
+//
+// Honors all parameters configured on the context (sticky parameters), e.g.
+// compression_level, checksum_flag, window_log, workers, etc.
+//
+// Supports per-operation overrides via keyword arguments:
+// - level: Compression level for this call only (restored afterward)
+// - dict: CDict to use for this call only (un-referenced afterward)
+// - pledged_size: Expected input size (enforced; resets after the frame)
+//
+// Per-call overrides are applied around the compression and then restored so
+// repeated one-shot calls on the same context remain independent.
+//
+// Uses ZSTD_compressBound to allocate worst-case output buffer size,
+// which is the recommended approach for one-shot compression.
+// Releases GVL during compression to allow other Ruby threads to run.
+static VALUE
+vibe_zstd_cctx_compress(int argc, VALUE* argv, VALUE self) {
+    VALUE data, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &data, &options);
+    vibe_zstd_cctx* cctx;
+    TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+    vibe_zstd_cctx_after_fork(self, cctx);
+    const char* src;
+    size_t srcSize;
+    data = vibe_zstd_input_bytes(data, &src, &srcSize);
+
+    // Extract keyword arguments (all optional, all per-call overrides)
+    cctx_call_opts opts;
+    cctx_parse_call_opts(options, &opts);
+    cctx_prepare_auto_workers(self, cctx, &opts);
+    cctx_apply_call_opts(cctx->cctx, &opts);
+    cctx_apply_auto_workers(cctx->cctx, &opts, srcSize);
 
-    size_t srcSize = RSTRING_LEN(data);
     size_t dstCapacity = ZSTD_compressBound(srcSize);
     VALUE result_str = rb_str_new(NULL, dstCapacity);
     compress_args args = {
         .cctx = cctx->cctx,
-        .src = RSTRING_PTR(data),
+        .src = src,
         .srcSize = srcSize,
         .dst = RSTRING_PTR(result_str),
         .dstCapacity = dstCapacity,
@@ -178,8 +333,7 @@ vibe_zstd_cctx_compress(int argc, VALUE* argv, VALUE self) {
     vibe_zstd_nogvl_with_str_locked(compress_without_gvl, &args, data);
 
     // Restore context state so repeated one-shot calls remain independent.
-    if (cdict) ZSTD_CCtx_refCDict(cctx->cctx, NULL);
-    if (has_level) ZSTD_CCtx_setParameter(cctx->cctx, ZSTD_c_compressionLevel, prev_level);
+    cctx_restore_call_opts(cctx->cctx, &opts);
 
     if (ZSTD_isError(args.result)) {
         rb_raise(rb_eRuntimeError, "Compression failed: %s", ZSTD_getErrorName(args.result));
@@ -188,6 +342,231 @@ vibe_zstd_cctx_compress(int argc, VALUE* argv, VALUE self) {
     return result_str;
 }
 
+// CCtx compress_into - Compress data into a caller-supplied String or IO::Buffer
+//
+// Same options and behavior as compress, but the frame replaces the contents
+// of dst instead of a new String, and the compressed size is returned. A String
+// dst is grown to ZSTD_compressBound(data.bytesize) only when its capacity is
+// smaller, so one buffer reused in a loop removes the per-call allocation. An
+// IO::Buffer dst is written from offset 0 and never resized; if the frame does
+// not fit, ArgumentError is raised.
+//
+// Both strings are locked while the GVL is released; passing a dst another
+// thread is currently filling raises instead of racing on its memory.
+static VALUE
+vibe_zstd_cctx_compress_into(int argc, VALUE* argv, VALUE self) {
+    VALUE data, dst, options = Qnil;
+    rb_scan_args(argc, argv, "2:", &data, &dst, &options);
+    vibe_zstd_cctx* cctx;
+    TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+    vibe_zstd_cctx_after_fork(self, cctx);
+    const char* src;
+    size_t srcSize;
+    data = vibe_zstd_input_bytes(data, &src, &srcSize);
+
+    cctx_call_opts opts;
+    cctx_parse_call_opts(options, &opts);
+
+    char* out;
+    size_t dstCapacity = ZSTD_compressBound(srcSize);
+    int fixed = vibe_zstd_output_target(data, dst, &out, &dstCapacity);
+    cctx_prepare_auto_workers(self, cctx, &opts);
+    cctx_apply_call_opts(cctx->cctx, &opts);
+    cctx_apply_auto_workers(cctx->cctx, &opts, srcSize);
+
+    compress_args args = {
+        .cctx = cctx->cctx,
+        .src = src,
+        .srcSize = srcSize,
+        .dst = out,
+        .dstCapacity = dstCapacity,
+        .result = 0
+    };
+    vibe_zstd_nogvl_with_strs_locked(compress_without_gvl, &args, data, dst);
+
+    cctx_restore_call_opts(cctx->cctx, &opts);
+
+    if (ZSTD_isError(args.result)) {
+        if (!fixed) rb_str_set_len(dst, 0);
+        if (fixed && ZSTD_getErrorCode(args.result) == ZSTD_error_dstSize_tooSmall) {
+            rb_raise(rb_eArgError, "Output buffer too small (%zu bytes)", dstCapacity);
+        }
+        rb_raise(rb_eRuntimeError, "Compression failed: %s", ZSTD_getErrorName(args.result));
+    }
+    if (!fixed) rb_str_set_len(dst, args.result);
+    return SIZET2NUM(args.result);
+}
+
+// One entry of a compress_batch call: a pinned source buffer and its presized
+// output buffer. result holds the ZSTD_compress2 return value once run.
+//
+// source and output are the Strings behind src and dst. Jobs live in ALLOCV
+// memory, which GC scans conservatively, so holding them here pins them:
+// compaction (GC.compact from another thread, or auto-compaction) cannot move
+// an embedded String while the workers write through dst without the GVL.
+typedef struct {
+    VALUE source;
+    VALUE output;
+    const char* src;
+    size_t src_size;
+    char* dst;
+    size_t dst_capacity;
+    size_t result;
+} compress_batch_job;
+
+// Batch compress args for GVL release. next is the index of the first job not
+// yet run, so an interrupted section can resume where it stopped.
+typedef struct {
+    ZSTD_CCtx* cctx;
+    const cctx_call_opts* opts;
+    compress_batch_job* jobs;
+    long count;
+    long next;
+    volatile int interrupted;
+} compress_batch_args;
+
+// Run every remaining job back-to-back against the same context without the
+// GVL. Stops at the first error (leaving next pointing at the failed job) or
+// when the unblocking function asks us to return to Ruby.
+static void*
+compress_batch_without_gvl(void* arg) {
+    compress_batch_args* args = arg;
+    while (args->next < args->count && !args->interrupted) {
+        compress_batch_job* job = &args->jobs[args->next];
+        cctx_apply_auto_workers(args->cctx, args->opts, job->src_size);
+        job->result = ZSTD_compress2(args->cctx, job->dst, job->dst_capacity, job->src, job->src_size);
+        if (ZSTD_isError(job->result)) break;
+        args->next++;
+    }
+    return NULL;
+}
+
+// Unblocking function: a batch can run for a long time, so let Thread#raise,
+// Thread#kill and signal handlers in between jobs instead of after the batch.
+static void
+compress_batch_ubf(void* arg) {
+    compress_batch_args* args = arg;
+    args->interrupted = 1;
+}
+
+// State for the rb_ensure-wrapped batch: the per-call overrides must be
+// restored on every exit, including async exceptions between jobs.
+typedef struct {
+    vibe_zstd_cctx* cctx;
+    cctx_call_opts* opts;
+    compress_batch_args* args;
+} cctx_batch_state;
+
+static VALUE
+vibe_zstd_cctx_compress_batch_body(VALUE p) {
+    cctx_batch_state* state = (cctx_batch_state*)p;
+    compress_batch_args* args = state->args;
+
+    cctx_apply_call_opts(state->cctx->cctx, state->opts);
+
+    // Re-enter the no-GVL section if an interrupt was serviced without raising
+    // (e.g. a trap handler ran); a raising interrupt leaves through rb_ensure.
+    while (args->next < args->count) {
+        args->interrupted = 0;
+        vibe_zstd_call_without_gvl(compress_batch_without_gvl, args, compress_batch_ubf, args);
+        if (args->next < args->count && ZSTD_isError(args->jobs[args->next].result)) {
+            rb_raise(rb_eRuntimeError, "Compression failed at index %ld: %s",
+                     args->next, ZSTD_getErrorName(args->jobs[args->next].result));
+        }
+    }
+    return Qnil;
+}
+
+static VALUE
+vibe_zstd_cctx_compress_batch_restore(VALUE p) {
+    cctx_batch_state* state = (cctx_batch_state*)p;
+    cctx_restore_call_opts(state->cctx->cctx, state->opts);
+    return Qnil;
+}
+
+// CCtx compress_batch - Compress an Array of Strings in one GVL release
+//
+// Equivalent to array.map { |s| compress(s, level:, dict:) }, but keyword
+// arguments are parsed once, every output buffer is presized up front, and all
+// frames are produced back-to-back in a single rb_thread_call_without_gvl
+// section instead of one GVL hand-off per element.
+//
+// Inputs are pinned with frozen snapshots (rb_str_new_frozen) rather than
+// rb_str_locktmp: the same String may legitimately appear several times in a
+// batch, and a second locktmp on it would raise.
+//
+// pledged_size is per-frame and therefore not accepted here.
+static VALUE
+vibe_zstd_cctx_compress_batch(int argc, VALUE* argv, VALUE self) {
+    VALUE inputs, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &inputs, &options);
+    vibe_zstd_cctx* cctx;
+    TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+    vibe_zstd_cctx_after_fork(self, cctx);
+    Check_Type(inputs, T_ARRAY);
+
+    cctx_call_opts opts;
+    cctx_parse_call_opts(options, &opts);
+    if (opts.has_pledged) {
+        rb_raise(rb_eArgError, "pledged_size is not supported by compress_batch");
+    }
+    cctx_prepare_auto_workers(self, cctx, &opts);
+
+    long count = RARRAY_LEN(inputs);
+    VALUE sources = rb_ary_new_capa(count);
+    VALUE results = rb_ary_new_capa(count);
+    VALUE jobs_buf;
+    compress_batch_job* jobs = ALLOCV_N(compress_batch_job, jobs_buf, count);
+
+    // Validate and pin every input and presize every output before releasing
+    // the GVL. Converted snapshots are kept in a private array so neither a
+    // to_str conversion nor a later mutation of the caller's array matters.
+    for (long i = 0; i < count; i++) {
+        VALUE data = rb_ary_entry(inputs, i);
+        StringValue(data);
+        data = rb_str_new_frozen(data);
+        rb_ary_push(sources, data);
+
+        size_t src_size = RSTRING_LEN(data);
+        size_t dst_capacity = ZSTD_compressBound(src_size);
+        VALUE result_str = rb_str_new(NULL, dst_capacity);
+        rb_ary_push(results, result_str);
+
+        jobs[i].source = data;
+        jobs[i].output = result_str;
+        jobs[i].src_size = src_size;
+        jobs[i].dst_capacity = dst_capacity;
+        jobs[i].result = 0;
+    }
+    // Take the buffer pointers only once nothing else is allocated: every
+    // allocation above may run GC, and compaction moves embedded Strings.
+    for (long i = 0; i < count; i++) {
+        jobs[i].src = RSTRING_PTR(jobs[i].source);
+        jobs[i].dst = RSTRING_PTR(jobs[i].output);
+    }
+
+    compress_batch_args args = {
+        .cctx = cctx->cctx,
+        .opts = &opts,
+        .jobs = jobs,
+        .count = count,
+        .next = 0,
+        .interrupted = 0
+    };
+    cctx_batch_state state = { cctx, &opts, &args };
+    rb_ensure(vibe_zstd_cctx_compress_batch_body, (VALUE)&state,
+              vibe_zstd_cctx_compress_batch_restore, (VALUE)&state);
+
+    for (long i = 0; i < count; i++) {
+        rb_str_set_len(RARRAY_AREF(results, i), jobs[i].result);
+    }
+
+    ALLOCV_END(jobs_buf);
+    RB_GC_GUARD(sources);
+    RB_GC_GUARD(results);
+    return results;
+}
+
 // Parameter lookup table for CCtx
 typedef struct {
     ID symbol_id;
@@ -237,7 +616,8 @@ static cctx_param_entry cctx_param_table[] = {
 
 #define CCTX_PARAM_TABLE_SIZE (sizeof(cctx_param_table) / sizeof(cctx_param_entry))
 
-// Initialize parameter lookup table symbol IDs
+// Initialize parameter lookup table symbol IDs. Runs once from Init, before
+// any other Ractor can exist; the table is only read afterwards.
 static void
 init_cctx_param_table(void) {
     for (size_t i = 0; i < CCTX_PARAM_TABLE_SIZE; i++) {
@@ -260,6 +640,82 @@ lookup_cctx_param(ID symbol_id, ZSTD_cParameter* param_out, const char** name_ou
     return 0;
 }
 
+// Copy every parameter in cctx_param_table that differs from dst's default
+// from src to dst. For a stream, the stable-buffer modes are rejected: the
+// writer moves its output buffer and feeds each write from a different string.
+static void
+cctx_copy_params(ZSTD_CCtx* dst, ZSTD_CCtx* src, int streaming) {
+    for (size_t i = 0; i < CCTX_PARAM_TABLE_SIZE; i++) {
+        const cctx_param_entry* entry = &cctx_param_table[i];
+        int value, current;
+        if (ZSTD_isError(ZSTD_CCtx_getParameter(src, entry->param, &value))) continue;
+        if (ZSTD_isError(ZSTD_CCtx_getParameter(dst, entry->param, &current))) continue;
+        if (value == current) continue;
+        if (streaming && (entry->param == ZSTD_c_stableInBuffer || entry->param == ZSTD_c_stableOutBuffer)) {
+            rb_raise(rb_eArgError, "%s is not supported for streaming", entry->name);
+        }
+        size_t result = ZSTD_CCtx_setParameter(dst, entry->param, value);
+        if (ZSTD_isError(result)) {
+            rb_raise(rb_eRuntimeError, "Failed to set %s: %s", entry->name, ZSTD_getErrorName(result));
+        }
+    }
+}
+
+// A context configured for worker threads (or attached to a ThreadPool) in the
+// parent cannot be used in a forked child: its threads are gone, and the next
+// multi-threaded compression would wait for them forever. Replace it with a
+// fresh context with the same parameters and ThreadPool (rebuilt too); the
+// old one is abandoned, see vibe_zstd_cctx_free. Called with the GVL at the
+// start of every call that compresses or inspects the context's state.
+static void
+vibe_zstd_cctx_after_fork(VALUE self, vibe_zstd_cctx* cctx) {
+    if (!cctx->pid || cctx->pid == getpid()) return;
+    ZSTD_CCtx* fresh = ZSTD_createCCtx_advanced(vibe_zstd_custom_mem);
+    if (!fresh) {
+        rb_raise(rb_eRuntimeError, "Failed to create ZSTD_CCtx");
+    }
+    ZSTD_CCtx* stale = cctx->cctx;
+    cctx->cctx = fresh;
+    cctx->pid = getpid();
+    cctx_copy_params(fresh, stale, 0);
+    VALUE thread_pool = rb_attr_get(self, rb_intern("@thread_pool"));
+    if (!NIL_P(thread_pool)) {
+        vibe_zstd_thread_pool_ref(self, fresh, thread_pool);
+    }
+    vibe_zstd_mem_flush();
+}
+
+// Configure dst, a fresh streaming context, like the CCtx object src: every
+// parameter in cctx_param_table that differs from dst's default is copied,
+// src's ThreadPool is shared (retained on owner), and workers = :auto is
+// resolved once for a stream of size bytes (unknown: assumed large) at the
+// stream's level (level, or src's when nil). CompressWriter uses this so a
+// stream is set up exactly like a one-shot context without the two sharing
+// session state.
+static void
+vibe_zstd_cctx_configure_stream(VALUE owner, ZSTD_CCtx* dst, VALUE src, VALUE level, unsigned long long size) {
+    vibe_zstd_cctx* cctx;
+    TypedData_Get_Struct(src, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+
+    cctx_copy_params(dst, cctx->cctx, 1);
+    if (!NIL_P(level)) {
+        size_t result = ZSTD_CCtx_setParameter(dst, ZSTD_c_compressionLevel, NUM2INT(level));
+        if (ZSTD_isError(result)) {
+            rb_raise(rb_eRuntimeError, "Failed to set compression level: %s", ZSTD_getErrorName(result));
+        }
+    }
+
+    VALUE thread_pool = rb_attr_get(src, rb_intern("@thread_pool"));
+    if (!NIL_P(thread_pool)) {
+        vibe_zstd_thread_pool_ref(owner, dst, thread_pool);
+    }
+
+    cctx_call_opts opts;
+    cctx_parse_call_opts(Qnil, &opts);
+    cctx_prepare_auto_workers(src, cctx, &opts);
+    cctx_apply_auto_workers(dst, &opts, size == ZSTD_CONTENTSIZE_UNKNOWN ? SIZE_MAX : (size_t)size);
+}
+
 // Generic setter with bounds checking
 static VALUE
 vibe_zstd_cctx_set_param_generic(VALUE self, VALUE value, ZSTD_cParameter param, const char* param_name) {
@@ -281,11 +737,20 @@ vibe_zstd_cctx_set_param_generic(VALUE self, VALUE value, ZSTD_cParameter param,
                  param_name, bounds.lowerBound, bounds.upperBound, val);
     }
 
+    // On a ThreadPool, workers > 0 always means the pool's size
+    if (param == ZSTD_c_nbWorkers) {
+        val = vibe_zstd_thread_pool_workers(rb_attr_get(self, rb_intern("@thread_pool")), val);
+    }
+
     size_t result = ZSTD_CCtx_setParameter(cctx->cctx, param, val);
     if (ZSTD_isError(result)) {
         rb_raise(rb_eRuntimeError, "Failed to set %s: %s",
                  param_name, ZSTD_getErrorName(result));
     }
+    if (param == ZSTD_c_nbWorkers) {
+        cctx->auto_workers = 0;
+        if (val > 0) cctx->pid = getpid();
+    }
 
     return self;
 }
@@ -396,7 +861,33 @@ DEFINE_CCTX_PARAM_ACCESSORS(ldm_hash_rate_log, ZSTD_c_ldmHashRateLog, "ldm_hash_
 DEFINE_CCTX_PARAM_BOOL_ACCESSORS(content_size_flag, ZSTD_c_contentSizeFlag, "content_size_flag")
 DEFINE_CCTX_PARAM_BOOL_ACCESSORS(checksum_flag, ZSTD_c_checksumFlag, "checksum_flag")
 DEFINE_CCTX_PARAM_BOOL_ACCESSORS(dict_id_flag, ZSTD_c_dictIDFlag, "dict_id_flag")
-DEFINE_CCTX_PARAM_ACCESSORS(workers, ZSTD_c_nbWorkers, "workers")
+// CCtx#workers= also accepts :auto: every compress / compress_into /
+// compress_batch / compress_file call then picks nbWorkers and jobSize for its
+// input (see cctx_apply_auto_workers). Setting a number turns it off again.
+static VALUE
+vibe_zstd_cctx_set_workers(VALUE self, VALUE value) {
+    if (SYMBOL_P(value)) {
+        if (SYM2ID(value) != rb_intern("auto")) {
+            rb_raise(rb_eArgError, "workers must be an Integer or :auto (got %+"PRIsVALUE")", value);
+        }
+        vibe_zstd_cctx* cctx;
+        TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+        cctx->auto_workers = 1;
+        cctx->pid = getpid();
+        return self;
+    }
+    return vibe_zstd_cctx_set_param_generic(self, value, ZSTD_c_nbWorkers, "workers");
+}
+
+// CCtx#workers - :auto, or the configured worker count
+static VALUE
+vibe_zstd_cctx_get_workers(VALUE self) {
+    vibe_zstd_cctx* cctx;
+    TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+    if (cctx->auto_workers) return ID2SYM(rb_intern("auto"));
+    return vibe_zstd_cctx_get_param_generic(self, ZSTD_c_nbWorkers, "workers");
+}
+
 DEFINE_CCTX_PARAM_ACCESSORS(job_size, ZSTD_c_jobSize, "job_size")
 DEFINE_CCTX_PARAM_ACCESSORS(overlap_log, ZSTD_c_overlapLog, "overlap_log")
 DEFINE_CCTX_PARAM_BOOL_ACCESSORS(rsyncable, ZSTD_c_rsyncable, "rsyncable")
@@ -487,6 +978,7 @@ vibe_zstd_cctx_reset(int argc, VALUE* argv, VALUE self) {
     if (ZSTD_isError(result)) {
         rb_raise(rb_eRuntimeError, "Failed to reset compression context: %s", ZSTD_getErrorName(result));
     }
+    if (directive != ZSTD_reset_session_only) cctx->auto_workers = 0;
 
     return self;
 }
@@ -501,10 +993,14 @@ vibe_zstd_cctx_init_class(VALUE rb_cVibeZstdCCtx) {
     rb_define_alloc_func(rb_cVibeZstdCCtx, vibe_zstd_cctx_alloc);
     rb_define_method(rb_cVibeZstdCCtx, "initialize", vibe_zstd_cctx_initialize, -1);
     rb_define_method(rb_cVibeZstdCCtx, "compress", vibe_zstd_cctx_compress, -1);
+    rb_define_method(rb_cVibeZstdCCtx, "compress_into", vibe_zstd_cctx_compress_into, -1);
+    rb_define_method(rb_cVibeZstdCCtx, "compress_batch", vibe_zstd_cctx_compress_batch, -1);
     rb_define_method(rb_cVibeZstdCCtx, "use_prefix", vibe_zstd_cctx_use_prefix, 1);
     rb_define_method(rb_cVibeZstdCCtx, "reset", vibe_zstd_cctx_reset, -1);
     rb_define_singleton_method(rb_cVibeZstdCCtx, "parameter_bounds", vibe_zstd_cctx_parameter_bounds, 1);
     rb_define_singleton_method(rb_cVibeZstdCCtx, "estimate_memory", vibe_zstd_cctx_estimate_memory, 1);
+    rb_define_singleton_method(rb_cVibeZstdCCtx, "auto_workers", vibe_zstd_cctx_s_auto_workers, -1);
+    rb_define_method(rb_cVibeZstdCCtx, "memory_size", vibe_zstd_cctx_memory_size, 0);
 
     // CCtx parameter accessors
     rb_define_method(rb_cVibeZstdCCtx, "compression_level=", vibe_zstd_cctx_set_compression_level, 1);
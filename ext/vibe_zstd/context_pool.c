@@ -0,0 +1,252 @@
+// Shared context pool for VibeZstd
+//
+// A Pool hands out CCtx/DCtx objects for the duration of one call and takes
+// them back afterward, so a process keeps only as many contexts as it actually
+// uses concurrently instead of one per thread per dictionary. Per-call options
+// (level, dict, pledged_size, max_size, ...) are applied and restored by the
+// context methods themselves, so any idle context can serve any call and the
+// pool needs no per-dictionary keys; the parameter signature is fixed per pool.
+//
+// Checkout and return run with the GVL held, which already serializes them, so
+// each idle stack is a plain LIFO array: a checkout is a pointer pop, and the
+// most recently returned (cache-warm) context is reused first.
+#include "vibe_zstd_internal.h"
+
+#define VIBE_ZSTD_POOL_MIN_IDLE 4
+
+// Pool.default of each Ractor: contexts are not shareable, so every Ractor
+// gets a pool of its own
+static rb_ractor_local_key_t vibe_zstd_default_pool_key;
+
+static VALUE pool_checkout(vibe_zstd_pool* pool, vibe_zstd_pool_stack* stack, VALUE klass, VALUE params);
+static void pool_checkin(VALUE self, vibe_zstd_pool* pool, vibe_zstd_pool_stack* stack, VALUE ctx);
+
+// Pool.new(max_idle: nil, cctx_params: nil, dctx_params: nil)
+//
+// max_idle bounds the idle contexts kept per kind (default: online CPUs, the
+// most that can usefully compress at once with the GVL released, but at least
+// VIBE_ZSTD_POOL_MIN_IDLE so small machines do not churn contexts). Contexts
+// returned while the stack is full are dropped and freed by the GC.
+// cctx_params / dctx_params are passed to CCtx.new / DCtx.new for every
+// context the pool creates; one context of each kind is created up front to
+// validate them.
+static VALUE
+vibe_zstd_pool_initialize(int argc, VALUE* argv, VALUE self) {
+    VALUE options = Qnil;
+    rb_scan_args(argc, argv, "0:", &options);
+    vibe_zstd_pool* pool;
+    TypedData_Get_Struct(self, vibe_zstd_pool, &vibe_zstd_pool_type, pool);
+    if (pool->cctxs.idle) {
+        rb_raise(rb_eRuntimeError, "Pool already initialized");
+    }
+
+    VALUE max_idle_val = Qnil, cctx_params = Qnil, dctx_params = Qnil;
+    if (!NIL_P(options)) {
+        max_idle_val = rb_hash_aref(options, ID2SYM(rb_intern("max_idle")));
+        cctx_params = rb_hash_aref(options, ID2SYM(rb_intern("cctx_params")));
+        dctx_params = rb_hash_aref(options, ID2SYM(rb_intern("dctx_params")));
+    }
+
+    long max_idle;
+    if (NIL_P(max_idle_val)) {
+        max_idle = sysconf(_SC_NPROCESSORS_ONLN);
+        if (max_idle < VIBE_ZSTD_POOL_MIN_IDLE) max_idle = VIBE_ZSTD_POOL_MIN_IDLE;
+    } else {
+        max_idle = NUM2LONG(max_idle_val);
+        if (max_idle < 0) {
+            rb_raise(rb_eArgError, "max_idle must not be negative (got %ld)", max_idle);
+        }
+    }
+    if (!NIL_P(cctx_params)) {
+        Check_Type(cctx_params, T_HASH);
+        RB_OBJ_WRITE(self, &pool->cctx_params, rb_hash_freeze(rb_hash_dup(cctx_params)));
+    }
+    if (!NIL_P(dctx_params)) {
+        Check_Type(dctx_params, T_HASH);
+        RB_OBJ_WRITE(self, &pool->dctx_params, rb_hash_freeze(rb_hash_dup(dctx_params)));
+    }
+
+    pool->max_idle = (size_t)max_idle;
+    pool->cctxs.idle = ALLOC_N(VALUE, pool->max_idle ? pool->max_idle : 1);
+    pool->dctxs.idle = ALLOC_N(VALUE, pool->max_idle ? pool->max_idle : 1);
+
+    if (!NIL_P(pool->cctx_params)) {
+        pool_checkin(self, pool, &pool->cctxs, pool_checkout(pool, &pool->cctxs, rb_cVibeZstdCCtx, pool->cctx_params));
+    }
+    if (!NIL_P(pool->dctx_params)) {
+        pool_checkin(self, pool, &pool->dctxs, pool_checkout(pool, &pool->dctxs, rb_cVibeZstdDCtx, pool->dctx_params));
+    }
+    return self;
+}
+
+static VALUE
+pool_new_context(VALUE klass, VALUE params) {
+    if (NIL_P(params)) return rb_class_new_instance(0, NULL, klass);
+    return rb_class_new_instance_kw(1, &params, klass, RB_PASS_KEYWORDS);
+}
+
+static VALUE
+pool_checkout(vibe_zstd_pool* pool, vibe_zstd_pool_stack* stack, VALUE klass, VALUE params) {
+    if (!stack->idle) {
+        rb_raise(rb_eRuntimeError, "Pool not initialized");
+    }
+    VALUE ctx;
+    if (stack->idle_count > 0) {
+        ctx = stack->idle[--stack->idle_count];
+    } else {
+        ctx = pool_new_context(klass, params);
+        stack->created++;
+    }
+    stack->in_use++;
+    return ctx;
+}
+
+// Park a context for reuse, or drop it when the stack is full. A call that was
+// interrupted mid-frame leaves session state behind, so the session is reset
+// before parking; parameters are left alone (the pool's own, by contract).
+static void
+pool_checkin(VALUE self, vibe_zstd_pool* pool, vibe_zstd_pool_stack* stack, VALUE ctx) {
+    stack->in_use--;
+    if (stack->idle_count >= pool->max_idle) return;
+    if (stack == &pool->cctxs) {
+        vibe_zstd_cctx* cctx;
+        TypedData_Get_Struct(ctx, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+        ZSTD_CCtx_reset(cctx->cctx, ZSTD_reset_session_only);
+    } else {
+        vibe_zstd_dctx* dctx;
+        TypedData_Get_Struct(ctx, vibe_zstd_dctx, &vibe_zstd_dctx_type, dctx);
+        ZSTD_DCtx_reset(dctx->dctx, ZSTD_reset_session_only);
+    }
+    stack->idle[stack->idle_count++] = ctx;
+    RB_OBJ_WRITTEN(self, Qundef, ctx);
+}
+
+// One checked-out call: run func on ctx (a direct method call, or yield), then
+// return ctx to its stack even if the call raises.
+typedef struct {
+    VALUE self;
+    vibe_zstd_pool* pool;
+    vibe_zstd_pool_stack* stack;
+    VALUE ctx;
+    VALUE (*func)(int, VALUE*, VALUE);
+    int argc;
+    VALUE* argv;
+} pool_call;
+
+static VALUE
+pool_call_body(VALUE arg) {
+    pool_call* call = (pool_call*)arg;
+    if (!call->func) return rb_yield(call->ctx);
+    // rb_ensure pushes no frame, so the callee's rb_scan_args still sees this
+    // method's keyword flag.
+    return call->func(call->argc, call->argv, call->ctx);
+}
+
+static VALUE
+pool_call_ensure(VALUE arg) {
+    pool_call* call = (pool_call*)arg;
+    pool_checkin(call->self, call->pool, call->stack, call->ctx);
+    return Qnil;
+}
+
+static VALUE
+pool_run(VALUE self, int compress, VALUE (*func)(int, VALUE*, VALUE), int argc, VALUE* argv) {
+    vibe_zstd_pool* pool;
+    TypedData_Get_Struct(self, vibe_zstd_pool, &vibe_zstd_pool_type, pool);
+    pool_call call = { self, pool, NULL, Qnil, func, argc, argv };
+    if (compress) {
+        call.stack = &pool->cctxs;
+        call.ctx = pool_checkout(pool, call.stack, rb_cVibeZstdCCtx, pool->cctx_params);
+    } else {
+        call.stack = &pool->dctxs;
+        call.ctx = pool_checkout(pool, call.stack, rb_cVibeZstdDCtx, pool->dctx_params);
+    }
+    VALUE result = rb_ensure(pool_call_body, (VALUE)&call, pool_call_ensure, (VALUE)&call);
+    RB_GC_GUARD(call.ctx);
+    return result;
+}
+
+// Pool#compress(data, level:, dict:, pledged_size:) - CCtx#compress on a pooled context
+static VALUE
+vibe_zstd_pool_compress(int argc, VALUE* argv, VALUE self) {
+    rb_check_arity(argc, 1, 2);
+    return pool_run(self, 1, vibe_zstd_cctx_compress, argc, argv);
+}
+
+// Pool#decompress(data, dict:, max_decompressed_size:, ...) - DCtx#decompress on a pooled context
+static VALUE
+vibe_zstd_pool_decompress(int argc, VALUE* argv, VALUE self) {
+    rb_check_arity(argc, 1, 2);
+    return pool_run(self, 0, vibe_zstd_dctx_decompress, argc, argv);
+}
+
+// Pool#with_cctx { |cctx| ... } - Check out a CCtx for the block. The context
+// goes back to the pool afterward, so it must not be retained or have its
+// parameters changed.
+static VALUE
+vibe_zstd_pool_with_cctx(VALUE self) {
+    rb_need_block();
+    return pool_run(self, 1, NULL, 0, NULL);
+}
+
+// Pool#with_dctx { |dctx| ... } - Check out a DCtx for the block (same rules)
+static VALUE
+vibe_zstd_pool_with_dctx(VALUE self) {
+    rb_need_block();
+    return pool_run(self, 0, NULL, 0, NULL);
+}
+
+// Pool#stats - Idle, in-use and created context counts per kind
+static VALUE
+vibe_zstd_pool_stats(VALUE self) {
+    vibe_zstd_pool* pool;
+    TypedData_Get_Struct(self, vibe_zstd_pool, &vibe_zstd_pool_type, pool);
+    VALUE stats = rb_hash_new();
+    rb_hash_aset(stats, ID2SYM(rb_intern("max_idle")), SIZET2NUM(pool->max_idle));
+    rb_hash_aset(stats, ID2SYM(rb_intern("idle_compression_contexts")), SIZET2NUM(pool->cctxs.idle_count));
+    rb_hash_aset(stats, ID2SYM(rb_intern("idle_decompression_contexts")), SIZET2NUM(pool->dctxs.idle_count));
+    rb_hash_aset(stats, ID2SYM(rb_intern("compression_contexts_in_use")), SIZET2NUM(pool->cctxs.in_use));
+    rb_hash_aset(stats, ID2SYM(rb_intern("decompression_contexts_in_use")), SIZET2NUM(pool->dctxs.in_use));
+    rb_hash_aset(stats, ID2SYM(rb_intern("compression_contexts_created")), SIZET2NUM(pool->cctxs.created));
+    rb_hash_aset(stats, ID2SYM(rb_intern("decompression_contexts_created")), SIZET2NUM(pool->dctxs.created));
+    return stats;
+}
+
+// Pool#clear - Drop every idle context (checked-out ones are unaffected)
+static VALUE
+vibe_zstd_pool_clear(VALUE self) {
+    vibe_zstd_pool* pool;
+    TypedData_Get_Struct(self, vibe_zstd_pool, &vibe_zstd_pool_type, pool);
+    pool->cctxs.idle_count = 0;
+    pool->dctxs.idle_count = 0;
+    return self;
+}
+
+// Pool.default - Pool with default parameters, one per Ractor (the main
+// Ractor's is created when the extension is loaded)
+static VALUE
+vibe_zstd_pool_s_default(VALUE klass) {
+    VALUE pool;
+    if (!rb_ractor_local_storage_value_lookup(vibe_zstd_default_pool_key, &pool)) {
+        pool = rb_class_new_instance(0, NULL, klass);
+        rb_ractor_local_storage_value_set(vibe_zstd_default_pool_key, pool);
+    }
+    return pool;
+}
+
+// Class initialization called from main Init_vibe_zstd
+void
+vibe_zstd_pool_init_class(VALUE rb_cVibeZstdPool) {
+    rb_define_alloc_func(rb_cVibeZstdPool, vibe_zstd_pool_alloc);
+    rb_define_method(rb_cVibeZstdPool, "initialize", vibe_zstd_pool_initialize, -1);
+    rb_define_method(rb_cVibeZstdPool, "compress", vibe_zstd_pool_compress, -1);
+    rb_define_method(rb_cVibeZstdPool, "decompress", vibe_zstd_pool_decompress, -1);
+    rb_define_method(rb_cVibeZstdPool, "with_cctx", vibe_zstd_pool_with_cctx, 0);
+    rb_define_method(rb_cVibeZstdPool, "with_dctx", vibe_zstd_pool_with_dctx, 0);
+    rb_define_method(rb_cVibeZstdPool, "stats", vibe_zstd_pool_stats, 0);
+    rb_define_method(rb_cVibeZstdPool, "clear", vibe_zstd_pool_clear, 0);
+    rb_define_singleton_method(rb_cVibeZstdPool, "default", vibe_zstd_pool_s_default, 0);
+
+    vibe_zstd_default_pool_key = rb_ractor_local_storage_value_newkey();
+    vibe_zstd_pool_s_default(rb_cVibeZstdPool);
+}
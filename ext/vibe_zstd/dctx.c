@@ -11,10 +11,20 @@ static size_t default_initial_capacity = 0;
 // Class-level default output-size limit (0 = unlimited)
 static size_t default_max_decompressed_size = 0;
 
+// Both defaults are process-wide and shared by every Ractor, so they are
+// read and written atomically
+#define DCTX_DEFAULT_GET(var) RUBY_ATOMIC_SIZE_CAS(var, 0, 0)
+#define DCTX_DEFAULT_SET(var, value) ((void)RUBY_ATOMIC_SIZE_EXCHANGE(var, value))
+
 // VibeZstd::DecompressedSizeExceeded - raised when output exceeds the limit.
 // Defined in vibe_zstd_dctx_init_class, cached here for use on the error path.
 static VALUE rb_eDecompressedSizeExceeded;
 
+// Forward declarations for helpers defined in parallel.c
+typedef struct dctx_call_opts dctx_call_opts;
+static VALUE vibe_zstd_decompress_frames_parallel(VALUE data, size_t offset, const dctx_call_opts* opts,
+                                                  int window_log_max, VALUE threads_val, long min_frames);
+
 // Helper to set DCtx parameter from Ruby keyword argument
 static int
 vibe_zstd_dctx_init_param_iter(VALUE key, VALUE value, VALUE self) {
@@ -58,6 +68,14 @@ vibe_zstd_dctx_estimate_memory(VALUE self) {
     return SIZET2NUM(estimate);
 }
 
+// DCtx#memory_size - Bytes currently allocated by this context (ZSTD_sizeof_DCtx)
+static VALUE
+vibe_zstd_dctx_memory_size(VALUE self) {
+    vibe_zstd_dctx* dctx;
+    TypedData_Get_Struct(self, vibe_zstd_dctx, &vibe_zstd_dctx_type, dctx);
+    return SIZET2NUM(ZSTD_sizeof_DCtx(dctx->dctx));
+}
+
 // Parameter lookup table for DCtx
 typedef struct {
     ID symbol_id;
@@ -72,7 +90,8 @@ static dctx_param_entry dctx_param_table[] = {
 
 #define DCTX_PARAM_TABLE_SIZE (sizeof(dctx_param_table) / sizeof(dctx_param_entry))
 
-// Initialize DCtx parameter lookup table symbol IDs
+// Initialize DCtx parameter lookup table symbol IDs (once, from Init; read-only
+// afterwards, so every Ractor can use it)
 static void
 init_dctx_param_table(void) {
     for (size_t i = 0; i < DCTX_PARAM_TABLE_SIZE; i++) {
@@ -180,23 +199,24 @@ vibe_zstd_dctx_parameter_bounds(VALUE self, VALUE param_sym) {
 // DCtx default_initial_capacity getter (class method)
 static VALUE
 vibe_zstd_dctx_get_default_initial_capacity(VALUE self) {
-    if (default_initial_capacity == 0) {
+    size_t capacity = DCTX_DEFAULT_GET(default_initial_capacity);
+    if (capacity == 0) {
         return SIZET2NUM(ZSTD_DStreamOutSize());
     }
-    return SIZET2NUM(default_initial_capacity);
+    return SIZET2NUM(capacity);
 }
 
 // DCtx default_initial_capacity setter (class method)
 static VALUE
 vibe_zstd_dctx_set_default_initial_capacity(VALUE self, VALUE value) {
     if (NIL_P(value)) {
-        default_initial_capacity = 0;  // Reset to default
+        DCTX_DEFAULT_SET(default_initial_capacity, 0);  // Reset to default
     } else {
         size_t capacity = NUM2SIZET(value);
         if (capacity == 0) {
             rb_raise(rb_eArgError, "initial_capacity must be positive (or nil to reset to default)");
         }
-        default_initial_capacity = capacity;
+        DCTX_DEFAULT_SET(default_initial_capacity, capacity);
     }
     return value;
 }
@@ -235,16 +255,16 @@ vibe_zstd_dctx_set_initial_capacity(VALUE self, VALUE value) {
 // DCtx default_max_decompressed_size getter (class method); 0 = unlimited
 static VALUE
 vibe_zstd_dctx_get_default_max_decompressed_size(VALUE self) {
-    return SIZET2NUM(default_max_decompressed_size);
+    return SIZET2NUM(DCTX_DEFAULT_GET(default_max_decompressed_size));
 }
 
 // DCtx default_max_decompressed_size setter (class method)
 static VALUE
 vibe_zstd_dctx_set_default_max_decompressed_size(VALUE self, VALUE value) {
     if (NIL_P(value)) {
-        default_max_decompressed_size = 0;  // unlimited
+        DCTX_DEFAULT_SET(default_max_decompressed_size, 0);  // unlimited
     } else {
-        default_max_decompressed_size = NUM2SIZET(value);
+        DCTX_DEFAULT_SET(default_max_decompressed_size, NUM2SIZET(value));
     }
     return value;
 }
@@ -257,7 +277,7 @@ vibe_zstd_dctx_get_max_decompressed_size(VALUE self) {
     TypedData_Get_Struct(self, vibe_zstd_dctx, &vibe_zstd_dctx_type, dctx);
 
     if (dctx->max_decompressed_size == 0) {
-        return SIZET2NUM(default_max_decompressed_size);
+        return SIZET2NUM(DCTX_DEFAULT_GET(default_max_decompressed_size));
     }
     return SIZET2NUM(dctx->max_decompressed_size);
 }
@@ -309,7 +329,8 @@ decompress_without_gvl(void* arg) {
 }
 
 // Decompress stream args for GVL release (unknown content size path)
-// Uses plain C malloc/realloc since Ruby API calls are not allowed without GVL
+// Uses vibe_zstd_malloc/realloc (plain C allocation, counted for the GC) since
+// Ruby API calls are not allowed without GVL
 typedef struct {
     ZSTD_DCtx *dctx;
     const char *src;
@@ -326,7 +347,8 @@ typedef struct {
 } decompress_stream_nogvl_args;
 
 // Decompress stream without holding Ruby's GVL (unknown content size path)
-// Performs the entire ZSTD_decompressStream loop using C malloc/realloc.
+// Performs the entire ZSTD_decompressStream loop using C malloc/realloc,
+// decoding every frame of concatenated input into the one buffer.
 // No Ruby API calls allowed here.
 static void*
 decompress_stream_without_gvl(void* arg) {
@@ -341,7 +363,7 @@ decompress_stream_without_gvl(void* arg) {
     if (args->max_size && args->dst_capacity > args->max_size) {
         args->dst_capacity = args->max_size;
     }
-    args->dst = malloc(args->dst_capacity);
+    args->dst = vibe_zstd_malloc(args->dst_capacity);
     if (!args->dst) {
         args->error = 1;
         args->error_name = "malloc failed for decompression buffer";
@@ -365,7 +387,7 @@ decompress_stream_without_gvl(void* arg) {
                 args->limit_exceeded = 1;
                 return NULL;
             }
-            char* new_buf = realloc(args->dst, new_capacity);
+            char* new_buf = vibe_zstd_realloc(args->dst, new_capacity);
             if (!new_buf) {
                 args->error = 1;
                 args->error_name = "realloc failed during decompression";
@@ -391,8 +413,9 @@ decompress_stream_without_gvl(void* arg) {
         args->dst_size += output.pos;
         last_ret = ret;
 
-        // ret == 0 means frame is complete
-        if (ret == 0) break;
+        // ret == 0 means the current frame is complete and fully flushed.  Keep
+        // going while input remains: the stream decoder starts on the next
+        // (possibly skippable) frame of concatenated input by itself.
     }
 
     // If we consumed all input but the last call still reported a non-zero hint
@@ -448,7 +471,7 @@ static VALUE
 vibe_zstd_dctx_stream_decompress_cleanup(VALUE p) {
     dctx_stream_decompress_state* state = (dctx_stream_decompress_state*)p;
     if (state->args->dst) {
-        free(state->args->dst);
+        vibe_zstd_free(state->args->dst);
         state->args->dst = NULL;
     }
     if (state->ddict) {
@@ -460,8 +483,10 @@ vibe_zstd_dctx_stream_decompress_cleanup(VALUE p) {
 // DCtx frame_content_size - class method to get frame content size
 static VALUE
 vibe_zstd_dctx_frame_content_size(VALUE self, VALUE data) {
-    StringValue(data);
-    unsigned long long contentSize = ZSTD_getFrameContentSize(RSTRING_PTR(data), RSTRING_LEN(data));
+    const char* src;
+    size_t srcSize;
+    data = vibe_zstd_input_bytes(data, &src, &srcSize);
+    unsigned long long contentSize = ZSTD_getFrameContentSize(src, srcSize);
 
     if (contentSize == ZSTD_CONTENTSIZE_ERROR) {
         return Qnil;  // Invalid frame
@@ -474,89 +499,46 @@ vibe_zstd_dctx_frame_content_size(VALUE self, VALUE data) {
     return ULL2NUM(contentSize);
 }
 
-// DCtx decompress - Decompress ZSTD-compressed data
-//
-// This function handles two decompression paths:
-// 1. Known content size: Allocates exact buffer size and decompresses in one shot
-// 2. Unknown content size: Uses streaming decompression with exponential buffer growth
-//
-// The unknown-size path uses a standard exponential growth strategy (doubling)
-// which provides optimal O(n) amortized performance. Initial capacity can be
-// configured via initial_capacity parameter to reduce reallocations for known size ranges.
-//
-// Dictionary validation is performed to ensure frame requirements match provided dict.
-// Skippable frames at the beginning of data are automatically skipped.
-static VALUE
-vibe_zstd_dctx_decompress(int argc, VALUE* argv, VALUE self) {
-    VALUE data, options = Qnil;
-    rb_scan_args(argc, argv, "1:", &data, &options);
-    vibe_zstd_dctx* dctx;
-    TypedData_Get_Struct(self, vibe_zstd_dctx, &vibe_zstd_dctx_type, dctx);
-    StringValue(data);
-    const char* src = RSTRING_PTR(data);
-    size_t srcSize = RSTRING_LEN(data);
-    size_t offset = 0;
-
-    // Magicless frames (format = ZSTD_f_zstd1_magicless) carry no magic number,
-    // so frame introspection (content size, dict ID, skippable detection) cannot
-    // be performed. Force the streaming decompress path, which honors the format
-    // parameter set on the context via ZSTD_decompressStream.
-    int dformat = 0;
-    (void)ZSTD_DCtx_getParameter(dctx->dctx, ZSTD_d_format, &dformat);
-    int magicless = (dformat == ZSTD_f_zstd1_magicless);
-
-    unsigned long long contentSize;
-    unsigned int frame_dict_id;
-
-    if (magicless) {
-        contentSize = ZSTD_CONTENTSIZE_UNKNOWN;  // route to streaming path
-        frame_dict_id = 0;                        // cannot read dict ID without magic
-    } else {
-        // Skip any leading skippable frames
-        while (offset < srcSize && ZSTD_isSkippableFrame(src + offset, srcSize - offset)) {
-            size_t frameSize = ZSTD_findFrameCompressedSize(src + offset, srcSize - offset);
-            if (ZSTD_isError(frameSize)) {
-                rb_raise(rb_eRuntimeError, "Invalid skippable frame at offset %zu: %s", offset, ZSTD_getErrorName(frameSize));
-            }
-            offset += frameSize;
-        }
-
-        // Now check the actual compressed frame
-        if (offset >= srcSize) {
-            rb_raise(rb_eRuntimeError, "No compressed frame found in %zu bytes (only skippable frames)", srcSize);
-        }
-
-        src += offset;
-        srcSize -= offset;
-
-        contentSize = ZSTD_getFrameContentSize(src, srcSize);
-        if (contentSize == ZSTD_CONTENTSIZE_ERROR) {
-            rb_raise(rb_eRuntimeError, "Invalid compressed data: not a valid zstd frame (size: %zu bytes)", srcSize);
-        }
-
-        // Check dictionary requirements from the frame
-        frame_dict_id = ZSTD_getDictID_fromFrame(src, srcSize);
-    }
+// Per-call options accepted by decompress / decompress_batch, resolved against
+// the instance and class defaults so callers only deal with effective values.
+struct dctx_call_opts {
+    ZSTD_DDict* ddict;
+    VALUE ddict_obj;          // DDict owning ddict (Qnil when none); keep it alive across no-GVL calls
+    unsigned int dict_id;     // dict ID of ddict (0 when no dictionary given)
+    VALUE registry;           // dict: DictionaryRegistry, or Qnil; ddict is picked from the frames
+    int allow_mixed_dicts;    // registry: frames may need different dictionaries (decompress only)
+    int mixed_dicts;          // registry: they do
+    size_t initial_capacity;  // effective initial capacity for unknown-size frames
+    size_t max_size;          // effective output-size limit (0 = unlimited)
+};
 
-    // Extract keyword arguments
-    ZSTD_DDict* ddict = NULL;
-    unsigned int provided_dict_id = 0;
-    size_t initial_capacity = 0;  // 0 = not specified in per-call options
-    size_t max_size = 0;          // 0 = not specified in per-call options
+static void
+dctx_resolve_call_opts(const vibe_zstd_dctx* dctx, VALUE options, dctx_call_opts* opts) {
+    opts->ddict = NULL;
+    opts->ddict_obj = Qnil;
+    opts->dict_id = 0;
+    opts->registry = Qnil;
+    opts->allow_mixed_dicts = 0;
+    opts->mixed_dicts = 0;
+    opts->initial_capacity = 0;  // 0 = not specified in per-call options
+    opts->max_size = 0;          // 0 = not specified in per-call options
 
     if (!NIL_P(options)) {
         VALUE dict_val = rb_hash_aref(options, ID2SYM(rb_intern("dict")));
-        if (!NIL_P(dict_val)) {
+        if (rb_typeddata_is_kind_of(dict_val, &vibe_zstd_dict_registry_type)) {
+            opts->registry = dict_val;
+        } else if (!NIL_P(dict_val)) {
             vibe_zstd_ddict* ddict_struct;
             TypedData_Get_Struct(dict_val, vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict_struct);
-            ddict = ddict_struct->ddict;
-            provided_dict_id = ZSTD_getDictID_fromDDict(ddict);
+            opts->ddict = ddict_struct->ddict;
+            opts->ddict_obj = dict_val;
+            opts->dict_id = ZSTD_getDictID_fromDDict(opts->ddict);
         }
 
         VALUE initial_capacity_val = rb_hash_aref(options, ID2SYM(rb_intern("initial_capacity")));
         if (!NIL_P(initial_capacity_val)) {
-            initial_capacity = NUM2SIZET(initial_capacity_val);
-            if (initial_capacity == 0) {
+            opts->initial_capacity = NUM2SIZET(initial_capacity_val);
+            if (opts->initial_capacity == 0) {
                 rb_raise(rb_eArgError, "initial_capacity must be positive");
             }
         }
@@ -567,8 +549,8 @@ vibe_zstd_dctx_decompress(int argc, VALUE* argv, VALUE self) {
             max_size_val = rb_hash_aref(options, ID2SYM(rb_intern("max_size")));
         }
         if (!NIL_P(max_size_val)) {
-            max_size = NUM2SIZET(max_size_val);
-            if (max_size == 0) {
+            opts->max_size = NUM2SIZET(max_size_val);
+            if (opts->max_size == 0) {
                 rb_raise(rb_eArgError, "max_decompressed_size must be positive");
             }
         }
@@ -576,93 +558,215 @@ vibe_zstd_dctx_decompress(int argc, VALUE* argv, VALUE self) {
 
     // Resolve max_size fallback chain: per-call > instance > class default.
     // A value of 0 at every level means unlimited.
-    if (max_size == 0) {
-        max_size = dctx->max_decompressed_size;  // instance
-        if (max_size == 0) {
-            max_size = default_max_decompressed_size;  // class
+    if (opts->max_size == 0) {
+        opts->max_size = dctx->max_decompressed_size;  // instance
+        if (opts->max_size == 0) {
+            opts->max_size = DCTX_DEFAULT_GET(default_max_decompressed_size);  // class
         }
     }
 
-    // Validate dictionary matches frame requirements
-    if (frame_dict_id != 0 && ddict == NULL) {
+    // Resolve initial_capacity fallback chain: per-call > instance > class default > ZSTD default
+    if (opts->initial_capacity == 0) {
+        opts->initial_capacity = dctx->initial_capacity;  // Instance default
+        if (opts->initial_capacity == 0) {
+            opts->initial_capacity = DCTX_DEFAULT_GET(default_initial_capacity);  // Class default
+            if (opts->initial_capacity == 0) {
+                opts->initial_capacity = ZSTD_DStreamOutSize();  // ZSTD default (~128KB)
+            }
+        }
+    }
+}
+
+// Validate dictionary matches frame requirements
+static void
+dctx_check_frame_dict(unsigned int frame_dict_id, const dctx_call_opts* opts) {
+    if (frame_dict_id != 0 && opts->ddict == NULL) {
         rb_raise(rb_eArgError, "Data requires dictionary (dict_id: %u) but none provided", frame_dict_id);
     }
 
-    if (ddict != NULL && frame_dict_id != 0 && provided_dict_id != frame_dict_id) {
+    if (opts->ddict != NULL && frame_dict_id != 0 && opts->dict_id != frame_dict_id) {
         rb_raise(rb_eArgError, "Dictionary mismatch: frame requires dict_id %u, provided dict_id %u",
-                 frame_dict_id, provided_dict_id);
+                 frame_dict_id, opts->dict_id);
     }
+}
 
-    // Resolve initial_capacity fallback chain: per-call > instance > class default > ZSTD default
-    if (initial_capacity == 0) {
-        initial_capacity = dctx->initial_capacity;  // Instance default
-        if (initial_capacity == 0) {
-            initial_capacity = default_initial_capacity;  // Class default
-            if (initial_capacity == 0) {
-                initial_capacity = ZSTD_DStreamOutSize();  // ZSTD default (~128KB)
-            }
+// Pick the dictionary for a frame from opts->registry, or validate the frame
+// against the single dict: given. With a registry, the first frame needing a
+// dictionary selects opts->ddict; a later frame needing another one raises
+// unless the caller can decode frame by frame (allow_mixed_dicts).
+//
+// The registry may drop the entry (prune, delete, or add replacing the
+// dict_id) while the GVL is released, so opts->ddict_obj holds the DDict
+// object itself: callers RB_GC_GUARD it across their no-GVL decode.
+static void
+dctx_select_frame_dict(unsigned int frame_dict_id, dctx_call_opts* opts) {
+    if (NIL_P(opts->registry) || frame_dict_id == 0) {
+        dctx_check_frame_dict(frame_dict_id, opts);
+        return;
+    }
+    vibe_zstd_dict_registry_entry* entry = vibe_zstd_dict_registry_find(opts->registry, frame_dict_id);
+    if (!entry) {
+        rb_raise(rb_eArgError, "No dictionary registered for dict_id %u", frame_dict_id);
+    }
+    if (!opts->ddict) {
+        vibe_zstd_ddict* ddict_struct;
+        TypedData_Get_Struct(entry->ddict, vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict_struct);
+        opts->ddict = ddict_struct->ddict;
+        opts->ddict_obj = entry->ddict;
+        opts->dict_id = frame_dict_id;
+    } else if (opts->dict_id != frame_dict_id) {
+        if (!opts->allow_mixed_dicts) {
+            rb_raise(rb_eArgError, "Frames reference different dictionaries (dict_id %u and %u); "
+                     "only decompress can mix them", opts->dict_id, frame_dict_id);
         }
+        opts->mixed_dicts = 1;
     }
+}
 
-    // If content size is unknown, use streaming decompression with exponential growth.
-    // Releases GVL to allow other Ruby threads to run during decompression.
-    // Uses C malloc/realloc (not Ruby allocators) since Ruby API calls are forbidden without GVL.
-    if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
-        // Reference the dictionary on the context before streaming decompression.
-        // ZSTD_decompressStream uses whatever dict is referenced on the DCtx, so
-        // without this the dictionary would be ignored on the unknown-size path
-        // (every dict frame produced by CompressWriter has unknown content size).
-        if (ddict) {
-            size_t rd = ZSTD_DCtx_refDDict(dctx->dctx, ddict);
-            if (ZSTD_isError(rd)) {
-                rb_raise(rb_eRuntimeError, "Failed to reference dictionary: %s", ZSTD_getErrorName(rd));
-            }
+// Options for one independent input of decompress_batch / decompress_many.
+// With a DictionaryRegistry every input picks its own dictionary, so inputs
+// may use different ones; the frames within one input still have to agree.
+static void
+dctx_entry_opts(const dctx_call_opts* opts, dctx_call_opts* entry) {
+    *entry = *opts;
+    if (!NIL_P(opts->registry)) {
+        entry->ddict = NULL;
+        entry->ddict_obj = Qnil;
+        entry->dict_id = 0;
+    }
+}
+
+// Walk every frame of (possibly concatenated) input: skip skippable frames,
+// select or validate each compressed frame's dictionary against opts, and
+// sum the declared content sizes into *content_size.  Returns the offset of the
+// first compressed frame within src.  Raises on malformed leading input.
+//
+// *content_size is ZSTD_CONTENTSIZE_UNKNOWN when any frame omits its size.
+// The walk stops early at a truncated frame or trailing garbage without
+// raising: the decoder reports those errors precisely, so it leaves them to it.
+static size_t
+dctx_inspect_frames(const char* src, size_t srcSize, dctx_call_opts* opts, unsigned long long* content_size) {
+    size_t offset = 0;
+
+    // Skip any leading skippable frames
+    while (offset < srcSize && ZSTD_isSkippableFrame(src + offset, srcSize - offset)) {
+        size_t frameSize = ZSTD_findFrameCompressedSize(src + offset, srcSize - offset);
+        if (ZSTD_isError(frameSize)) {
+            rb_raise(rb_eRuntimeError, "Invalid skippable frame at offset %zu: %s", offset, ZSTD_getErrorName(frameSize));
         }
+        offset += frameSize;
+    }
 
-        decompress_stream_nogvl_args stream_args = {
-            .dctx = dctx->dctx,
-            .src = src,
-            .src_size = srcSize,
-            .dst = NULL,
-            .dst_capacity = 0,
-            .dst_size = 0,
-            .initial_capacity = initial_capacity,
-            .max_size = max_size,
-            .error = 0,
-            .limit_exceeded = 0,
-            .truncated = 0,
-            .error_name = NULL
-        };
+    // Now check the actual compressed frame
+    if (offset >= srcSize) {
+        rb_raise(rb_eRuntimeError, "No compressed frame found in %zu bytes (only skippable frames)", srcSize);
+    }
+    if (ZSTD_getFrameContentSize(src + offset, srcSize - offset) == ZSTD_CONTENTSIZE_ERROR) {
+        rb_raise(rb_eRuntimeError, "Invalid compressed data: not a valid zstd frame (size: %zu bytes)", srcSize - offset);
+    }
 
-        // Run the streaming decompression and build the result under rb_ensure:
-        // the cleanup frees the C buffer and un-references the dictionary on
-        // every exit path, including the raises below and async exceptions
-        // delivered when the GVL is reacquired.
-        dctx_stream_decompress_state state = {
-            .dctx = dctx->dctx,
-            .ddict = ddict,
-            .args = &stream_args,
-            .data = data,
-            .max_size = max_size
-        };
-        return rb_ensure(vibe_zstd_dctx_stream_decompress_body, (VALUE)&state,
-                         vibe_zstd_dctx_stream_decompress_cleanup, (VALUE)&state);
+    unsigned long long total = 0;
+    size_t pos = offset;
+    while (pos < srcSize) {
+        const char* frame = src + pos;
+        size_t remaining = srcSize - pos;
+        size_t frameSize = ZSTD_findFrameCompressedSize(frame, remaining);
+
+        if (ZSTD_isSkippableFrame(frame, remaining)) {
+            if (ZSTD_isError(frameSize)) break;
+            pos += frameSize;
+            continue;
+        }
+
+        unsigned long long frameContentSize = ZSTD_getFrameContentSize(frame, remaining);
+        if (frameContentSize == ZSTD_CONTENTSIZE_ERROR) break;
+
+        // Check dictionary requirements from every frame
+        dctx_select_frame_dict(ZSTD_getDictID_fromFrame(frame, remaining), opts);
+
+        if (frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN || total == ZSTD_CONTENTSIZE_UNKNOWN) {
+            total = ZSTD_CONTENTSIZE_UNKNOWN;
+        } else if (frameContentSize > ZSTD_CONTENTSIZE_ERROR - 1 - total) {
+            rb_raise(rb_eRuntimeError, "Invalid compressed data: total content size overflows");
+        } else {
+            total += frameContentSize;
+        }
+
+        if (ZSTD_isError(frameSize)) break;
+        pos += frameSize;
     }
-    // Reject a frame whose declared content size exceeds the limit before
-    // allocating the output buffer (the header is attacker-controlled).
-    if (max_size && contentSize > (unsigned long long)max_size) {
-        rb_raise(rb_eDecompressedSizeExceeded,
-                 "Declared content size %llu exceeds limit of %zu bytes", contentSize, max_size);
+
+    *content_size = total;
+    return offset;
+}
+
+// Unknown content size: streaming decompression with exponential growth.
+// Releases GVL to allow other Ruby threads to run during decompression.
+// Uses vibe_zstd_malloc/realloc (not Ruby allocators) since Ruby API calls are forbidden without GVL.
+// src/srcSize point into data, which is locked for the duration.
+static VALUE
+dctx_decompress_unknown_size(vibe_zstd_dctx* dctx, const dctx_call_opts* opts, VALUE data,
+                             const char* src, size_t srcSize) {
+    // Reference the dictionary on the context before streaming decompression.
+    // ZSTD_decompressStream uses whatever dict is referenced on the DCtx, so
+    // without this the dictionary would be ignored on the unknown-size path
+    // (every dict frame produced by CompressWriter has unknown content size).
+    if (opts->ddict) {
+        size_t rd = ZSTD_DCtx_refDDict(dctx->dctx, opts->ddict);
+        if (ZSTD_isError(rd)) {
+            rb_raise(rb_eRuntimeError, "Failed to reference dictionary: %s", ZSTD_getErrorName(rd));
+        }
     }
 
-    VALUE result = rb_str_new(NULL, contentSize);
+    decompress_stream_nogvl_args stream_args = {
+        .dctx = dctx->dctx,
+        .src = src,
+        .src_size = srcSize,
+        .dst = NULL,
+        .dst_capacity = 0,
+        .dst_size = 0,
+        .initial_capacity = opts->initial_capacity,
+        .max_size = opts->max_size,
+        .error = 0,
+        .limit_exceeded = 0,
+        .truncated = 0,
+        .error_name = NULL
+    };
+
+    // Run the streaming decompression and build the result under rb_ensure:
+    // the cleanup frees the C buffer and un-references the dictionary on
+    // every exit path, including the raises below and async exceptions
+    // delivered when the GVL is reacquired.
+    dctx_stream_decompress_state state = {
+        .dctx = dctx->dctx,
+        .ddict = opts->ddict,
+        .args = &stream_args,
+        .data = data,
+        .max_size = opts->max_size
+    };
+    return rb_ensure(vibe_zstd_dctx_stream_decompress_body, (VALUE)&state,
+                     vibe_zstd_dctx_stream_decompress_cleanup, (VALUE)&state);
+}
+
+// Upper bound on how far ZSTD_decompressBound may exceed the compressed input
+// before presizing from it is abandoned in favour of the growing stream path.
+// The bound counts every block of an unknown-size frame at the maximum block
+// size, so streams with many small flushed blocks can overstate it wildly.
+#define VIBE_ZSTD_BOUND_PRESIZE_RATIO 32
+
+// One-shot decode of all frames in src into a presized buffer of capacity
+// bytes. The result is shrunk to the decoded length.
+static VALUE
+dctx_decompress_presized(vibe_zstd_dctx* dctx, const dctx_call_opts* opts, VALUE data,
+                         const char* src, size_t srcSize, size_t capacity) {
+    VALUE result = rb_str_new(NULL, capacity);
     decompress_args args = {
         .dctx = dctx->dctx,
-        .ddict = ddict,
+        .ddict = opts->ddict,
         .src = src,
         .srcSize = srcSize,
         .dst = RSTRING_PTR(result),
-        .dstCapacity = contentSize,
+        .dstCapacity = capacity,
         .result = 0
     };
     // Lock the source string while the GVL is released: another Ruby thread
@@ -673,10 +777,593 @@ vibe_zstd_dctx_decompress(int argc, VALUE* argv, VALUE self) {
     if (ZSTD_isError(args.result)) {
         rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(args.result));
     }
-    rb_str_set_len(result, args.result);
+    if (args.result < capacity) {
+        rb_str_resize(result, (long)args.result);
+    } else {
+        rb_str_set_len(result, args.result);
+    }
+    return result;
+}
+
+// Frames needing different dictionaries from a DictionaryRegistry: decode one
+// frame at a time with its own DDict and join the results. max_size applies
+// to the combined output, as on the other paths.
+static VALUE
+dctx_decompress_frames_by_dict(vibe_zstd_dctx* dctx, const dctx_call_opts* opts, VALUE data,
+                               const char* src, size_t srcSize) {
+    VALUE result = rb_str_buf_new(0);
+    size_t pos = 0;
+    while (pos < srcSize) {
+        const char* frame = src + pos;
+        size_t remaining = srcSize - pos;
+        size_t frameSize = ZSTD_findFrameCompressedSize(frame, remaining);
+        if (ZSTD_isError(frameSize)) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(frameSize));
+        }
+        pos += frameSize;
+        if (ZSTD_isSkippableFrame(frame, remaining)) continue;
+
+        dctx_call_opts frame_opts = *opts;
+        frame_opts.ddict = NULL;
+        frame_opts.ddict_obj = Qnil;
+        frame_opts.dict_id = 0;
+        dctx_select_frame_dict(ZSTD_getDictID_fromFrame(frame, remaining), &frame_opts);
+
+        VALUE decoded;
+        unsigned long long contentSize = ZSTD_getFrameContentSize(frame, remaining);
+        if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+            decoded = dctx_decompress_unknown_size(dctx, &frame_opts, data, frame, frameSize);
+        } else {
+            if (opts->max_size && contentSize > (unsigned long long)opts->max_size) {
+                rb_raise(rb_eDecompressedSizeExceeded,
+                         "Decompressed output exceeds limit of %zu bytes", opts->max_size);
+            }
+            decoded = dctx_decompress_presized(dctx, &frame_opts, data, frame, frameSize, (size_t)contentSize);
+        }
+        if (opts->max_size && RSTRING_LEN(result) + RSTRING_LEN(decoded) > (long)opts->max_size) {
+            rb_raise(rb_eDecompressedSizeExceeded,
+                     "Decompressed output exceeds limit of %zu bytes", opts->max_size);
+        }
+        rb_str_cat(result, RSTRING_PTR(decoded), RSTRING_LEN(decoded));
+        RB_GC_GUARD(frame_opts.ddict_obj);
+    }
+    return result;
+}
+
+// DCtx decompress - Decompress ZSTD-compressed data
+//
+// Concatenated frames are decoded into a single result, and skippable frames
+// anywhere in the input are skipped.  The output buffer is sized in this order:
+// 1. All content sizes declared: the sum of the frames' content sizes, exactly
+// 2. Some size missing: ZSTD_decompressBound, when it is within the limit and
+//    not wildly larger than the input (VIBE_ZSTD_BOUND_PRESIZE_RATIO)
+// 3. Otherwise: streaming decompression with exponential buffer growth
+//
+// The streaming path uses a standard exponential growth strategy (doubling)
+// which provides optimal O(n) amortized performance. Initial capacity can be
+// configured via initial_capacity parameter to reduce reallocations for known size ranges.
+//
+// Dictionary validation is performed to ensure every frame's requirement matches
+// the provided dict. dict: may also be a DictionaryRegistry, in which case each
+// frame's dict_id selects the dictionary.
+//
+// With threads: n, input made of several independent frames (pzstd output,
+// seekable archives, appended blobs) is decoded in parallel on the native
+// worker pool instead; see vibe_zstd_decompress_frames_parallel.
+static VALUE
+dctx_decompress_resolved(vibe_zstd_dctx* dctx, VALUE options, dctx_call_opts* opts, VALUE data,
+                         const char* src, size_t srcSize) {
+    // Magicless frames (format = ZSTD_f_zstd1_magicless) carry no magic number,
+    // so frame introspection (content size, dict ID, skippable detection) cannot
+    // be performed. Force the streaming decompress path, which honors the format
+    // parameter set on the context via ZSTD_decompressStream.
+    int dformat = 0;
+    (void)ZSTD_DCtx_getParameter(dctx->dctx, ZSTD_d_format, &dformat);
+    if (dformat == ZSTD_f_zstd1_magicless) {
+        return dctx_decompress_unknown_size(dctx, opts, data, src, srcSize);
+    }
+
+    // With a DictionaryRegistry each frame's dict_id selects its dictionary
+    opts->allow_mixed_dicts = 1;
+    unsigned long long contentSize;
+    size_t offset = dctx_inspect_frames(src, srcSize, opts, &contentSize);
+    src += offset;
+    srcSize -= offset;
+    if (opts->mixed_dicts) {
+        return dctx_decompress_frames_by_dict(dctx, opts, data, src, srcSize);
+    }
+
+    // threads: decode independent frames concurrently on the native worker
+    // pool. Input with a single frame (or framing the walk cannot split) falls
+    // through to the serial paths below.
+    VALUE threads_val = NIL_P(options) ? Qnil : rb_hash_aref(options, ID2SYM(rb_intern("threads")));
+    if (!NIL_P(threads_val)) {
+        int window_log_max = 0;
+        (void)ZSTD_DCtx_getParameter(dctx->dctx, ZSTD_d_windowLogMax, &window_log_max);
+        VALUE result = vibe_zstd_decompress_frames_parallel(data, offset, opts, window_log_max, threads_val, 2);
+        if (!NIL_P(result)) return result;
+    }
+
+    if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+        // ZSTD_decompressBound fails on truncated or corrupt input; the stream
+        // path then reports the precise error.
+        unsigned long long bound = ZSTD_decompressBound(src, srcSize);
+        unsigned long long presize_limit = (unsigned long long)srcSize * VIBE_ZSTD_BOUND_PRESIZE_RATIO;
+        if (presize_limit < opts->initial_capacity) {
+            presize_limit = opts->initial_capacity;
+        }
+        if (bound != ZSTD_CONTENTSIZE_ERROR && bound <= presize_limit &&
+            (opts->max_size == 0 || bound <= (unsigned long long)opts->max_size)) {
+            return dctx_decompress_presized(dctx, opts, data, src, srcSize, (size_t)bound);
+        }
+        return dctx_decompress_unknown_size(dctx, opts, data, src, srcSize);
+    }
+    // Reject frames whose declared content size exceeds the limit before
+    // allocating the output buffer (the header is attacker-controlled).
+    if (opts->max_size && contentSize > (unsigned long long)opts->max_size) {
+        rb_raise(rb_eDecompressedSizeExceeded,
+                 "Declared content size %llu exceeds limit of %zu bytes", contentSize, opts->max_size);
+    }
+
+    return dctx_decompress_presized(dctx, opts, data, src, srcSize, (size_t)contentSize);
+}
+
+// opts.ddict_obj may be a DDict picked from a DictionaryRegistry; the guard
+// keeps it alive until the decode is done, whatever the registry does meanwhile.
+static VALUE
+vibe_zstd_dctx_decompress(int argc, VALUE* argv, VALUE self) {
+    VALUE data, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &data, &options);
+    vibe_zstd_dctx* dctx;
+    TypedData_Get_Struct(self, vibe_zstd_dctx, &vibe_zstd_dctx_type, dctx);
+    const char* src;
+    size_t srcSize;
+    data = vibe_zstd_input_bytes(data, &src, &srcSize);
+
+    // Extract keyword arguments
+    dctx_call_opts opts;
+    dctx_resolve_call_opts(dctx, options, &opts);
+
+    VALUE result = dctx_decompress_resolved(dctx, options, &opts, data, src, srcSize);
+    RB_GC_GUARD(opts.ddict_obj);
+    return result;
+}
+
+// Streaming state for decompress_into when the output size is not known up
+// front. The decoder writes straight into the caller's String; whenever it
+// fills up, the GVL is reacquired to grow the String and decoding resumes.
+typedef struct {
+    ZSTD_DCtx* dctx;
+    ZSTD_inBuffer input;
+    char* dst;
+    size_t dst_capacity;
+    size_t dst_size;
+    size_t result;  // last ZSTD_decompressStream return value
+} decompress_into_stream_args;
+
+// Decode until the output is full, or all input is consumed and flushed.
+static void*
+decompress_into_stream_without_gvl(void* arg) {
+    decompress_into_stream_args* args = arg;
+    for (;;) {
+        ZSTD_outBuffer output = { args->dst + args->dst_size, args->dst_capacity - args->dst_size, 0 };
+        args->result = ZSTD_decompressStream(args->dctx, &output, &args->input);
+        args->dst_size += output.pos;
+        if (ZSTD_isError(args->result)) break;
+        if (args->dst_size == args->dst_capacity) break;
+        if (args->input.pos == args->input.size) break;
+    }
+    return NULL;
+}
+
+// Decode every frame of src into dst, starting from dst's current capacity
+// (at least initial_capacity) and doubling it up to opts->max_size.
+static size_t
+dctx_decompress_into_stream(vibe_zstd_dctx* dctx, const dctx_call_opts* opts, VALUE data, VALUE dst,
+                            const char* src, size_t srcSize) {
+    size_t capacity = rb_str_capacity(dst);
+    if (capacity < opts->initial_capacity) capacity = opts->initial_capacity;
+    if (opts->max_size && capacity > opts->max_size) capacity = opts->max_size;
+    vibe_zstd_prepare_output_buffer(data, dst, capacity);
+
+    decompress_into_stream_args args = {
+        .dctx = dctx->dctx,
+        .input = { src, srcSize, 0 },
+        .dst = NULL,
+        .dst_capacity = capacity,
+        .dst_size = 0,
+        .result = 1
+    };
+
+    ZSTD_DCtx_reset(dctx->dctx, ZSTD_reset_session_only);
+    for (;;) {
+        args.dst = RSTRING_PTR(dst);
+        vibe_zstd_nogvl_with_strs_locked(decompress_into_stream_without_gvl, &args, data, dst);
+        rb_str_set_len(dst, args.dst_size);
+
+        if (ZSTD_isError(args.result)) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(args.result));
+        }
+        if (args.input.pos == args.input.size && (args.result == 0 || args.dst_size < args.dst_capacity)) {
+            break;
+        }
+
+        // Output full: grow, clamped to the limit.
+        size_t new_capacity = args.dst_capacity * 2;
+        if (opts->max_size && new_capacity > opts->max_size) new_capacity = opts->max_size;
+        if (new_capacity <= args.dst_capacity) {
+            rb_raise(rb_eDecompressedSizeExceeded,
+                     "Decompressed output exceeds limit of %zu bytes", opts->max_size);
+        }
+        rb_str_modify_expand(dst, (long)(new_capacity - args.dst_size));
+        args.dst_capacity = new_capacity;
+    }
+
+    if (args.result != 0) {
+        rb_raise(rb_eRuntimeError, "Truncated frame: incomplete zstd data");
+    }
+    return args.dst_size;
+}
+
+// One-shot decode of all frames of src into dst, grown to capacity if needed.
+static size_t
+dctx_decompress_into_presized(vibe_zstd_dctx* dctx, const dctx_call_opts* opts, VALUE data, VALUE dst,
+                              const char* src, size_t srcSize, size_t capacity) {
+    vibe_zstd_prepare_output_buffer(data, dst, capacity);
+    decompress_args args = {
+        .dctx = dctx->dctx,
+        .ddict = opts->ddict,
+        .src = src,
+        .srcSize = srcSize,
+        .dst = RSTRING_PTR(dst),
+        .dstCapacity = capacity,
+        .result = 0
+    };
+    vibe_zstd_nogvl_with_strs_locked(decompress_without_gvl, &args, data, dst);
+    if (ZSTD_isError(args.result)) {
+        rb_str_set_len(dst, 0);
+        rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(args.result));
+    }
+    rb_str_set_len(dst, args.result);
+    return args.result;
+}
+
+// Body/cleanup pair so the streaming decompress_into path always returns the
+// context to no-dictionary mode.
+typedef struct {
+    vibe_zstd_dctx* dctx;
+    const dctx_call_opts* opts;
+    VALUE data;
+    VALUE dst;
+    const char* src;
+    size_t src_size;
+} dctx_decompress_into_state;
+
+static VALUE
+vibe_zstd_dctx_decompress_into_stream_body(VALUE p) {
+    dctx_decompress_into_state* state = (dctx_decompress_into_state*)p;
+    return SIZET2NUM(dctx_decompress_into_stream(state->dctx, state->opts, state->data, state->dst,
+                                                 state->src, state->src_size));
+}
+
+static VALUE
+vibe_zstd_dctx_decompress_into_stream_cleanup(VALUE p) {
+    dctx_decompress_into_state* state = (dctx_decompress_into_state*)p;
+    if (state->opts->ddict) {
+        ZSTD_DCtx_refDDict(state->dctx->dctx, NULL);
+    }
+    return Qnil;
+}
+
+static VALUE
+dctx_decompress_into_unknown_size(vibe_zstd_dctx* dctx, const dctx_call_opts* opts, VALUE data, VALUE dst,
+                                  const char* src, size_t srcSize) {
+    if (opts->ddict) {
+        size_t rd = ZSTD_DCtx_refDDict(dctx->dctx, opts->ddict);
+        if (ZSTD_isError(rd)) {
+            rb_raise(rb_eRuntimeError, "Failed to reference dictionary: %s", ZSTD_getErrorName(rd));
+        }
+    }
+    dctx_decompress_into_state state = { dctx, opts, data, dst, src, srcSize };
+    return rb_ensure(vibe_zstd_dctx_decompress_into_stream_body, (VALUE)&state,
+                     vibe_zstd_dctx_decompress_into_stream_cleanup, (VALUE)&state);
+}
+
+// decompress_into an IO::Buffer: its size is fixed, so all frames are decoded
+// in one pass straight into the buffer's memory (e.g. an IO::Buffer.map'd
+// file) and running out of room raises instead of growing.
+static VALUE
+dctx_decompress_into_io_buffer(vibe_zstd_dctx* dctx, const dctx_call_opts* opts, VALUE data, VALUE dst,
+                               const char* src, size_t srcSize, unsigned long long contentSize) {
+    char* out;
+    size_t buffer_size = 0;
+    vibe_zstd_output_target(data, dst, &out, &buffer_size);
+
+    size_t capacity = buffer_size;
+    if (opts->max_size && opts->max_size < capacity) capacity = opts->max_size;
+    if (contentSize != ZSTD_CONTENTSIZE_UNKNOWN) {
+        if (opts->max_size && contentSize > (unsigned long long)opts->max_size) {
+            rb_raise(rb_eDecompressedSizeExceeded,
+                     "Declared content size %llu exceeds limit of %zu bytes", contentSize, opts->max_size);
+        }
+        if (contentSize > (unsigned long long)buffer_size) {
+            rb_raise(rb_eArgError, "Output buffer too small (%zu bytes, %llu needed)", buffer_size, contentSize);
+        }
+    }
+
+    decompress_args args = {
+        .dctx = dctx->dctx,
+        .ddict = opts->ddict,
+        .src = src,
+        .srcSize = srcSize,
+        .dst = out,
+        .dstCapacity = capacity,
+        .result = 0
+    };
+    vibe_zstd_nogvl_with_strs_locked(decompress_without_gvl, &args, data, dst);
+    if (ZSTD_isError(args.result)) {
+        if (ZSTD_getErrorCode(args.result) == ZSTD_error_dstSize_tooSmall) {
+            if (capacity < buffer_size) {
+                rb_raise(rb_eDecompressedSizeExceeded,
+                         "Decompressed output exceeds limit of %zu bytes", opts->max_size);
+            }
+            rb_raise(rb_eArgError, "Output buffer too small (%zu bytes)", buffer_size);
+        }
+        rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(args.result));
+    }
+    return SIZET2NUM(args.result);
+}
+
+// DCtx decompress_into - Decompress into a caller-supplied String or IO::Buffer
+//
+// Accepts the same options as decompress (except threads:) and decodes every
+// frame of data, replacing the contents of dst. Returns the decompressed size.
+// A String dst is grown only when its capacity is too small: to the declared
+// content size, to ZSTD_decompressBound under the same rule as decompress, or
+// by doubling while streaming frames without a declared size. Capacity is
+// never released, so reusing one buffer per thread avoids allocating per call.
+// An IO::Buffer dst is filled from offset 0 and never resized; output that
+// does not fit raises ArgumentError.
+//
+// On error dst holds no meaningful data.
+static VALUE
+dctx_decompress_into_resolved(vibe_zstd_dctx* dctx, dctx_call_opts* opts, VALUE data, VALUE dst,
+                              const char* src, size_t srcSize) {
+    int dformat = 0;
+    (void)ZSTD_DCtx_getParameter(dctx->dctx, ZSTD_d_format, &dformat);
+    if (dformat == ZSTD_f_zstd1_magicless) {
+        if (vibe_zstd_io_buffer_p(dst)) {
+            return dctx_decompress_into_io_buffer(dctx, opts, data, dst, src, srcSize, ZSTD_CONTENTSIZE_UNKNOWN);
+        }
+        return dctx_decompress_into_unknown_size(dctx, opts, data, dst, src, srcSize);
+    }
+
+    unsigned long long contentSize;
+    size_t offset = dctx_inspect_frames(src, srcSize, opts, &contentSize);
+    src += offset;
+    srcSize -= offset;
+
+    if (vibe_zstd_io_buffer_p(dst)) {
+        return dctx_decompress_into_io_buffer(dctx, opts, data, dst, src, srcSize, contentSize);
+    }
+
+    if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+        unsigned long long bound = ZSTD_decompressBound(src, srcSize);
+        unsigned long long presize_limit = (unsigned long long)srcSize * VIBE_ZSTD_BOUND_PRESIZE_RATIO;
+        if (presize_limit < opts->initial_capacity) {
+            presize_limit = opts->initial_capacity;
+        }
+        if (bound != ZSTD_CONTENTSIZE_ERROR && bound <= presize_limit &&
+            (opts->max_size == 0 || bound <= (unsigned long long)opts->max_size)) {
+            return SIZET2NUM(dctx_decompress_into_presized(dctx, opts, data, dst, src, srcSize, (size_t)bound));
+        }
+        return dctx_decompress_into_unknown_size(dctx, opts, data, dst, src, srcSize);
+    }
+    if (opts->max_size && contentSize > (unsigned long long)opts->max_size) {
+        rb_raise(rb_eDecompressedSizeExceeded,
+                 "Declared content size %llu exceeds limit of %zu bytes", contentSize, opts->max_size);
+    }
+
+    return SIZET2NUM(dctx_decompress_into_presized(dctx, opts, data, dst, src, srcSize, (size_t)contentSize));
+}
+
+static VALUE
+vibe_zstd_dctx_decompress_into(int argc, VALUE* argv, VALUE self) {
+    VALUE data, dst, options = Qnil;
+    rb_scan_args(argc, argv, "2:", &data, &dst, &options);
+    vibe_zstd_dctx* dctx;
+    TypedData_Get_Struct(self, vibe_zstd_dctx, &vibe_zstd_dctx_type, dctx);
+    const char* src;
+    size_t srcSize;
+    data = vibe_zstd_input_bytes(data, &src, &srcSize);
+
+    dctx_call_opts opts;
+    dctx_resolve_call_opts(dctx, options, &opts);
+
+    // See vibe_zstd_dctx_decompress: keep a registry-picked DDict alive
+    VALUE result = dctx_decompress_into_resolved(dctx, &opts, data, dst, src, srcSize);
+    RB_GC_GUARD(opts.ddict_obj);
     return result;
 }
 
+// One entry of a decompress_batch call. dst is NULL for entries that cannot be
+// presized (unknown content size, magicless format); those are decoded
+// afterwards through the streaming path.
+//
+// source and output (Qnil without dst) are the Strings behind src and dst,
+// held here to pin them while the GVL is released; see compress_batch_job.
+// ddict is the input's dictionary (NULL: none, or the context's own), and
+// ddict_obj the DDict that owns it, kept alive the same way.
+typedef struct {
+    VALUE source;
+    VALUE output;
+    VALUE ddict_obj;
+    ZSTD_DDict* ddict;
+    const char* src;
+    size_t src_size;
+    char* dst;
+    size_t dst_capacity;
+    size_t result;
+} decompress_batch_job;
+
+// Batch decompress args for GVL release. next is the index of the first job
+// not yet run, so an interrupted section can resume where it stopped.
+typedef struct {
+    ZSTD_DCtx* dctx;
+    decompress_batch_job* jobs;
+    long count;
+    long next;
+    volatile int interrupted;
+} decompress_batch_args;
+
+// Decode every remaining presized job back-to-back against the same context,
+// each with its own dictionary, without the GVL. Stops at the first error (leaving next
+// pointing at the failed job) or when asked to return to Ruby.
+static void*
+decompress_batch_without_gvl(void* arg) {
+    decompress_batch_args* args = arg;
+    while (args->next < args->count && !args->interrupted) {
+        decompress_batch_job* job = &args->jobs[args->next];
+        if (job->dst) {
+            if (job->ddict) {
+                job->result = ZSTD_decompress_usingDDict(args->dctx, job->dst, job->dst_capacity,
+                                                         job->src, job->src_size, job->ddict);
+            } else {
+                job->result = ZSTD_decompressDCtx(args->dctx, job->dst, job->dst_capacity,
+                                                  job->src, job->src_size);
+            }
+            if (ZSTD_isError(job->result)) break;
+        }
+        args->next++;
+    }
+    return NULL;
+}
+
+// Unblocking function: lets interrupts be serviced between jobs.
+static void
+decompress_batch_ubf(void* arg) {
+    decompress_batch_args* args = arg;
+    args->interrupted = 1;
+}
+
+// DCtx decompress_batch - Decompress an Array of frames in one GVL release
+//
+// Equivalent to array.map { |s| decompress(s, dict:, ...) }, but keyword
+// arguments are parsed once, every frame is validated and its output presized
+// from the declared content size up front, and all presized frames are decoded
+// back-to-back in a single rb_thread_call_without_gvl section. Frames without
+// a declared content size fall back to the streaming path individually.
+//
+// Inputs are pinned with frozen snapshots rather than rb_str_locktmp so the
+// same String may appear several times in one batch.
+static VALUE
+vibe_zstd_dctx_decompress_batch(int argc, VALUE* argv, VALUE self) {
+    VALUE inputs, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &inputs, &options);
+    vibe_zstd_dctx* dctx;
+    TypedData_Get_Struct(self, vibe_zstd_dctx, &vibe_zstd_dctx_type, dctx);
+    Check_Type(inputs, T_ARRAY);
+
+    dctx_call_opts opts;
+    dctx_resolve_call_opts(dctx, options, &opts);
+
+    // See vibe_zstd_dctx_decompress: magicless frames cannot be introspected.
+    int dformat = 0;
+    (void)ZSTD_DCtx_getParameter(dctx->dctx, ZSTD_d_format, &dformat);
+    int magicless = (dformat == ZSTD_f_zstd1_magicless);
+
+    long count = RARRAY_LEN(inputs);
+    VALUE sources = rb_ary_new_capa(count);
+    VALUE results = rb_ary_new_capa(count);
+    VALUE jobs_buf;
+    decompress_batch_job* jobs = ALLOCV_N(decompress_batch_job, jobs_buf, count);
+
+    for (long i = 0; i < count; i++) {
+        VALUE data = rb_ary_entry(inputs, i);
+        StringValue(data);
+        data = rb_str_new_frozen(data);
+        rb_ary_push(sources, data);
+
+        const char* src = RSTRING_PTR(data);
+        size_t srcSize = RSTRING_LEN(data);
+        unsigned long long contentSize = ZSTD_CONTENTSIZE_UNKNOWN;
+
+        dctx_call_opts entry;
+        dctx_entry_opts(&opts, &entry);
+        if (!magicless) {
+            size_t offset = dctx_inspect_frames(src, srcSize, &entry, &contentSize);
+            src += offset;
+            srcSize -= offset;
+        }
+
+        jobs[i].source = data;
+        jobs[i].output = Qnil;
+        jobs[i].ddict_obj = entry.ddict_obj;
+        jobs[i].ddict = entry.ddict;
+        jobs[i].src_size = srcSize;
+        jobs[i].dst = NULL;
+        jobs[i].dst_capacity = 0;
+        jobs[i].result = 0;
+
+        if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+            rb_ary_push(results, Qnil);
+            continue;
+        }
+        if (opts.max_size && contentSize > (unsigned long long)opts.max_size) {
+            rb_raise(rb_eDecompressedSizeExceeded,
+                     "Declared content size %llu exceeds limit of %zu bytes (index %ld)",
+                     contentSize, opts.max_size, i);
+        }
+
+        VALUE result = rb_str_new(NULL, contentSize);
+        rb_ary_push(results, result);
+        jobs[i].output = result;
+        jobs[i].dst_capacity = contentSize;
+    }
+    // Take the buffer pointers only once nothing else is allocated (see
+    // compress_batch). The leading skippable frames are the part of the source
+    // in front of the last src_size bytes.
+    for (long i = 0; i < count; i++) {
+        jobs[i].src = RSTRING_END(jobs[i].source) - jobs[i].src_size;
+        if (!NIL_P(jobs[i].output)) jobs[i].dst = RSTRING_PTR(jobs[i].output);
+    }
+
+    decompress_batch_args args = {
+        .dctx = dctx->dctx,
+        .jobs = jobs,
+        .count = count,
+        .next = 0,
+        .interrupted = 0
+    };
+    // Re-enter the no-GVL section if an interrupt was serviced without raising.
+    while (args.next < args.count) {
+        args.interrupted = 0;
+        vibe_zstd_call_without_gvl(decompress_batch_without_gvl, &args, decompress_batch_ubf, &args);
+        if (args.next < args.count && ZSTD_isError(jobs[args.next].result)) {
+            rb_raise(rb_eRuntimeError, "Decompression failed at index %ld: %s",
+                     args.next, ZSTD_getErrorName(jobs[args.next].result));
+        }
+    }
+
+    for (long i = 0; i < count; i++) {
+        if (jobs[i].dst) {
+            rb_str_set_len(RARRAY_AREF(results, i), jobs[i].result);
+        } else {
+            VALUE data = RARRAY_AREF(sources, i);
+            dctx_call_opts entry = opts;
+            entry.ddict = jobs[i].ddict;
+            entry.ddict_obj = jobs[i].ddict_obj;
+            rb_ary_store(results, i, dctx_decompress_unknown_size(dctx, &entry, data, jobs[i].src, jobs[i].src_size));
+        }
+    }
+
+    ALLOCV_END(jobs_buf);
+    RB_GC_GUARD(sources);
+    RB_GC_GUARD(results);
+    RB_GC_GUARD(opts.ddict_obj);
+    return results;
+}
+
 // DCtx use_prefix - use raw data as prefix (lightweight dictionary)
 static VALUE
 vibe_zstd_dctx_use_prefix(VALUE self, VALUE prefix_data) {
@@ -744,11 +1431,14 @@ vibe_zstd_dctx_init_class(VALUE rb_cVibeZstdDCtx) {
     rb_define_alloc_func(rb_cVibeZstdDCtx, vibe_zstd_dctx_alloc);
     rb_define_method(rb_cVibeZstdDCtx, "initialize", vibe_zstd_dctx_initialize, -1);
     rb_define_method(rb_cVibeZstdDCtx, "decompress", vibe_zstd_dctx_decompress, -1);
+    rb_define_method(rb_cVibeZstdDCtx, "decompress_into", vibe_zstd_dctx_decompress_into, -1);
+    rb_define_method(rb_cVibeZstdDCtx, "decompress_batch", vibe_zstd_dctx_decompress_batch, -1);
     rb_define_method(rb_cVibeZstdDCtx, "use_prefix", vibe_zstd_dctx_use_prefix, 1);
     rb_define_method(rb_cVibeZstdDCtx, "reset", vibe_zstd_dctx_reset, -1);
     rb_define_singleton_method(rb_cVibeZstdDCtx, "parameter_bounds", vibe_zstd_dctx_parameter_bounds, 1);
     rb_define_singleton_method(rb_cVibeZstdDCtx, "frame_content_size", vibe_zstd_dctx_frame_content_size, 1);
     rb_define_singleton_method(rb_cVibeZstdDCtx, "estimate_memory", vibe_zstd_dctx_estimate_memory, 0);
+    rb_define_method(rb_cVibeZstdDCtx, "memory_size", vibe_zstd_dctx_memory_size, 0);
 
     // Class-level default_initial_capacity accessors
     rb_define_singleton_method(rb_cVibeZstdDCtx, "default_initial_capacity", vibe_zstd_dctx_get_default_initial_capacity, 0);
@@ -1,12 +1,25 @@
 // Dictionary implementation for VibeZstd
+//
+// By default CDict/DDict copy the dictionary content into the zstd object.
+// With by_reference: true (and for CDict.open / DDict.open) they are built
+// with ZSTD_dlm_byRef instead and only point at the content: a frozen String
+// kept alive (and pinned against GC compaction) by the dictionary, or a
+// read-only mmap of the dictionary file. Mapped dictionaries share the page
+// cache, so every process that opens the same file uses one copy of the
+// content. The digested tables (hash tables for a CDict, entropy tables for
+// a DDict) are still built per object.
 #include "vibe_zstd_internal.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Forward declarations
 static VALUE vibe_zstd_cdict_initialize(int argc, VALUE* argv, VALUE self);
 static VALUE vibe_zstd_cdict_size(VALUE self);
 static VALUE vibe_zstd_cdict_dict_id(VALUE self);
 static VALUE vibe_zstd_cdict_estimate_memory(VALUE self, VALUE dict_size, VALUE level);
-static VALUE vibe_zstd_ddict_initialize(VALUE self, VALUE dict_data);
+static VALUE vibe_zstd_ddict_initialize(int argc, VALUE* argv, VALUE self);
 static VALUE vibe_zstd_ddict_size(VALUE self);
 static VALUE vibe_zstd_ddict_dict_id(VALUE self);
 static VALUE vibe_zstd_ddict_estimate_memory(VALUE self, VALUE dict_size);
@@ -22,27 +35,168 @@ static VALUE vibe_zstd_dict_header_size(VALUE self, VALUE dict_data);
 extern rb_data_type_t vibe_zstd_cdict_type;
 extern rb_data_type_t vibe_zstd_ddict_type;
 
-// CDict initialize method
+// Hold dict_data for a dictionary built by reference. The frozen copy shares
+// the caller's buffer rather than duplicating it (unless the String is small
+// enough to be embedded), and stays unchanged if the caller's String is later
+// modified.
 static VALUE
-vibe_zstd_cdict_initialize(int argc, VALUE* argv, VALUE self) {
-    VALUE dict_data, level = Qnil;
-    rb_scan_args(argc, argv, "11", &dict_data, &level);
-    vibe_zstd_cdict* cdict;
-    TypedData_Get_Struct(self, vibe_zstd_cdict, &vibe_zstd_cdict_type, cdict);
+dict_content_pin(VALUE self, vibe_zstd_dict_content* content, VALUE dict_data,
+                 const char** ptr, size_t* size) {
+    if (vibe_zstd_io_buffer_p(dict_data)) {
+        rb_raise(rb_eTypeError, "by_reference needs a String; use open to map a dictionary file");
+    }
     StringValue(dict_data);
-    int lvl = NIL_P(level) ? ZSTD_defaultCLevel() : NUM2INT(level);
-    cdict->cdict = ZSTD_createCDict(RSTRING_PTR(dict_data), RSTRING_LEN(dict_data), lvl);
+    VALUE source = rb_str_new_frozen(dict_data);
+    RB_OBJ_WRITE(self, &content->source, source);
+    *ptr = RSTRING_PTR(source);
+    *size = RSTRING_LEN(source);
+    return source;
+}
+
+// Map the dictionary file at path read-only. The mapping is released when the
+// dictionary is freed (vibe_zstd_dict_content_release). The file must not be
+// truncated while mapped; replace dictionary files by renaming a new file over
+// them instead.
+static void
+dict_content_map(vibe_zstd_dict_content* content, VALUE path, const char** ptr, size_t* size) {
+    int fd = open(RSTRING_PTR(path), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        rb_sys_fail_str(path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        rb_syserr_fail_str(err, path);
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        rb_raise(rb_eArgError, "Dictionary file is empty: %"PRIsVALUE, path);
+    }
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int err = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        rb_syserr_fail_str(err, path);
+    }
+    content->map = map;
+    content->map_size = (size_t)st.st_size;
+    *ptr = map;
+    *size = content->map_size;
+}
+
+static void
+vibe_zstd_dict_content_release(vibe_zstd_dict_content* content) {
+    if (content->map) {
+        munmap(content->map, content->map_size);
+        content->map = NULL;
+    }
+}
+
+// Frozen String with the content of a copying CDict, kept as @dict_data for
+// to_ddict. An IO::Buffer is copied, since its bytes can change afterwards.
+static VALUE
+dict_data_frozen(VALUE dict_data, const char* ptr, size_t size) {
+    if (vibe_zstd_io_buffer_p(dict_data)) {
+        return rb_obj_freeze(rb_str_new(ptr, size));
+    }
+    return rb_str_new_frozen(dict_data);
+}
+
+static int
+dict_by_reference_option(VALUE options) {
+    return !NIL_P(options) && RTEST(rb_hash_aref(options, ID2SYM(rb_intern("by_reference"))));
+}
+
+static void
+cdict_create(vibe_zstd_cdict* cdict, const char* dict_ptr, size_t dict_size, int lvl, int by_reference) {
+    // Both keep the compression level in the CDict, unlike ZSTD_createCDict_advanced
+    cdict->cdict = by_reference ? ZSTD_createCDict_byReference(dict_ptr, dict_size, lvl)
+                                : ZSTD_createCDict(dict_ptr, dict_size, lvl);
     if (!cdict->cdict) {
         rb_raise(rb_eRuntimeError, "Failed to create ZSTD_CDict");
     }
+    vibe_zstd_mem_track(ZSTD_sizeof_CDict(cdict->cdict));
+    vibe_zstd_mem_flush();
+}
+
+static void
+ddict_create(vibe_zstd_ddict* ddict, const char* dict_ptr, size_t dict_size, int by_reference) {
+    ddict->ddict = ZSTD_createDDict_advanced(dict_ptr, dict_size,
+                                             by_reference ? ZSTD_dlm_byRef : ZSTD_dlm_byCopy,
+                                             ZSTD_dct_auto, vibe_zstd_custom_mem);
+    if (!ddict->ddict) {
+        rb_raise(rb_eRuntimeError, "Failed to create ZSTD_DDict");
+    }
+    vibe_zstd_mem_flush();
+}
+
+// CDict.new(dict_data, level = nil, by_reference: false)
+static VALUE
+vibe_zstd_cdict_initialize(int argc, VALUE* argv, VALUE self) {
+    VALUE dict_data, level = Qnil, options = Qnil;
+    rb_scan_args(argc, argv, "11:", &dict_data, &level, &options);
+    vibe_zstd_cdict* cdict;
+    TypedData_Get_Struct(self, vibe_zstd_cdict, &vibe_zstd_cdict_type, cdict);
+    const char* dict_ptr;
+    size_t dict_size;
+    int by_reference = dict_by_reference_option(options);
+    if (by_reference) {
+        dict_data = dict_content_pin(self, &cdict->content, dict_data, &dict_ptr, &dict_size);
+    } else {
+        dict_data = vibe_zstd_input_bytes(dict_data, &dict_ptr, &dict_size);
+    }
+    int lvl = NIL_P(level) ? ZSTD_defaultCLevel() : NUM2INT(level);
+    cdict_create(cdict, dict_ptr, dict_size, lvl, by_reference);
 
-    // Store dictionary data and level for later retrieval
+    // Store dictionary data and level for later retrieval (by reference, this
+    // is the content the CDict points into, not another copy)
+    if (!by_reference) {
+        dict_data = dict_data_frozen(dict_data, dict_ptr, dict_size);
+    }
     rb_ivar_set(self, rb_intern("@dict_data"), dict_data);
     rb_ivar_set(self, rb_intern("@compression_level"), INT2NUM(lvl));
 
+    // Dictionaries never change once built: frozen, they can be shared
+    // between Ractors (Ractor.make_shareable, or passed to Ractor.new)
+    rb_obj_freeze(self);
     return self;
 }
 
+// CDict.open(path, level = nil) - CDict over a read-only mapping of a
+// dictionary file. level may also be given as level:.
+static VALUE
+vibe_zstd_cdict_open(int argc, VALUE* argv, VALUE klass) {
+    VALUE path, level = Qnil, options = Qnil;
+    rb_scan_args(argc, argv, "11:", &path, &level, &options);
+    if (NIL_P(level) && !NIL_P(options)) {
+        level = rb_hash_aref(options, ID2SYM(rb_intern("level")));
+    }
+    FilePathValue(path);
+    int lvl = NIL_P(level) ? ZSTD_defaultCLevel() : NUM2INT(level);
+
+    VALUE self = rb_obj_alloc(klass);
+    vibe_zstd_cdict* cdict;
+    TypedData_Get_Struct(self, vibe_zstd_cdict, &vibe_zstd_cdict_type, cdict);
+    const char* dict_ptr;
+    size_t dict_size;
+    dict_content_map(&cdict->content, path, &dict_ptr, &dict_size);
+    cdict_create(cdict, dict_ptr, dict_size, lvl, 1);
+
+    rb_ivar_set(self, rb_intern("@path"), rb_str_new_frozen(path));
+    rb_ivar_set(self, rb_intern("@compression_level"), INT2NUM(lvl));
+    rb_obj_freeze(self);
+    return self;
+}
+
+// CDict#by_reference? - Whether the CDict points into content it does not own
+static VALUE
+vibe_zstd_cdict_by_reference_p(VALUE self) {
+    vibe_zstd_cdict* cdict;
+    TypedData_Get_Struct(self, vibe_zstd_cdict, &vibe_zstd_cdict_type, cdict);
+    return (!NIL_P(cdict->content.source) || cdict->content.map) ? Qtrue : Qfalse;
+}
+
 // CDict size method - returns the size in memory
 static VALUE
 vibe_zstd_cdict_size(VALUE self) {
@@ -67,19 +221,56 @@ vibe_zstd_cdict_dict_id(VALUE self) {
     return UINT2NUM(dictID);
 }
 
-// DDict initialize method
-static VALUE
-vibe_zstd_ddict_initialize(VALUE self, VALUE dict_data) {
+// Build the DDict self over dict_data (shared by DDict.new and CDict#to_ddict)
+static void
+ddict_build(VALUE self, VALUE dict_data, int by_reference) {
     vibe_zstd_ddict* ddict;
     TypedData_Get_Struct(self, vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict);
-    StringValue(dict_data);
-    ddict->ddict = ZSTD_createDDict(RSTRING_PTR(dict_data), RSTRING_LEN(dict_data));
-    if (!ddict->ddict) {
-        rb_raise(rb_eRuntimeError, "Failed to create ZSTD_DDict");
+    const char* dict_ptr;
+    size_t dict_size;
+    if (by_reference) {
+        dict_content_pin(self, &ddict->content, dict_data, &dict_ptr, &dict_size);
+    } else {
+        dict_data = vibe_zstd_input_bytes(dict_data, &dict_ptr, &dict_size);
     }
+    ddict_create(ddict, dict_ptr, dict_size, by_reference);
+    RB_GC_GUARD(dict_data);
+    rb_obj_freeze(self);
+}
+
+// DDict.new(dict_data, by_reference: false)
+static VALUE
+vibe_zstd_ddict_initialize(int argc, VALUE* argv, VALUE self) {
+    VALUE dict_data, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &dict_data, &options);
+    ddict_build(self, dict_data, dict_by_reference_option(options));
+    return self;
+}
+
+// DDict.open(path) - DDict over a read-only mapping of a dictionary file
+static VALUE
+vibe_zstd_ddict_open(VALUE klass, VALUE path) {
+    FilePathValue(path);
+    VALUE self = rb_obj_alloc(klass);
+    vibe_zstd_ddict* ddict;
+    TypedData_Get_Struct(self, vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict);
+    const char* dict_ptr;
+    size_t dict_size;
+    dict_content_map(&ddict->content, path, &dict_ptr, &dict_size);
+    ddict_create(ddict, dict_ptr, dict_size, 1);
+    rb_ivar_set(self, rb_intern("@path"), rb_str_new_frozen(path));
+    rb_obj_freeze(self);
     return self;
 }
 
+// DDict#by_reference? - Whether the DDict points into content it does not own
+static VALUE
+vibe_zstd_ddict_by_reference_p(VALUE self) {
+    vibe_zstd_ddict* ddict;
+    TypedData_Get_Struct(self, vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict);
+    return (!NIL_P(ddict->content.source) || ddict->content.map) ? Qtrue : Qfalse;
+}
+
 // DDict size method - returns the size in memory
 static VALUE
 vibe_zstd_ddict_size(VALUE self) {
@@ -104,6 +295,42 @@ vibe_zstd_ddict_dict_id(VALUE self) {
     return UINT2NUM(dictID);
 }
 
+// CDict#to_ddict (alias ddict) - The matching DDict, built on the first call
+// and reused afterwards. A CDict opened from a file opens the DDict from the
+// same file; one built by reference shares its content.
+//
+// The DDict is cached in the struct rather than an instance variable, as the
+// CDict is frozen. Ractors sharing the CDict may both build one; the first
+// stored wins and the other is left to the GC.
+static VALUE
+vibe_zstd_cdict_to_ddict(VALUE self) {
+    vibe_zstd_cdict* cdict;
+    TypedData_Get_Struct(self, vibe_zstd_cdict, &vibe_zstd_cdict_type, cdict);
+    VALUE ddict = RUBY_ATOMIC_VALUE_CAS(cdict->ddict, Qnil, Qnil);
+    if (!NIL_P(ddict)) {
+        return ddict;
+    }
+
+    VALUE path = rb_attr_get(self, rb_intern("@path"));
+    VALUE dict_data = rb_attr_get(self, rb_intern("@dict_data"));
+    if (!NIL_P(path)) {
+        ddict = vibe_zstd_ddict_open(rb_cVibeZstdDDict, path);
+    } else if (!NIL_P(dict_data)) {
+        ddict = rb_obj_alloc(rb_cVibeZstdDDict);
+        ddict_build(ddict, dict_data, !NIL_P(cdict->content.source));
+    } else {
+        // DictArena#cdict keeps no dictionary data outside the arena
+        rb_raise(rb_eArgError, "CDict was built in a DictArena; build its DDict with DictArena#ddict");
+    }
+
+    VALUE stored = RUBY_ATOMIC_VALUE_CAS(cdict->ddict, Qnil, ddict);
+    if (!NIL_P(stored)) {
+        return stored;
+    }
+    RB_OBJ_WRITTEN(self, Qundef, ddict);
+    return ddict;
+}
+
 // Cleanup structure for dictionary training operations
 // Groups all allocated resources for dictionary training so they can be
 // freed together in error paths or on success
@@ -488,8 +715,10 @@ vibe_zstd_train_dict_fast_cover(int argc, VALUE* argv, VALUE self) {
 // VibeZstd.get_dict_id(dict_data)
 static VALUE
 vibe_zstd_get_dict_id(VALUE self, VALUE dict_data) {
-    StringValue(dict_data);
-    unsigned dict_id = ZDICT_getDictID(RSTRING_PTR(dict_data), RSTRING_LEN(dict_data));
+    const char* dict_ptr;
+    size_t dict_size;
+    dict_data = vibe_zstd_input_bytes(dict_data, &dict_ptr, &dict_size);
+    unsigned dict_id = ZDICT_getDictID(dict_ptr, dict_size);
     return UINT2NUM(dict_id);
 }
 
@@ -497,8 +726,10 @@ vibe_zstd_get_dict_id(VALUE self, VALUE dict_data) {
 // VibeZstd.get_dict_id_from_frame(data)
 static VALUE
 vibe_zstd_get_dict_id_from_frame(VALUE self, VALUE data) {
-    StringValue(data);
-    unsigned dict_id = ZSTD_getDictID_fromFrame(RSTRING_PTR(data), RSTRING_LEN(data));
+    const char* src;
+    size_t src_size;
+    data = vibe_zstd_input_bytes(data, &src, &src_size);
+    unsigned dict_id = ZSTD_getDictID_fromFrame(src, src_size);
     return UINT2NUM(dict_id);
 }
 
@@ -592,8 +823,10 @@ vibe_zstd_finalize_dictionary(int argc, VALUE* argv, VALUE self) {
 // VibeZstd.dict_header_size(dict_data)
 static VALUE
 vibe_zstd_dict_header_size(VALUE self, VALUE dict_data) {
-    StringValue(dict_data);
-    size_t header_size = ZDICT_getDictHeaderSize(RSTRING_PTR(dict_data), RSTRING_LEN(dict_data));
+    const char* dict_ptr;
+    size_t dict_size;
+    dict_data = vibe_zstd_input_bytes(dict_data, &dict_ptr, &dict_size);
+    size_t header_size = ZDICT_getDictHeaderSize(dict_ptr, dict_size);
 
     // Check for errors
     if (ZDICT_isError(header_size)) {
@@ -628,13 +861,19 @@ vibe_zstd_dict_init_classes(VALUE rb_cVibeZstdCDict, VALUE rb_cVibeZstdDDict) {
     rb_define_method(rb_cVibeZstdCDict, "initialize", vibe_zstd_cdict_initialize, -1);
     rb_define_method(rb_cVibeZstdCDict, "size", vibe_zstd_cdict_size, 0);
     rb_define_method(rb_cVibeZstdCDict, "dict_id", vibe_zstd_cdict_dict_id, 0);
+    rb_define_method(rb_cVibeZstdCDict, "by_reference?", vibe_zstd_cdict_by_reference_p, 0);
+    rb_define_method(rb_cVibeZstdCDict, "to_ddict", vibe_zstd_cdict_to_ddict, 0);
+    rb_define_method(rb_cVibeZstdCDict, "ddict", vibe_zstd_cdict_to_ddict, 0);
+    rb_define_singleton_method(rb_cVibeZstdCDict, "open", vibe_zstd_cdict_open, -1);
     rb_define_singleton_method(rb_cVibeZstdCDict, "estimate_memory", vibe_zstd_cdict_estimate_memory, 2);
 
     // DDict class setup
     rb_define_alloc_func(rb_cVibeZstdDDict, vibe_zstd_ddict_alloc);
-    rb_define_method(rb_cVibeZstdDDict, "initialize", vibe_zstd_ddict_initialize, 1);
+    rb_define_method(rb_cVibeZstdDDict, "initialize", vibe_zstd_ddict_initialize, -1);
     rb_define_method(rb_cVibeZstdDDict, "size", vibe_zstd_ddict_size, 0);
     rb_define_method(rb_cVibeZstdDDict, "dict_id", vibe_zstd_ddict_dict_id, 0);
+    rb_define_method(rb_cVibeZstdDDict, "by_reference?", vibe_zstd_ddict_by_reference_p, 0);
+    rb_define_singleton_method(rb_cVibeZstdDDict, "open", vibe_zstd_ddict_open, 1);
     rb_define_singleton_method(rb_cVibeZstdDDict, "estimate_memory", vibe_zstd_ddict_estimate_memory, 1);
 }
 
@@ -0,0 +1,227 @@
+// Pre-fork dictionary arena for VibeZstd
+//
+// A DictArena is one page-aligned anonymous mapping that CDicts and DDicts are
+// built inside with ZSTD_initStaticCDict / ZSTD_initStaticDDict: the zstd
+// structs, digested tables and dictionary content are all carved out of it,
+// and the Ruby CDict/DDict objects only point there. A preforking server
+// (Unicorn, Puma cluster mode) fills the arena in the master and seals it;
+// forked workers then share those pages copy-on-write for good. Regular
+// dictionaries live in malloc'd blocks next to Ruby's own allocations, so
+// heap activity in every worker gradually dirties their pages and each worker
+// ends up with a private copy.
+//
+// seal makes the mapping read-only: nothing writes to a CDict or DDict while
+// compressing or decompressing, so sharing can't be broken by accident, and no
+// more dictionaries can be added. The arena stays mapped until it and every
+// dictionary built in it have been garbage collected.
+#include "vibe_zstd_internal.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Dictionaries start on cache-line boundaries (zstd itself needs 8 bytes)
+#define DICT_ARENA_ALIGN 64
+
+static vibe_zstd_dict_arena*
+dict_arena_get(VALUE self) {
+    vibe_zstd_dict_arena* arena;
+    TypedData_Get_Struct(self, vibe_zstd_dict_arena, &vibe_zstd_dict_arena_type, arena);
+    if (!arena->base) {
+        rb_raise(rb_eRuntimeError, "DictArena is not initialized");
+    }
+    return arena;
+}
+
+static size_t
+dict_arena_align(size_t size) {
+    return (size + DICT_ARENA_ALIGN - 1) & ~(size_t)(DICT_ARENA_ALIGN - 1);
+}
+
+// Compression parameters of an arena CDict. Static CDicts carry no compression
+// level: compressing with one uses these parameters whatever level the CCtx has.
+static ZSTD_compressionParameters
+dict_arena_cparams(int level, size_t dict_size) {
+    return ZSTD_getCParams(level, ZSTD_CONTENTSIZE_UNKNOWN, dict_size);
+}
+
+static size_t
+dict_arena_cdict_size(int level, size_t dict_size) {
+    return dict_arena_align(ZSTD_estimateCDictSize_advanced(dict_size, dict_arena_cparams(level, dict_size),
+                                                            ZSTD_dlm_byCopy));
+}
+
+static size_t
+dict_arena_ddict_size(size_t dict_size) {
+    return dict_arena_align(ZSTD_estimateDDictSize(dict_size, ZSTD_dlm_byCopy));
+}
+
+// Reserve size bytes at the end of the arena. The space is committed (used is
+// advanced) by the caller once the dictionary has been built in it.
+static void*
+dict_arena_reserve(VALUE self, vibe_zstd_dict_arena* arena, size_t size) {
+    if (arena->sealed) {
+        rb_raise(rb_eRuntimeError, "DictArena is sealed");
+    }
+    // Frozen by Ractor.make_shareable: other Ractors may be reading it
+    rb_check_frozen(self);
+    if (size > arena->capacity - arena->used) {
+        rb_raise(rb_eRuntimeError, "DictArena is full: %zu bytes needed, %zu of %zu free",
+                 size, arena->capacity - arena->used, arena->capacity);
+    }
+    return arena->base + arena->used;
+}
+
+// DictArena.new(capacity) - capacity is rounded up to whole pages
+static VALUE
+vibe_zstd_dict_arena_initialize(VALUE self, VALUE capacity) {
+    vibe_zstd_dict_arena* arena;
+    TypedData_Get_Struct(self, vibe_zstd_dict_arena, &vibe_zstd_dict_arena_type, arena);
+    if (arena->base) {
+        rb_raise(rb_eRuntimeError, "DictArena is already initialized");
+    }
+    size_t size = NUM2SIZET(capacity);
+    if (size == 0) {
+        rb_raise(rb_eArgError, "capacity must be positive");
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size = (size + page - 1) / page * page;
+
+    // Private, so pages are shared copy-on-write after fork and a worker can
+    // never change another process's dictionaries
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        rb_sys_fail("mmap");
+    }
+    arena->base = base;
+    arena->capacity = size;
+    return self;
+}
+
+// DictArena#cdict(dict_data, level = nil) - CDict built inside the arena
+static VALUE
+vibe_zstd_dict_arena_cdict(int argc, VALUE* argv, VALUE self) {
+    VALUE dict_data, level;
+    rb_scan_args(argc, argv, "11", &dict_data, &level);
+    vibe_zstd_dict_arena* arena = dict_arena_get(self);
+    const char* dict_ptr;
+    size_t dict_size;
+    dict_data = vibe_zstd_input_bytes(dict_data, &dict_ptr, &dict_size);
+    int lvl = NIL_P(level) ? ZSTD_defaultCLevel() : NUM2INT(level);
+
+    VALUE obj = rb_obj_alloc(rb_cVibeZstdCDict);
+    vibe_zstd_cdict* cdict;
+    TypedData_Get_Struct(obj, vibe_zstd_cdict, &vibe_zstd_cdict_type, cdict);
+    size_t size = dict_arena_cdict_size(lvl, dict_size);
+    void* workspace = dict_arena_reserve(self, arena, size);
+    const ZSTD_CDict* result = ZSTD_initStaticCDict(workspace, size, dict_ptr, dict_size,
+                                                    ZSTD_dlm_byCopy, ZSTD_dct_auto,
+                                                    dict_arena_cparams(lvl, dict_size));
+    RB_GC_GUARD(dict_data);
+    if (!result) {
+        rb_raise(rb_eRuntimeError, "Failed to create ZSTD_CDict in DictArena");
+    }
+    arena->used += size;
+    arena->dict_count++;
+
+    // Never freed by ZSTD_freeCDict: the memory belongs to the arena
+    cdict->cdict = (ZSTD_CDict*)result;
+    RB_OBJ_WRITE(obj, &cdict->content.arena, self);
+    rb_ivar_set(obj, rb_intern("@compression_level"), INT2NUM(lvl));
+    rb_obj_freeze(obj);
+    return obj;
+}
+
+// DictArena#ddict(dict_data) - DDict built inside the arena
+static VALUE
+vibe_zstd_dict_arena_ddict(VALUE self, VALUE dict_data) {
+    vibe_zstd_dict_arena* arena = dict_arena_get(self);
+    const char* dict_ptr;
+    size_t dict_size;
+    dict_data = vibe_zstd_input_bytes(dict_data, &dict_ptr, &dict_size);
+
+    VALUE obj = rb_obj_alloc(rb_cVibeZstdDDict);
+    vibe_zstd_ddict* ddict;
+    TypedData_Get_Struct(obj, vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict);
+    size_t size = dict_arena_ddict_size(dict_size);
+    void* workspace = dict_arena_reserve(self, arena, size);
+    const ZSTD_DDict* result = ZSTD_initStaticDDict(workspace, size, dict_ptr, dict_size,
+                                                    ZSTD_dlm_byCopy, ZSTD_dct_auto);
+    RB_GC_GUARD(dict_data);
+    if (!result) {
+        rb_raise(rb_eRuntimeError, "Failed to create ZSTD_DDict in DictArena");
+    }
+    arena->used += size;
+    arena->dict_count++;
+
+    ddict->ddict = (ZSTD_DDict*)result;
+    RB_OBJ_WRITE(obj, &ddict->content.arena, self);
+    rb_obj_freeze(obj);
+    return obj;
+}
+
+// DictArena#seal - Make the arena read-only; call before forking workers.
+// The arena is frozen as well, which makes it and its dictionaries shareable
+// between Ractors.
+static VALUE
+vibe_zstd_dict_arena_seal(VALUE self) {
+    vibe_zstd_dict_arena* arena = dict_arena_get(self);
+    if (!arena->sealed) {
+        rb_check_frozen(self);
+        if (mprotect(arena->base, arena->capacity, PROT_READ) != 0) {
+            rb_sys_fail("mprotect");
+        }
+        arena->sealed = 1;
+        rb_obj_freeze(self);
+    }
+    return self;
+}
+
+static VALUE
+vibe_zstd_dict_arena_sealed_p(VALUE self) {
+    return dict_arena_get(self)->sealed ? Qtrue : Qfalse;
+}
+
+static VALUE
+vibe_zstd_dict_arena_capacity(VALUE self) {
+    return SIZET2NUM(dict_arena_get(self)->capacity);
+}
+
+static VALUE
+vibe_zstd_dict_arena_used(VALUE self) {
+    return SIZET2NUM(dict_arena_get(self)->used);
+}
+
+// DictArena#size - Number of dictionaries built in the arena
+static VALUE
+vibe_zstd_dict_arena_size(VALUE self) {
+    return SIZET2NUM(dict_arena_get(self)->dict_count);
+}
+
+// DictArena.cdict_size(dict_size, level = nil) - Arena bytes one CDict takes
+static VALUE
+vibe_zstd_dict_arena_s_cdict_size(int argc, VALUE* argv, VALUE klass) {
+    VALUE dict_size, level;
+    rb_scan_args(argc, argv, "11", &dict_size, &level);
+    int lvl = NIL_P(level) ? ZSTD_defaultCLevel() : NUM2INT(level);
+    return SIZET2NUM(dict_arena_cdict_size(lvl, NUM2SIZET(dict_size)));
+}
+
+// DictArena.ddict_size(dict_size) - Arena bytes one DDict takes
+static VALUE
+vibe_zstd_dict_arena_s_ddict_size(VALUE klass, VALUE dict_size) {
+    return SIZET2NUM(dict_arena_ddict_size(NUM2SIZET(dict_size)));
+}
+
+void
+vibe_zstd_dict_arena_init_class(VALUE rb_cVibeZstdDictArena) {
+    rb_define_alloc_func(rb_cVibeZstdDictArena, vibe_zstd_dict_arena_alloc);
+    rb_define_method(rb_cVibeZstdDictArena, "initialize", vibe_zstd_dict_arena_initialize, 1);
+    rb_define_method(rb_cVibeZstdDictArena, "cdict", vibe_zstd_dict_arena_cdict, -1);
+    rb_define_method(rb_cVibeZstdDictArena, "ddict", vibe_zstd_dict_arena_ddict, 1);
+    rb_define_method(rb_cVibeZstdDictArena, "seal", vibe_zstd_dict_arena_seal, 0);
+    rb_define_method(rb_cVibeZstdDictArena, "sealed?", vibe_zstd_dict_arena_sealed_p, 0);
+    rb_define_method(rb_cVibeZstdDictArena, "capacity", vibe_zstd_dict_arena_capacity, 0);
+    rb_define_method(rb_cVibeZstdDictArena, "used", vibe_zstd_dict_arena_used, 0);
+    rb_define_method(rb_cVibeZstdDictArena, "size", vibe_zstd_dict_arena_size, 0);
+    rb_define_singleton_method(rb_cVibeZstdDictArena, "cdict_size", vibe_zstd_dict_arena_s_cdict_size, -1);
+    rb_define_singleton_method(rb_cVibeZstdDictArena, "ddict_size", vibe_zstd_dict_arena_s_ddict_size, 1);
+}
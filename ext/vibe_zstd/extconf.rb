@@ -25,6 +25,9 @@ $defs << "-DZSTD_MULTITHREAD" # Enable multithreading support
 # Link with pthread for multithreading
 have_library("pthread") || abort("pthread library is required for multithreading support")
 
+# IO::Buffer input/output (public C accessors since Ruby 3.2)
+have_func("rb_io_buffer_get_bytes_for_reading", "ruby/io/buffer.h")
+
 # Makes all symbols private by default to avoid unintended conflict
 # with other gems. To explicitly export symbols you can use RUBY_FUNC_EXPORTED
 # selectively, or entirely remove this flag.
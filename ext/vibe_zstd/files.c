@@ -0,0 +1,385 @@
+// File-to-file compression for VibeZstd
+//
+// CCtx#compress_file / DCtx#decompress_file stream one file into another on
+// raw file descriptors. The whole read -> (de)compress -> write loop runs
+// without the GVL, with no Ruby IO objects or per-chunk Ruby Strings in
+// between, so the cost is close to the zstd CLI's.
+#include "vibe_zstd_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read and write granularity: eight ZSTD_CStreamInSize() blocks, so reads stay
+// block-aligned within the file and syscalls are few.
+#define VIBE_ZSTD_FILE_CHUNK (1 << 20)
+
+// State of one file job. The no-GVL loop can stop early when the unblocking
+// function asks it to (interrupted); the caller checks interrupts and resumes
+// it where it left off.
+typedef struct {
+    VALUE src_path;
+    VALUE dst_path;
+    int src_fd;
+    int dst_fd;
+    int remove_dst;  // set once dst is known to be a regular, distinct file
+    int opts_applied;
+    char* in_buf;
+    char* out_buf;
+    ZSTD_inBuffer input;
+    int src_eof;
+    int output_full;               // last call filled out_buf; more may be pending
+    unsigned long long bytes_in;
+    unsigned long long bytes_out;
+    int done;
+    volatile int interrupted;
+    // Outcome of the no-GVL loop
+    int sys_errno;
+    int sys_errno_dst;  // the failing syscall was on dst (else src)
+    size_t zstd_error;
+    int limit_exceeded;
+    size_t last_ret;
+    // Context-specific
+    ZSTD_CCtx* cctx;
+    cctx_call_opts* copts;
+    vibe_zstd_dctx* dctx;
+    const dctx_call_opts* dopts;
+} file_job;
+
+static void
+file_job_ubf(void* arg) {
+    file_job* job = arg;
+    job->interrupted = 1;
+}
+
+// read(2) retried on EINTR. Returns bytes read, 0 at EOF, -1 on error.
+static ssize_t
+file_read(int fd, char* buf, size_t size) {
+    ssize_t n;
+    do {
+        n = read(fd, buf, size);
+    } while (n < 0 && errno == EINTR);
+    return n;
+}
+
+// write(2) the whole buffer, retrying short writes and EINTR.
+static int
+file_write_all(int fd, const char* buf, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, buf, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+// Refill the input buffer once the previous chunk is consumed. Returns 0 on
+// success (possibly setting src_eof), -1 on a read error.
+static int
+file_job_fill(file_job* job) {
+    ssize_t n = file_read(job->src_fd, job->in_buf, VIBE_ZSTD_FILE_CHUNK);
+    if (n < 0) {
+        job->sys_errno = errno;
+        return -1;
+    }
+    if (n == 0) job->src_eof = 1;
+    job->input.src = job->in_buf;
+    job->input.size = (size_t)n;
+    job->input.pos = 0;
+    job->bytes_in += (unsigned long long)n;
+    return 0;
+}
+
+static int
+file_job_flush(file_job* job, size_t size) {
+    if (size == 0) return 0;
+    if (file_write_all(job->dst_fd, job->out_buf, size) < 0) {
+        job->sys_errno = errno;
+        job->sys_errno_dst = 1;
+        return -1;
+    }
+    job->bytes_out += size;
+    return 0;
+}
+
+static void*
+compress_file_without_gvl(void* arg) {
+    file_job* job = arg;
+    while (!job->done && !job->interrupted) {
+        if (job->input.pos == job->input.size && !job->src_eof) {
+            if (file_job_fill(job) < 0) return NULL;
+        }
+        ZSTD_EndDirective mode = job->src_eof ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_outBuffer output = { job->out_buf, VIBE_ZSTD_FILE_CHUNK, 0 };
+        size_t ret = ZSTD_compressStream2(job->cctx, &output, &job->input, mode);
+        if (ZSTD_isError(ret)) {
+            job->zstd_error = ret;
+            return NULL;
+        }
+        if (file_job_flush(job, output.pos) < 0) return NULL;
+        if (mode == ZSTD_e_end && ret == 0) job->done = 1;
+    }
+    return NULL;
+}
+
+static void*
+decompress_file_without_gvl(void* arg) {
+    file_job* job = arg;
+    size_t max_size = job->dopts->max_size;
+    while (!job->done && !job->interrupted) {
+        if (job->input.pos == job->input.size && !job->output_full) {
+            if (job->src_eof) {
+                job->done = 1;
+                break;
+            }
+            if (file_job_fill(job) < 0) return NULL;
+            continue;
+        }
+        ZSTD_outBuffer output = { job->out_buf, VIBE_ZSTD_FILE_CHUNK, 0 };
+        size_t ret = ZSTD_decompressStream(job->dctx->dctx, &output, &job->input);
+        if (ZSTD_isError(ret)) {
+            job->zstd_error = ret;
+            return NULL;
+        }
+        if (max_size && job->bytes_out + output.pos > max_size) {
+            job->limit_exceeded = 1;
+            return NULL;
+        }
+        if (file_job_flush(job, output.pos) < 0) return NULL;
+        job->output_full = (output.pos == output.size);
+        job->last_ret = ret;
+    }
+    return NULL;
+}
+
+// Open src and dst, refusing to overwrite src with itself. dst is truncated
+// only after that check.
+static void
+file_job_open(file_job* job, struct stat* src_stat) {
+    const char* src = RSTRING_PTR(job->src_path);
+    const char* dst = RSTRING_PTR(job->dst_path);
+
+    job->src_fd = rb_cloexec_open(src, O_RDONLY, 0);
+    if (job->src_fd < 0) rb_sys_fail_str(job->src_path);
+    rb_update_max_fd(job->src_fd);
+    if (fstat(job->src_fd, src_stat) < 0) rb_sys_fail_str(job->src_path);
+    if (S_ISDIR(src_stat->st_mode)) rb_syserr_fail_str(EISDIR, job->src_path);
+
+    job->dst_fd = rb_cloexec_open(dst, O_WRONLY | O_CREAT, 0666);
+    if (job->dst_fd < 0) rb_sys_fail_str(job->dst_path);
+    rb_update_max_fd(job->dst_fd);
+
+    struct stat dst_stat;
+    if (fstat(job->dst_fd, &dst_stat) < 0) rb_sys_fail_str(job->dst_path);
+    if (dst_stat.st_dev == src_stat->st_dev && dst_stat.st_ino == src_stat->st_ino) {
+        rb_raise(rb_eArgError, "source and destination are the same file: %"PRIsVALUE, job->src_path);
+    }
+    job->remove_dst = S_ISREG(dst_stat.st_mode);
+    if (job->remove_dst && ftruncate(job->dst_fd, 0) < 0) rb_sys_fail_str(job->dst_path);
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    (void)posix_fadvise(job->src_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    job->in_buf = vibe_zstd_malloc(VIBE_ZSTD_FILE_CHUNK);
+    job->out_buf = vibe_zstd_malloc(VIBE_ZSTD_FILE_CHUNK);
+    if (!job->in_buf || !job->out_buf) {
+        rb_raise(rb_eNoMemError, "Failed to allocate file buffers");
+    }
+}
+
+// Run the no-GVL loop to completion, checking interrupts whenever the
+// unblocking function stops it, then raise for whatever made it fail.
+static void
+file_job_run(file_job* job, void* (*func)(void*), const char* what) {
+    for (;;) {
+        vibe_zstd_call_without_gvl(func, job, file_job_ubf, job);
+        if (!job->interrupted) break;
+        job->interrupted = 0;
+        rb_thread_check_ints();
+    }
+    if (job->sys_errno) {
+        rb_syserr_fail_str(job->sys_errno, job->sys_errno_dst ? job->dst_path : job->src_path);
+    }
+    if (job->limit_exceeded) {
+        rb_raise(rb_eDecompressedSizeExceeded,
+                 "Decompressed output exceeds limit of %zu bytes", job->dopts->max_size);
+    }
+    if (job->zstd_error) {
+        rb_raise(rb_eRuntimeError, "%s failed: %s", what, ZSTD_getErrorName(job->zstd_error));
+    }
+}
+
+// Cleanup shared by both directions: close both files, free the buffers and,
+// unless the job completed, remove the partial destination file.
+static void
+file_job_release(file_job* job) {
+    if (job->src_fd >= 0) close(job->src_fd);
+    if (job->dst_fd >= 0) close(job->dst_fd);
+    job->src_fd = job->dst_fd = -1;
+    if (!job->done && job->remove_dst) unlink(RSTRING_PTR(job->dst_path));
+    vibe_zstd_free(job->in_buf);
+    vibe_zstd_free(job->out_buf);
+    job->in_buf = job->out_buf = NULL;
+}
+
+static VALUE
+compress_file_body(VALUE arg) {
+    file_job* job = (file_job*)arg;
+    struct stat src_stat;
+    file_job_open(job, &src_stat);
+
+    // Pledge the source size so the frame header records it and zstd can size
+    // its window and tables for the actual input.
+    if (!job->copts->has_pledged && S_ISREG(src_stat.st_mode)) {
+        job->copts->has_pledged = 1;
+        job->copts->pledged_size = (unsigned long long)src_stat.st_size;
+    }
+    ZSTD_CCtx_reset(job->cctx, ZSTD_reset_session_only);
+    cctx_apply_call_opts(job->cctx, job->copts);
+    job->opts_applied = 1;
+    // workers = :auto sizes the job split from the file; a pipe of unknown
+    // length is assumed to be large
+    cctx_apply_auto_workers(job->cctx, job->copts,
+                            job->copts->has_pledged ? (size_t)job->copts->pledged_size : SIZE_MAX);
+
+    file_job_run(job, compress_file_without_gvl, "Compression");
+    return ULL2NUM(job->bytes_out);
+}
+
+static VALUE
+compress_file_cleanup(VALUE arg) {
+    file_job* job = (file_job*)arg;
+    if (job->opts_applied) cctx_restore_call_opts(job->cctx, job->copts);
+    if (!job->done) ZSTD_CCtx_reset(job->cctx, ZSTD_reset_session_only);
+    file_job_release(job);
+    return Qnil;
+}
+
+// CCtx compress_file - Compress the file at src_path into dst_path
+//
+// Accepts the same per-call options as compress (level:, dict:, pledged_size:)
+// and honors every parameter set on the context, including workers for
+// multi-threaded compression. The source size from fstat is pledged unless
+// pledged_size: is given, so the frame records its content size.
+//
+// Reads 1 MiB at a time with posix_fadvise(SEQUENTIAL) and writes straight to
+// the destination descriptor, all without the GVL. dst_path is created or
+// truncated; if compression fails or is interrupted the partial file is
+// removed. Returns the compressed size in bytes.
+static VALUE
+vibe_zstd_cctx_compress_file(int argc, VALUE* argv, VALUE self) {
+    VALUE src_path, dst_path, options = Qnil;
+    rb_scan_args(argc, argv, "2:", &src_path, &dst_path, &options);
+    vibe_zstd_cctx* cctx;
+    TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+    vibe_zstd_cctx_after_fork(self, cctx);
+    FilePathValue(src_path);
+    FilePathValue(dst_path);
+
+    cctx_call_opts opts;
+    cctx_parse_call_opts(options, &opts);
+    cctx_prepare_auto_workers(self, cctx, &opts);
+
+    file_job job;
+    memset(&job, 0, sizeof(job));
+    job.src_path = src_path;
+    job.dst_path = dst_path;
+    job.src_fd = job.dst_fd = -1;
+    job.cctx = cctx->cctx;
+    job.copts = &opts;
+
+    VALUE result = rb_ensure(compress_file_body, (VALUE)&job, compress_file_cleanup, (VALUE)&job);
+    RB_GC_GUARD(src_path);
+    RB_GC_GUARD(dst_path);
+    return result;
+}
+
+static VALUE
+decompress_file_body(VALUE arg) {
+    file_job* job = (file_job*)arg;
+    struct stat src_stat;
+    file_job_open(job, &src_stat);
+
+    ZSTD_DCtx_reset(job->dctx->dctx, ZSTD_reset_session_only);
+    if (job->dopts->ddict) {
+        job->opts_applied = 1;
+        size_t rd = ZSTD_DCtx_refDDict(job->dctx->dctx, job->dopts->ddict);
+        if (ZSTD_isError(rd)) {
+            rb_raise(rb_eRuntimeError, "Failed to reference dictionary: %s", ZSTD_getErrorName(rd));
+        }
+    }
+
+    job->last_ret = 1;
+    file_job_run(job, decompress_file_without_gvl, "Decompression");
+    if (job->bytes_in == 0) {
+        job->done = 0;
+        rb_raise(rb_eRuntimeError, "No compressed data in %"PRIsVALUE, job->src_path);
+    }
+    if (job->last_ret != 0) {
+        job->done = 0;
+        rb_raise(rb_eRuntimeError, "Truncated frame: incomplete zstd data");
+    }
+    return ULL2NUM(job->bytes_out);
+}
+
+static VALUE
+decompress_file_cleanup(VALUE arg) {
+    file_job* job = (file_job*)arg;
+    if (job->opts_applied) ZSTD_DCtx_refDDict(job->dctx->dctx, NULL);
+    if (!job->done) ZSTD_DCtx_reset(job->dctx->dctx, ZSTD_reset_session_only);
+    file_job_release(job);
+    return Qnil;
+}
+
+// DCtx decompress_file - Decompress the file at src_path into dst_path
+//
+// Accepts dict: and max_decompressed_size: (alias max_size:) like decompress
+// and honors the context's parameters (window_log_max, format). Every frame
+// of concatenated input is decoded, so the output matches `zstd -d`.
+//
+// Reads 1 MiB at a time with posix_fadvise(SEQUENTIAL) and writes straight to
+// the destination descriptor, all without the GVL. dst_path is created or
+// truncated; on failure, truncated input or interruption the partial file is
+// removed. Returns the decompressed size in bytes.
+static VALUE
+vibe_zstd_dctx_decompress_file(int argc, VALUE* argv, VALUE self) {
+    VALUE src_path, dst_path, options = Qnil;
+    rb_scan_args(argc, argv, "2:", &src_path, &dst_path, &options);
+    vibe_zstd_dctx* dctx;
+    TypedData_Get_Struct(self, vibe_zstd_dctx, &vibe_zstd_dctx_type, dctx);
+    FilePathValue(src_path);
+    FilePathValue(dst_path);
+
+    dctx_call_opts opts;
+    dctx_resolve_call_opts(dctx, options, &opts);
+    // The file is streamed through this DCtx, which would have to hold raw
+    // pointers to every registered dictionary past the call
+    if (!NIL_P(opts.registry)) {
+        rb_raise(rb_eArgError, "decompress_file needs a DDict, not a DictionaryRegistry");
+    }
+
+    file_job job;
+    memset(&job, 0, sizeof(job));
+    job.src_path = src_path;
+    job.dst_path = dst_path;
+    job.src_fd = job.dst_fd = -1;
+    job.dctx = dctx;
+    job.dopts = &opts;
+
+    VALUE result = rb_ensure(decompress_file_body, (VALUE)&job, decompress_file_cleanup, (VALUE)&job);
+    RB_GC_GUARD(src_path);
+    RB_GC_GUARD(dst_path);
+    return result;
+}
+
+// Method registration called from main Init_vibe_zstd
+void
+vibe_zstd_files_init_methods(VALUE rb_cVibeZstdCCtx, VALUE rb_cVibeZstdDCtx) {
+    rb_define_method(rb_cVibeZstdCCtx, "compress_file", vibe_zstd_cctx_compress_file, -1);
+    rb_define_method(rb_cVibeZstdDCtx, "decompress_file", vibe_zstd_dctx_decompress_file, -1);
+}
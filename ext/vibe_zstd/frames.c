@@ -12,8 +12,10 @@ vibe_zstd_compress_bound(VALUE self, VALUE size) {
 static VALUE
 vibe_zstd_skippable_frame_p(VALUE self, VALUE data) {
     (void)self;
-    StringValue(data);
-    unsigned result = ZSTD_isSkippableFrame(RSTRING_PTR(data), RSTRING_LEN(data));
+    const char* src;
+    size_t src_size;
+    data = vibe_zstd_input_bytes(data, &src, &src_size);
+    unsigned result = ZSTD_isSkippableFrame(src, src_size);
     return result ? Qtrue : Qfalse;
 }
 
@@ -23,7 +25,9 @@ vibe_zstd_write_skippable_frame(int argc, VALUE *argv, VALUE self) {
     VALUE data, options;
     rb_scan_args(argc, argv, "11", &data, &options);
 
-    StringValue(data);
+    const char* src;
+    size_t src_size;
+    data = vibe_zstd_input_bytes(data, &src, &src_size);
 
     unsigned magic_variant = 0;  // Default to 0
     if (!NIL_P(options)) {
@@ -37,9 +41,6 @@ vibe_zstd_write_skippable_frame(int argc, VALUE *argv, VALUE self) {
         }
     }
 
-    const char* src = RSTRING_PTR(data);
-    size_t src_size = RSTRING_LEN(data);
-
     // Skippable frame structure: 4-byte magic (0x184D2A5X) + 4-byte size + content
     // Decoders skip these frames, allowing custom metadata/padding
     size_t frame_size = 8 + src_size;
@@ -64,15 +65,14 @@ vibe_zstd_write_skippable_frame(int argc, VALUE *argv, VALUE self) {
 static VALUE
 vibe_zstd_read_skippable_frame(VALUE self, VALUE data) {
     (void)self;
-    StringValue(data);
+    const char* src;
+    size_t src_size;
+    data = vibe_zstd_input_bytes(data, &src, &src_size);
 
-    if (!ZSTD_isSkippableFrame(RSTRING_PTR(data), RSTRING_LEN(data))) {
-        rb_raise(rb_eArgError, "data is not a skippable frame (%zu bytes provided)", RSTRING_LEN(data));
+    if (!ZSTD_isSkippableFrame(src, src_size)) {
+        rb_raise(rb_eArgError, "data is not a skippable frame (%zu bytes provided)", src_size);
     }
 
-    const char* src = RSTRING_PTR(data);
-    size_t src_size = RSTRING_LEN(data);
-
     // Content size is in bytes 4-7 (little-endian uint32)
     if (src_size < 8) {
         rb_raise(rb_eArgError, "skippable frame too small (%zu bytes, minimum 8 bytes required)", src_size);
@@ -119,11 +119,13 @@ vibe_zstd_read_skippable_frame(VALUE self, VALUE data) {
 static VALUE
 vibe_zstd_find_frame_compressed_size(VALUE self, VALUE data) {
     (void)self;
-    StringValue(data);
+    const char* src;
+    size_t src_size;
+    data = vibe_zstd_input_bytes(data, &src, &src_size);
 
     // Returns compressed size of first complete frame (including header/checksum)
     // Useful for splitting concatenated frames in multi-frame archives
-    size_t frame_size = ZSTD_findFrameCompressedSize(RSTRING_PTR(data), RSTRING_LEN(data));
+    size_t frame_size = ZSTD_findFrameCompressedSize(src, src_size);
 
     if (ZSTD_isError(frame_size)) {
         rb_raise(rb_eRuntimeError, "Failed to find frame size: %s", ZSTD_getErrorName(frame_size));
@@ -0,0 +1,839 @@
+// Parallel batch engine for VibeZstd
+//
+// VibeZstd.compress_many / decompress_many spread many independent payloads
+// across cores without any Ruby threads. Work runs on a process-wide native
+// thread pool (zstd's own POOL_ctx from libzstd/common/pool.c), each worker
+// using a pre-created ZSTD_CCtx/ZSTD_DCtx kept on a free list between calls.
+// All workers share one CDict/DDict (both are read-only once built) and the
+// GVL is released once for the whole batch.
+#include "vibe_zstd_internal.h"
+#include <pthread.h>
+#include <unistd.h>
+#include "pool.h"
+
+// Upper bound on threads: per call, and idle contexts kept per kind
+#define VIBE_ZSTD_MANY_MAX_THREADS 256
+#define VIBE_ZSTD_MANY_MAX_IDLE 64
+
+// Process-wide engine state. The pool grows to the largest helper count any
+// call has asked for. Idle contexts are reused across calls so steady-state
+// batches never pay context creation.
+static struct {
+    pthread_mutex_t lock;
+    POOL_ctx* pool;
+    size_t pool_threads;
+    pid_t pool_pid;           // threads do not survive fork; see many_acquire_pool
+    ZSTD_CCtx* idle_cctx[VIBE_ZSTD_MANY_MAX_IDLE];
+    size_t idle_cctx_count;
+    ZSTD_DCtx* idle_dctx[VIBE_ZSTD_MANY_MAX_IDLE];
+    size_t idle_dctx_count;
+} many_engine = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, {NULL}, 0, {NULL}, 0 };
+
+// Return the shared pool with at least `helpers` threads, creating or growing it
+// as needed. Returns NULL if the pool cannot be created.
+static POOL_ctx*
+many_acquire_pool(size_t helpers) {
+    pthread_mutex_lock(&many_engine.lock);
+    // A pool inherited across fork() has no threads behind it: joining them
+    // would be undefined, so abandon it and build a fresh one in the child.
+    if (many_engine.pool && many_engine.pool_pid != getpid()) {
+        many_engine.pool = NULL;
+        many_engine.pool_threads = 0;
+    }
+    if (!many_engine.pool) {
+        many_engine.pool = POOL_create(helpers, VIBE_ZSTD_MANY_MAX_THREADS);
+        many_engine.pool_threads = many_engine.pool ? helpers : 0;
+        many_engine.pool_pid = getpid();
+    } else if (many_engine.pool_threads < helpers) {
+        if (POOL_resize(many_engine.pool, helpers) == 0) {
+            many_engine.pool_threads = helpers;
+        }
+    }
+    POOL_ctx* pool = (many_engine.pool_threads >= helpers) ? many_engine.pool : NULL;
+    pthread_mutex_unlock(&many_engine.lock);
+    return pool;
+}
+
+// Fill ctxs[0..n) from the idle list, creating contexts as needed.
+// Returns the number acquired (less than n only on allocation failure).
+static size_t
+many_acquire_cctxs(ZSTD_CCtx** ctxs, size_t n) {
+    size_t got = 0;
+    pthread_mutex_lock(&many_engine.lock);
+    while (got < n && many_engine.idle_cctx_count > 0) {
+        ctxs[got++] = many_engine.idle_cctx[--many_engine.idle_cctx_count];
+    }
+    pthread_mutex_unlock(&many_engine.lock);
+    while (got < n && (ctxs[got] = ZSTD_createCCtx_advanced(vibe_zstd_custom_mem)) != NULL) {
+        got++;
+    }
+    return got;
+}
+
+static void
+many_release_cctxs(ZSTD_CCtx** ctxs, size_t n) {
+    pthread_mutex_lock(&many_engine.lock);
+    for (size_t i = 0; i < n; i++) {
+        // Drop the shared dictionary reference before parking the context
+        ZSTD_CCtx_refCDict(ctxs[i], NULL);
+        if (many_engine.idle_cctx_count < VIBE_ZSTD_MANY_MAX_IDLE) {
+            many_engine.idle_cctx[many_engine.idle_cctx_count++] = ctxs[i];
+        } else {
+            ZSTD_freeCCtx(ctxs[i]);
+        }
+    }
+    pthread_mutex_unlock(&many_engine.lock);
+}
+
+static size_t
+many_acquire_dctxs(ZSTD_DCtx** ctxs, size_t n) {
+    size_t got = 0;
+    pthread_mutex_lock(&many_engine.lock);
+    while (got < n && many_engine.idle_dctx_count > 0) {
+        ctxs[got++] = many_engine.idle_dctx[--many_engine.idle_dctx_count];
+    }
+    pthread_mutex_unlock(&many_engine.lock);
+    while (got < n && (ctxs[got] = ZSTD_createDCtx_advanced(vibe_zstd_custom_mem)) != NULL) {
+        got++;
+    }
+    return got;
+}
+
+static void
+many_release_dctxs(ZSTD_DCtx** ctxs, size_t n) {
+    pthread_mutex_lock(&many_engine.lock);
+    for (size_t i = 0; i < n; i++) {
+        ZSTD_DCtx_reset(ctxs[i], ZSTD_reset_session_and_parameters);
+        if (many_engine.idle_dctx_count < VIBE_ZSTD_MANY_MAX_IDLE) {
+            many_engine.idle_dctx[many_engine.idle_dctx_count++] = ctxs[i];
+        } else {
+            ZSTD_freeDCtx(ctxs[i]);
+        }
+    }
+    pthread_mutex_unlock(&many_engine.lock);
+}
+
+// One parallel run over `count` jobs. Workers claim contiguous chunks of job
+// indices under `lock`; every claimed job is completed before the worker looks
+// at `cancelled` again, so after a run all indices below `next` are done and a
+// cancelled run can resume from `next`.
+typedef struct many_run many_run;
+
+typedef struct {
+    many_run* run;
+    void* zctx;  // ZSTD_CCtx* or ZSTD_DCtx* owned by this worker
+} many_worker;
+
+struct many_run {
+    pthread_mutex_t lock;
+    pthread_cond_t done_cond;
+    POOL_ctx* pool;
+    many_worker* workers;
+    size_t nworkers;
+    size_t helpers_running;
+    int (*run_job)(many_run* run, void* zctx, long index);  // returns 0 on failure
+    void* jobs;
+    long count;
+    long next;
+    long chunk;
+    long failed;  // lowest failing index, or -1
+    int cancelled;
+};
+
+static void
+many_worker_loop(many_run* run, void* zctx) {
+    for (;;) {
+        pthread_mutex_lock(&run->lock);
+        if (run->cancelled || run->failed >= 0 || run->next >= run->count) {
+            pthread_mutex_unlock(&run->lock);
+            return;
+        }
+        long begin = run->next;
+        long end = begin + run->chunk;
+        if (end > run->count) end = run->count;
+        run->next = end;
+        pthread_mutex_unlock(&run->lock);
+
+        for (long i = begin; i < end; i++) {
+            if (!run->run_job(run, zctx, i)) {
+                pthread_mutex_lock(&run->lock);
+                if (run->failed < 0 || i < run->failed) run->failed = i;
+                pthread_mutex_unlock(&run->lock);
+                return;
+            }
+        }
+    }
+}
+
+// Entry point for pool threads
+static void
+many_pool_task(void* opaque) {
+    many_worker* worker = opaque;
+    many_run* run = worker->run;
+    many_worker_loop(run, worker->zctx);
+
+    pthread_mutex_lock(&run->lock);
+    if (--run->helpers_running == 0) {
+        pthread_cond_signal(&run->done_cond);
+    }
+    pthread_mutex_unlock(&run->lock);
+}
+
+// Runs without the GVL. The calling thread works as worker 0 alongside the
+// pool helpers, then waits for every helper to finish: the jobs live on the
+// caller's stack, so no helper may still be touching them when we return.
+static void*
+many_run_without_gvl(void* arg) {
+    many_run* run = arg;
+    run->helpers_running = run->nworkers - 1;
+    for (size_t i = 1; i < run->nworkers; i++) {
+        POOL_add(run->pool, many_pool_task, &run->workers[i]);
+    }
+
+    many_worker_loop(run, run->workers[0].zctx);
+
+    pthread_mutex_lock(&run->lock);
+    while (run->helpers_running > 0) {
+        pthread_cond_wait(&run->done_cond, &run->lock);
+    }
+    pthread_mutex_unlock(&run->lock);
+    return NULL;
+}
+
+// Unblocking function: stop claiming new chunks so interrupts are serviced promptly
+static void
+many_run_ubf(void* arg) {
+    many_run* run = arg;
+    pthread_mutex_lock(&run->lock);
+    run->cancelled = 1;
+    pthread_mutex_unlock(&run->lock);
+}
+
+// Drive a run to completion (or first failure) from Ruby, re-entering the
+// no-GVL section if an interrupt was serviced without raising.
+static void
+many_run_execute(many_run* run) {
+    // A few chunks per worker balances load without contending on the lock per job
+    run->chunk = run->count / (long)(run->nworkers * 8);
+    if (run->chunk < 1) run->chunk = 1;
+
+    while (run->next < run->count && run->failed < 0) {
+        run->cancelled = 0;
+        vibe_zstd_call_without_gvl(many_run_without_gvl, run, many_run_ubf, run);
+    }
+}
+
+// Parse threads: (nil = online CPUs) and clamp to [1, job count]
+static size_t
+many_thread_count(VALUE threads_val, long count) {
+    long threads;
+    if (NIL_P(threads_val)) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (threads < 1) threads = 1;
+    } else {
+        threads = NUM2LONG(threads_val);
+        if (threads < 1) {
+            rb_raise(rb_eArgError, "threads must be at least 1 (got %ld)", threads);
+        }
+    }
+    if (threads > VIBE_ZSTD_MANY_MAX_THREADS) threads = VIBE_ZSTD_MANY_MAX_THREADS;
+    if (threads > count) threads = count;
+    return threads < 1 ? 1 : (size_t)threads;
+}
+
+// Set up run->pool for nworkers (helpers = nworkers - 1), degrading to fewer
+// workers if the pool cannot be created.
+static void
+many_run_init(many_run* run, size_t nworkers) {
+    pthread_mutex_init(&run->lock, NULL);
+    pthread_cond_init(&run->done_cond, NULL);
+    run->pool = NULL;
+    if (nworkers > 1) {
+        run->pool = many_acquire_pool(nworkers - 1);
+        if (!run->pool) nworkers = 1;
+    }
+    run->nworkers = nworkers;
+    run->helpers_running = 0;
+    run->next = 0;
+    run->failed = -1;
+    run->cancelled = 0;
+}
+
+static void
+many_run_destroy(many_run* run) {
+    pthread_cond_destroy(&run->done_cond);
+    pthread_mutex_destroy(&run->lock);
+}
+
+// --- compress_many -----------------------------------------------------------
+
+static int
+many_compress_job(many_run* run, void* zctx, long index) {
+    compress_batch_job* job = &((compress_batch_job*)run->jobs)[index];
+    job->result = ZSTD_compress2((ZSTD_CCtx*)zctx, job->dst, job->dst_capacity, job->src, job->src_size);
+    return !ZSTD_isError(job->result);
+}
+
+// State for the rb_ensure-wrapped compress_many: worker contexts must go back
+// to the idle list on every exit path.
+typedef struct {
+    many_run* run;
+    ZSTD_CCtx** ctxs;
+    size_t nctxs;
+    const cctx_call_opts* opts;
+} many_compress_state;
+
+static VALUE
+many_compress_body(VALUE p) {
+    many_compress_state* state = (many_compress_state*)p;
+    many_run* run = state->run;
+
+    // Configure each worker identically: default parameters, per-call level,
+    // and the shared dictionary.
+    for (size_t i = 0; i < state->nctxs; i++) {
+        ZSTD_CCtx* zc = state->ctxs[i];
+        ZSTD_CCtx_reset(zc, ZSTD_reset_session_and_parameters);
+        if (state->opts->has_level) {
+            size_t sp = ZSTD_CCtx_setParameter(zc, ZSTD_c_compressionLevel, state->opts->level);
+            if (ZSTD_isError(sp)) {
+                rb_raise(rb_eArgError, "Invalid level %d: %s", state->opts->level, ZSTD_getErrorName(sp));
+            }
+        }
+        if (state->opts->cdict) {
+            size_t rc = ZSTD_CCtx_refCDict(zc, state->opts->cdict);
+            if (ZSTD_isError(rc)) {
+                rb_raise(rb_eRuntimeError, "Failed to set dictionary: %s", ZSTD_getErrorName(rc));
+            }
+        }
+        run->workers[i].run = run;
+        run->workers[i].zctx = zc;
+    }
+
+    many_run_execute(run);
+
+    if (run->failed >= 0) {
+        compress_batch_job* job = &((compress_batch_job*)run->jobs)[run->failed];
+        rb_raise(rb_eRuntimeError, "Compression failed at index %ld: %s",
+                 run->failed, ZSTD_getErrorName(job->result));
+    }
+    return Qnil;
+}
+
+static VALUE
+many_compress_cleanup(VALUE p) {
+    many_compress_state* state = (many_compress_state*)p;
+    many_release_cctxs(state->ctxs, state->nctxs);
+    many_run_destroy(state->run);
+    return Qnil;
+}
+
+// VibeZstd.compress_many(array, threads: nil, level: nil, dict: nil)
+//
+// Compresses every String in array into an independent frame, in parallel on
+// the native worker pool, and returns the frames in input order. Output is
+// byte-identical to array.map { |s| VibeZstd.compress(s, level:, dict:) }.
+// threads defaults to the number of online CPUs and is capped at array.size.
+static VALUE
+vibe_zstd_compress_many(int argc, VALUE* argv, VALUE self) {
+    (void)self;
+    VALUE inputs, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &inputs, &options);
+    Check_Type(inputs, T_ARRAY);
+
+    cctx_call_opts opts;
+    cctx_parse_call_opts(options, &opts);
+    if (opts.has_pledged) {
+        rb_raise(rb_eArgError, "pledged_size is not supported by compress_many");
+    }
+    VALUE threads_val = NIL_P(options) ? Qnil : rb_hash_aref(options, ID2SYM(rb_intern("threads")));
+
+    long count = RARRAY_LEN(inputs);
+    VALUE sources = rb_ary_new_capa(count);
+    VALUE results = rb_ary_new_capa(count);
+    VALUE jobs_buf;
+    compress_batch_job* jobs = ALLOCV_N(compress_batch_job, jobs_buf, count);
+
+    // Pin inputs and presize outputs exactly as compress_batch does
+    for (long i = 0; i < count; i++) {
+        VALUE data = rb_ary_entry(inputs, i);
+        StringValue(data);
+        data = rb_str_new_frozen(data);
+        rb_ary_push(sources, data);
+
+        size_t src_size = RSTRING_LEN(data);
+        size_t dst_capacity = ZSTD_compressBound(src_size);
+        VALUE result_str = rb_str_new(NULL, dst_capacity);
+        rb_ary_push(results, result_str);
+
+        jobs[i].source = data;
+        jobs[i].output = result_str;
+        jobs[i].src_size = src_size;
+        jobs[i].dst_capacity = dst_capacity;
+        jobs[i].result = 0;
+    }
+    for (long i = 0; i < count; i++) {
+        jobs[i].src = RSTRING_PTR(jobs[i].source);
+        jobs[i].dst = RSTRING_PTR(jobs[i].output);
+    }
+    if (count == 0) return results;
+
+    size_t nworkers = many_thread_count(threads_val, count);
+    many_run run;
+    many_run_init(&run, nworkers);
+    run.run_job = many_compress_job;
+    run.jobs = jobs;
+    run.count = count;
+
+    ZSTD_CCtx* ctxs[VIBE_ZSTD_MANY_MAX_THREADS];
+    many_worker workers[VIBE_ZSTD_MANY_MAX_THREADS];
+    run.workers = workers;
+    size_t nctxs = many_acquire_cctxs(ctxs, run.nworkers);
+    if (nctxs == 0) {
+        many_run_destroy(&run);
+        rb_raise(rb_eNoMemError, "Failed to create ZSTD_CCtx");
+    }
+    run.nworkers = nctxs;
+
+    many_compress_state state = { &run, ctxs, nctxs, &opts };
+    rb_ensure(many_compress_body, (VALUE)&state, many_compress_cleanup, (VALUE)&state);
+
+    for (long i = 0; i < count; i++) {
+        rb_str_set_len(RARRAY_AREF(results, i), jobs[i].result);
+    }
+
+    ALLOCV_END(jobs_buf);
+    RB_GC_GUARD(sources);
+    RB_GC_GUARD(results);
+    return results;
+}
+
+// --- decompress_many ---------------------------------------------------------
+
+// A decompress_many entry: presized one-shot decode when the frame declares its
+// content size (frame.dst != NULL), otherwise the streaming loop into a
+// malloc'd buffer (stream.dst, freed by the cleanup). frame.ddict is the
+// dictionary a DictionaryRegistry picked for this entry; without one the
+// worker context's shared dictionary (NULL with a registry) applies.
+typedef struct {
+    decompress_batch_job frame;
+    decompress_stream_nogvl_args stream;
+} many_decompress_job;
+
+static int
+many_decompress_job_run(many_run* run, void* zctx, long index) {
+    many_decompress_job* job = &((many_decompress_job*)run->jobs)[index];
+    ZSTD_DCtx* zd = zctx;
+    if (job->frame.dst) {
+        if (job->frame.ddict) {
+            job->frame.result = ZSTD_decompress_usingDDict(zd, job->frame.dst, job->frame.dst_capacity,
+                                                           job->frame.src, job->frame.src_size, job->frame.ddict);
+        } else {
+            // ZSTD_decompressDCtx picks up the DDict referenced on the worker context
+            job->frame.result = ZSTD_decompressDCtx(zd, job->frame.dst, job->frame.dst_capacity,
+                                                    job->frame.src, job->frame.src_size);
+        }
+        return !ZSTD_isError(job->frame.result);
+    }
+    ZSTD_DCtx_reset(zd, ZSTD_reset_session_only);
+    // The stream decoder only uses a referenced DDict. With a registry the
+    // shared one is NULL, so dropping the entry's afterwards restores it.
+    if (job->frame.ddict) ZSTD_DCtx_refDDict(zd, job->frame.ddict);
+    job->stream.dctx = zd;
+    decompress_stream_without_gvl(&job->stream);
+    if (job->frame.ddict) ZSTD_DCtx_refDDict(zd, NULL);
+    return !(job->stream.error || job->stream.limit_exceeded || job->stream.truncated);
+}
+
+// State shared by decompress_many and the multi-frame decoder below. scratch
+// and the per-job stream buffers are C allocations released by the cleanup.
+typedef struct {
+    many_run* run;
+    ZSTD_DCtx** ctxs;
+    size_t nctxs;
+    const dctx_call_opts* opts;
+    int window_log_max;  // copied onto every worker (0 = zstd default)
+    VALUE results;       // decompress_many only
+    char* scratch;       // multi-frame decoder only: known-size frames when not decoding in place
+} many_decompress_state;
+
+// Configure every worker context (shared dictionary, window limit) and run
+// all jobs, raising for the lowest failing job. `what` names the job unit in
+// error messages ("index" or "frame").
+static void
+many_decompress_execute(many_decompress_state* state, const char* what) {
+    many_run* run = state->run;
+    many_decompress_job* jobs = run->jobs;
+
+    for (size_t i = 0; i < state->nctxs; i++) {
+        size_t rd = ZSTD_DCtx_refDDict(state->ctxs[i], state->opts->ddict);
+        if (ZSTD_isError(rd)) {
+            rb_raise(rb_eRuntimeError, "Failed to reference dictionary: %s", ZSTD_getErrorName(rd));
+        }
+        if (state->window_log_max) {
+            rd = ZSTD_DCtx_setParameter(state->ctxs[i], ZSTD_d_windowLogMax, state->window_log_max);
+            if (ZSTD_isError(rd)) {
+                rb_raise(rb_eRuntimeError, "Failed to set window_log_max: %s", ZSTD_getErrorName(rd));
+            }
+        }
+        run->workers[i].run = run;
+        run->workers[i].zctx = state->ctxs[i];
+    }
+
+    many_run_execute(run);
+
+    if (run->failed >= 0) {
+        many_decompress_job* job = &jobs[run->failed];
+        if (job->frame.dst) {
+            rb_raise(rb_eRuntimeError, "Decompression failed at %s %ld: %s",
+                     what, run->failed, ZSTD_getErrorName(job->frame.result));
+        }
+        if (job->stream.limit_exceeded) {
+            rb_raise(rb_eDecompressedSizeExceeded,
+                     "Decompressed output exceeds limit of %zu bytes (%s %ld)", job->stream.max_size, what, run->failed);
+        }
+        if (job->stream.truncated) {
+            rb_raise(rb_eRuntimeError, "Truncated frame at %s %ld: incomplete zstd data", what, run->failed);
+        }
+        rb_raise(rb_eRuntimeError, "Decompression failed at %s %ld: %s", what, run->failed, job->stream.error_name);
+    }
+}
+
+static VALUE
+many_decompress_body(VALUE p) {
+    many_decompress_state* state = (many_decompress_state*)p;
+    many_run* run = state->run;
+    many_decompress_job* jobs = run->jobs;
+
+    many_decompress_execute(state, "index");
+
+    for (long i = 0; i < run->count; i++) {
+        if (jobs[i].frame.dst) {
+            rb_str_set_len(RARRAY_AREF(state->results, i), jobs[i].frame.result);
+        } else {
+            rb_ary_store(state->results, i, rb_str_new(jobs[i].stream.dst, jobs[i].stream.dst_size));
+        }
+    }
+    return Qnil;
+}
+
+static VALUE
+many_decompress_cleanup(VALUE p) {
+    many_decompress_state* state = (many_decompress_state*)p;
+    many_decompress_job* jobs = state->run->jobs;
+    for (long i = 0; i < state->run->count; i++) {
+        if (jobs[i].stream.dst) {
+            vibe_zstd_free(jobs[i].stream.dst);
+            jobs[i].stream.dst = NULL;
+        }
+    }
+    if (state->scratch) {
+        vibe_zstd_free(state->scratch);
+        state->scratch = NULL;
+    }
+    many_release_dctxs(state->ctxs, state->nctxs);
+    many_run_destroy(state->run);
+    return Qnil;
+}
+
+// VibeZstd.decompress_many(array, threads: nil, dict: nil, initial_capacity: nil, max_decompressed_size: nil)
+//
+// Decompresses every frame in array in parallel on the native worker pool and
+// returns the results in input order. Frames are validated (dictionary ID,
+// declared size limit) up front; frames with a declared content size are
+// decoded straight into presized Strings, the rest through the streaming loop.
+static VALUE
+vibe_zstd_decompress_many(int argc, VALUE* argv, VALUE self) {
+    (void)self;
+    VALUE inputs, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &inputs, &options);
+    Check_Type(inputs, T_ARRAY);
+
+    // No instance here: resolve against the class defaults only
+    vibe_zstd_dctx defaults = { NULL, 0, 0 };
+    dctx_call_opts opts;
+    dctx_resolve_call_opts(&defaults, options, &opts);
+    VALUE threads_val = NIL_P(options) ? Qnil : rb_hash_aref(options, ID2SYM(rb_intern("threads")));
+
+    long count = RARRAY_LEN(inputs);
+    VALUE sources = rb_ary_new_capa(count);
+    VALUE results = rb_ary_new_capa(count);
+    VALUE jobs_buf;
+    many_decompress_job* jobs = ALLOCV_N(many_decompress_job, jobs_buf, count);
+    memset(jobs, 0, sizeof(many_decompress_job) * count);
+
+    for (long i = 0; i < count; i++) {
+        VALUE data = rb_ary_entry(inputs, i);
+        StringValue(data);
+        data = rb_str_new_frozen(data);
+        rb_ary_push(sources, data);
+
+        const char* src = RSTRING_PTR(data);
+        size_t srcSize = RSTRING_LEN(data);
+        unsigned long long contentSize;
+        dctx_call_opts entry;
+        dctx_entry_opts(&opts, &entry);
+        size_t offset = dctx_inspect_frames(src, srcSize, &entry, &contentSize);
+
+        jobs[i].frame.source = data;
+        jobs[i].frame.output = Qnil;
+        // A single dict: is shared through the worker contexts; only
+        // registry picks are per entry
+        jobs[i].frame.ddict_obj = entry.ddict_obj;
+        jobs[i].frame.ddict = NIL_P(opts.registry) ? NULL : entry.ddict;
+        jobs[i].frame.src_size = srcSize - offset;
+
+        if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+            jobs[i].stream.src_size = srcSize - offset;
+            jobs[i].stream.initial_capacity = opts.initial_capacity;
+            jobs[i].stream.max_size = opts.max_size;
+            rb_ary_push(results, Qnil);
+            continue;
+        }
+        if (opts.max_size && contentSize > (unsigned long long)opts.max_size) {
+            rb_raise(rb_eDecompressedSizeExceeded,
+                     "Declared content size %llu exceeds limit of %zu bytes (index %ld)",
+                     contentSize, opts.max_size, i);
+        }
+
+        VALUE result = rb_str_new(NULL, contentSize);
+        rb_ary_push(results, result);
+        jobs[i].frame.output = result;
+        jobs[i].frame.dst_capacity = contentSize;
+    }
+    // As in decompress_batch: take the buffer pointers once every String
+    // exists; the jobs buffer pins the Strings while the workers run
+    for (long i = 0; i < count; i++) {
+        decompress_batch_job* frame = &jobs[i].frame;
+        frame->src = RSTRING_END(frame->source) - frame->src_size;
+        if (NIL_P(frame->output)) {
+            jobs[i].stream.src = frame->src;
+        } else {
+            frame->dst = RSTRING_PTR(frame->output);
+        }
+    }
+    if (count == 0) return results;
+
+    size_t nworkers = many_thread_count(threads_val, count);
+    many_run run;
+    many_run_init(&run, nworkers);
+    run.run_job = many_decompress_job_run;
+    run.jobs = jobs;
+    run.count = count;
+
+    ZSTD_DCtx* ctxs[VIBE_ZSTD_MANY_MAX_THREADS];
+    many_worker workers[VIBE_ZSTD_MANY_MAX_THREADS];
+    run.workers = workers;
+    size_t nctxs = many_acquire_dctxs(ctxs, run.nworkers);
+    if (nctxs == 0) {
+        many_run_destroy(&run);
+        rb_raise(rb_eNoMemError, "Failed to create ZSTD_DCtx");
+    }
+    run.nworkers = nctxs;
+
+    many_decompress_state state = { &run, ctxs, nctxs, &opts, 0, results, NULL };
+    rb_ensure(many_decompress_body, (VALUE)&state, many_decompress_cleanup, (VALUE)&state);
+
+    ALLOCV_END(jobs_buf);
+    RB_GC_GUARD(sources);
+    RB_GC_GUARD(results);
+    RB_GC_GUARD(opts.ddict_obj);
+    return results;
+}
+
+// --- Multi-frame input ---------------------------------------------------------
+
+// Body for vibe_zstd_decompress_frames_parallel. When every frame declares its
+// size the workers decode straight into their slots of `in_place`; otherwise
+// known-size frames land in state->scratch, unknown-size frames in their own
+// stream buffers, and the pieces are joined here in frame order.
+typedef struct {
+    many_decompress_state* state;
+    VALUE in_place;     // result String when decoding in place, else Qnil
+    size_t known_size;  // total of the declared content sizes
+    VALUE io_buffer;    // IO::Buffer input to lock while decoding, else Qnil
+    int locked;
+} many_frames_args;
+
+static VALUE
+many_frames_body(VALUE p) {
+    many_frames_args* args = (many_frames_args*)p;
+    many_decompress_state* state = args->state;
+    many_decompress_job* jobs = state->run->jobs;
+    long count = state->run->count;
+
+    if (!NIL_P(args->io_buffer)) {
+        vibe_zstd_bytes_lock(args->io_buffer);
+        args->locked = 1;
+    }
+    many_decompress_execute(state, "frame");
+
+    if (!NIL_P(args->in_place)) {
+        return args->in_place;
+    }
+
+    size_t total = args->known_size;
+    for (long i = 0; i < count; i++) {
+        if (!jobs[i].frame.dst) total += jobs[i].stream.dst_size;
+    }
+    if (state->opts->max_size && total > state->opts->max_size) {
+        rb_raise(rb_eDecompressedSizeExceeded,
+                 "Decompressed output exceeds limit of %zu bytes", state->opts->max_size);
+    }
+    VALUE result = rb_str_buf_new(total);
+    for (long i = 0; i < count; i++) {
+        if (jobs[i].frame.dst) {
+            rb_str_cat(result, jobs[i].frame.dst, jobs[i].frame.result);
+        } else {
+            rb_str_cat(result, jobs[i].stream.dst, jobs[i].stream.dst_size);
+        }
+    }
+    return result;
+}
+
+static VALUE
+many_frames_cleanup(VALUE p) {
+    many_frames_args* args = (many_frames_args*)p;
+    if (args->locked) vibe_zstd_bytes_unlock(args->io_buffer);
+    return many_decompress_cleanup((VALUE)args->state);
+}
+
+// Decode the independent frames of data[offset..] concurrently on the native
+// worker pool and return them joined, in order, as one String.
+//
+// Frame boundaries come from ZSTD_findFrameCompressedSize; skippable frames
+// are dropped. Each frame with a declared content size is decoded directly
+// into its precomputed slot of the output. Every frame's dictionary ID is
+// checked against opts, and opts->max_size bounds the combined output.
+//
+// Returns Qnil, leaving the caller to decode serially, when the input cannot
+// be split (malformed or truncated framing), has fewer than min_frames
+// frames, or only one worker is available.
+static VALUE
+vibe_zstd_decompress_frames_parallel(VALUE data, size_t offset, const dctx_call_opts* opts,
+                                     int window_log_max, VALUE threads_val, long min_frames) {
+    // Validate threads: up front so bad values raise regardless of the input
+    many_thread_count(threads_val, VIBE_ZSTD_MANY_MAX_THREADS);
+
+    // Pin the input: the workers read it without the GVL. A String gets a
+    // frozen snapshot; an IO::Buffer cannot be snapshotted without a copy, so
+    // it is locked for the duration of the decode instead.
+    int io_buffer = vibe_zstd_io_buffer_p(data);
+    VALUE source = io_buffer ? data : rb_str_new_frozen(data);
+    const char* src;
+    size_t src_size;
+    vibe_zstd_input_bytes(source, &src, &src_size);
+    src += offset;
+    src_size -= offset;
+
+    // First pass: locate and count the compressed frames
+    long count = 0;
+    for (size_t pos = 0; pos < src_size;) {
+        size_t frame_size = ZSTD_findFrameCompressedSize(src + pos, src_size - pos);
+        if (ZSTD_isError(frame_size)) return Qnil;
+        if (!ZSTD_isSkippableFrame(src + pos, src_size - pos)) count++;
+        pos += frame_size;
+    }
+    if (count < min_frames || count < 1) return Qnil;
+
+    size_t nworkers = many_thread_count(threads_val, count);
+    if (nworkers < 2 && min_frames > 1) return Qnil;
+
+    VALUE jobs_buf;
+    many_decompress_job* jobs = ALLOCV_N(many_decompress_job, jobs_buf, count);
+    memset(jobs, 0, sizeof(many_decompress_job) * count);
+
+    // Second pass: fill in the jobs and total the declared sizes
+    size_t known_size = 0;
+    int all_known = 1;
+    long n = 0;
+    for (size_t pos = 0; pos < src_size;) {
+        const char* frame = src + pos;
+        size_t remaining = src_size - pos;
+        size_t frame_size = ZSTD_findFrameCompressedSize(frame, remaining);
+        pos += frame_size;
+        if (ZSTD_isSkippableFrame(frame, remaining)) continue;
+
+        dctx_check_frame_dict(ZSTD_getDictID_fromFrame(frame, remaining), opts);
+        many_decompress_job* job = &jobs[n++];
+        job->frame.src = frame;
+        job->frame.src_size = frame_size;
+
+        unsigned long long content_size = ZSTD_getFrameContentSize(frame, remaining);
+        if (content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR) {
+            all_known = 0;
+            job->stream.src = frame;
+            job->stream.src_size = frame_size;
+            job->stream.initial_capacity = opts->initial_capacity;
+            job->stream.max_size = opts->max_size;
+            continue;
+        }
+        if (content_size > (unsigned long long)(SIZE_MAX - known_size) ||
+            (opts->max_size && known_size + content_size > opts->max_size)) {
+            ALLOCV_END(jobs_buf);
+            rb_raise(rb_eDecompressedSizeExceeded,
+                     "Declared content size exceeds limit of %zu bytes",
+                     opts->max_size ? opts->max_size : SIZE_MAX);
+        }
+        // dst is assigned below once the output base is known; stash the
+        // declared size (and the job's slot offset in result) for now
+        job->frame.dst_capacity = (size_t)content_size;
+        job->frame.result = known_size;
+        known_size += (size_t)content_size;
+    }
+
+    // Known-size frames decode into their slots: in place in the result when
+    // every size is known, otherwise into one scratch buffer.
+    VALUE in_place = Qnil;
+    char* base;
+    char* scratch = NULL;
+    if (all_known) {
+        in_place = rb_str_new(NULL, known_size);
+        base = RSTRING_PTR(in_place);
+    } else {
+        scratch = vibe_zstd_malloc(known_size ? known_size : 1);
+        if (!scratch) {
+            ALLOCV_END(jobs_buf);
+            rb_raise(rb_eNoMemError, "Failed to allocate %zu bytes for decompression", known_size);
+        }
+        base = scratch;
+    }
+    for (long i = 0; i < count; i++) {
+        if (!jobs[i].stream.src) {
+            jobs[i].frame.dst = base + jobs[i].frame.result;
+            jobs[i].frame.result = 0;
+        }
+    }
+
+    many_run run;
+    many_run_init(&run, nworkers);
+    run.run_job = many_decompress_job_run;
+    run.jobs = jobs;
+    run.count = count;
+
+    ZSTD_DCtx* ctxs[VIBE_ZSTD_MANY_MAX_THREADS];
+    many_worker workers[VIBE_ZSTD_MANY_MAX_THREADS];
+    run.workers = workers;
+    size_t nctxs = many_acquire_dctxs(ctxs, run.nworkers);
+    if (nctxs == 0) {
+        many_run_destroy(&run);
+        vibe_zstd_free(scratch);
+        ALLOCV_END(jobs_buf);
+        rb_raise(rb_eNoMemError, "Failed to create ZSTD_DCtx");
+    }
+    run.nworkers = nctxs;
+
+    many_decompress_state state = { &run, ctxs, nctxs, opts, window_log_max, Qnil, scratch };
+    many_frames_args args = { &state, in_place, known_size, io_buffer ? data : Qnil, 0 };
+    VALUE result = rb_ensure(many_frames_body, (VALUE)&args, many_frames_cleanup, (VALUE)&args);
+
+    ALLOCV_END(jobs_buf);
+    RB_GC_GUARD(source);
+    return result;
+}
+
+// Module method initialization called from main Init_vibe_zstd
+void
+vibe_zstd_parallel_init_module_methods(VALUE rb_mVibeZstd) {
+    rb_define_module_function(rb_mVibeZstd, "compress_many", vibe_zstd_compress_many, -1);
+    rb_define_module_function(rb_mVibeZstd, "decompress_many", vibe_zstd_decompress_many, -1);
+}
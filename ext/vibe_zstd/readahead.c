@@ -0,0 +1,304 @@
+// Read-ahead decompression for DecompressReader
+//
+// DecompressReader.new(io, readahead: n) hands the ZSTD_DStream to a native
+// thread that decodes ahead of the caller into a ring of n output chunks, so
+// read / gets / each_line mostly copy already-decoded bytes while decoding
+// runs on another core. Only the Ruby thread can call io.read, so compressed
+// input travels the other way through a small ring of blocks that every read
+// tops up before serving output.
+//
+// Both rings have a single producer and a single consumer. Slots outside
+// [head, head + count) belong to the producer and slot head to the consumer,
+// so chunk contents are filled and copied without the lock; the lock only
+// guards the counts and flags, and one condition variable signals every
+// change in either direction.
+#include "vibe_zstd_internal.h"
+#include <pthread.h>
+#include <unistd.h>
+
+// Compressed blocks buffered ahead of the decoder. Each is one io.read of
+// ZSTD_DStreamInSize() bytes, and a block usually decodes into several
+// output chunks, so a few are enough to keep the thread busy.
+#define VIBE_ZSTD_READAHEAD_INPUT_BLOCKS 4
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t pos;  // Bytes already consumed (decoder for input, reader for output)
+    int frame_end;                  // Output: a data frame ends with this chunk
+    vibe_zstd_frame_tracker frame;  // Output: that frame, for on_frame:
+} readahead_chunk;
+
+struct vibe_zstd_readahead {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    pid_t pid;                   // The thread does not survive fork
+    ZSTD_DStream* dstream;       // Used only by the thread until it exits
+    vibe_zstd_frame_tracker frame;  // Thread: the frame being decoded
+    readahead_chunk in[VIBE_ZSTD_READAHEAD_INPUT_BLOCKS];
+    size_t in_head, in_count;
+    readahead_chunk* out;        // out_cap buffers of chunk_size bytes
+    size_t out_cap, out_head, out_count;
+    size_t chunk_size;
+    int input_done;              // Reader: io.read returned nil
+    int finished;                // Thread: input ran out, or error
+    size_t error;                // Thread: zstd error code
+    int stop;                    // Reader: shut the thread down
+    int interrupted;             // Reader: the waiting read must return to Ruby
+};
+
+// Decoder thread: decode the head input block into the next free output slot
+// until the input runs out after io EOF or an error occurs. A chunk is
+// published early when a data frame ends in it, so the reader can report the
+// boundary; a frame that decodes to nothing publishes an empty chunk.
+// ZSTD_decompressStream runs without the lock held.
+static void*
+readahead_thread(void* arg) {
+    vibe_zstd_readahead* ra = arg;
+    pthread_mutex_lock(&ra->lock);
+    for (;;) {
+        while (!ra->stop && (ra->in_count == 0 || ra->out_count == ra->out_cap)) {
+            if (ra->in_count == 0 && ra->input_done) {
+                ra->finished = 1;
+                break;
+            }
+            pthread_cond_wait(&ra->cond, &ra->lock);
+        }
+        if (ra->stop || ra->finished) break;
+
+        readahead_chunk* in = &ra->in[ra->in_head];
+        readahead_chunk* out = &ra->out[(ra->out_head + ra->out_count) % ra->out_cap];
+        pthread_mutex_unlock(&ra->lock);
+
+        ZSTD_inBuffer input = { in->data, in->len, in->pos };
+        ZSTD_outBuffer output = { out->data, ra->chunk_size, 0 };
+        size_t ret;
+        do {
+            ret = ZSTD_decompressStream(ra->dstream, &output, &input);
+        } while (!ZSTD_isError(ret) && ret != 0 &&
+                 output.pos < output.size && input.pos < input.size);
+        if (!ZSTD_isError(ret)) {
+            reader_frame_track(&ra->frame, in->data + in->pos, input.pos - in->pos, output.pos);
+        }
+        out->frame_end = (ret == 0) && reader_frame_end(&ra->frame, &out->frame);
+
+        pthread_mutex_lock(&ra->lock);
+        in->pos = input.pos;
+        if (in->pos >= in->len) {
+            vibe_zstd_free(in->data);
+            in->data = NULL;
+            ra->in_head = (ra->in_head + 1) % VIBE_ZSTD_READAHEAD_INPUT_BLOCKS;
+            ra->in_count--;
+        }
+        if (output.pos > 0 || out->frame_end) {
+            out->len = output.pos;
+            out->pos = 0;
+            ra->out_count++;
+        }
+        if (ZSTD_isError(ret)) {
+            ra->error = ret;
+            ra->finished = 1;
+        }
+        pthread_cond_broadcast(&ra->cond);
+    }
+    pthread_cond_broadcast(&ra->cond);
+    pthread_mutex_unlock(&ra->lock);
+    return NULL;
+}
+
+// Start the decoder thread for dstream with a ring of out_cap chunks
+static vibe_zstd_readahead*
+vibe_zstd_readahead_start(ZSTD_DStream* dstream, size_t out_cap, size_t chunk_size) {
+    vibe_zstd_readahead* ra = ZALLOC(vibe_zstd_readahead);
+    ra->dstream = dstream;
+    ra->pid = getpid();
+    ra->chunk_size = chunk_size;
+    ra->out_cap = out_cap;
+    ra->out = ZALLOC_N(readahead_chunk, out_cap);
+    for (size_t i = 0; i < out_cap; i++) {
+        ra->out[i].data = vibe_zstd_malloc(chunk_size);
+        if (!ra->out[i].data) {
+            for (size_t j = 0; j < i; j++) vibe_zstd_free(ra->out[j].data);
+            ruby_xfree(ra->out);
+            ruby_xfree(ra);
+            rb_raise(rb_eNoMemError, "Failed to allocate %zu readahead chunks", out_cap);
+        }
+    }
+    pthread_mutex_init(&ra->lock, NULL);
+    pthread_cond_init(&ra->cond, NULL);
+    int err = pthread_create(&ra->thread, NULL, readahead_thread, ra);
+    if (err) {
+        pthread_mutex_destroy(&ra->lock);
+        pthread_cond_destroy(&ra->cond);
+        for (size_t i = 0; i < out_cap; i++) vibe_zstd_free(ra->out[i].data);
+        ruby_xfree(ra->out);
+        ruby_xfree(ra);
+        rb_syserr_fail(err, "Failed to start readahead thread");
+    }
+    vibe_zstd_mem_flush();
+    return ra;
+}
+
+// Stop and join the thread, then release every buffer. Called from the
+// reader's dfree; the thread notices stop within one decode step.
+static void
+vibe_zstd_readahead_free(vibe_zstd_readahead* ra) {
+    if (ra->pid == getpid()) {
+        pthread_mutex_lock(&ra->lock);
+        ra->stop = 1;
+        pthread_cond_broadcast(&ra->cond);
+        pthread_mutex_unlock(&ra->lock);
+        pthread_join(ra->thread, NULL);
+        pthread_mutex_destroy(&ra->lock);
+        pthread_cond_destroy(&ra->cond);
+    }
+    for (size_t i = 0; i < VIBE_ZSTD_READAHEAD_INPUT_BLOCKS; i++) vibe_zstd_free(ra->in[i].data);
+    for (size_t i = 0; i < ra->out_cap; i++) vibe_zstd_free(ra->out[i].data);
+    ruby_xfree(ra->out);
+    ruby_xfree(ra);
+}
+
+// Top up the input ring from io with the GVL held. Only ever blocks in io.read.
+static void
+readahead_feed(VALUE io, vibe_zstd_readahead* ra) {
+    size_t in_size = ZSTD_DStreamInSize();
+    for (;;) {
+        pthread_mutex_lock(&ra->lock);
+        int room = !ra->input_done && !ra->finished && ra->in_count < VIBE_ZSTD_READAHEAD_INPUT_BLOCKS;
+        size_t slot = (ra->in_head + ra->in_count) % VIBE_ZSTD_READAHEAD_INPUT_BLOCKS;
+        pthread_mutex_unlock(&ra->lock);
+        if (!room) return;
+
+        VALUE chunk = rb_funcall(io, id_read, 1, SIZET2NUM(in_size));
+        if (!NIL_P(chunk)) StringValue(chunk);
+        if (NIL_P(chunk) || RSTRING_LEN(chunk) == 0) {
+            pthread_mutex_lock(&ra->lock);
+            ra->input_done = 1;
+            pthread_cond_broadcast(&ra->cond);
+            pthread_mutex_unlock(&ra->lock);
+            return;
+        }
+
+        // The free slot is ours until it is published by in_count++
+        size_t len = RSTRING_LEN(chunk);
+        char* data = vibe_zstd_malloc(len);
+        if (!data) rb_raise(rb_eNoMemError, "Failed to allocate readahead input");
+        memcpy(data, RSTRING_PTR(chunk), len);
+        ra->in[slot].data = data;
+        ra->in[slot].len = len;
+        ra->in[slot].pos = 0;
+
+        pthread_mutex_lock(&ra->lock);
+        ra->in_count++;
+        pthread_cond_broadcast(&ra->cond);
+        pthread_mutex_unlock(&ra->lock);
+    }
+}
+
+// Wait without the GVL until output is ready, the thread finished, or the
+// input ring has room for the reader to refill.
+static void*
+readahead_wait_without_gvl(void* arg) {
+    vibe_zstd_readahead* ra = arg;
+    pthread_mutex_lock(&ra->lock);
+    while (!ra->interrupted && ra->out_count == 0 && !ra->finished &&
+           (ra->input_done || ra->in_count == VIBE_ZSTD_READAHEAD_INPUT_BLOCKS)) {
+        pthread_cond_wait(&ra->cond, &ra->lock);
+    }
+    pthread_mutex_unlock(&ra->lock);
+    return NULL;
+}
+
+static void
+readahead_wait_ubf(void* arg) {
+    vibe_zstd_readahead* ra = arg;
+    pthread_mutex_lock(&ra->lock);
+    ra->interrupted = 1;
+    pthread_cond_broadcast(&ra->cond);
+    pthread_mutex_unlock(&ra->lock);
+}
+
+// Release the fully read head chunk back to the thread, reporting the frame
+// that ends with it
+static void
+readahead_pop(VALUE self, vibe_zstd_readahead* ra) {
+    readahead_chunk* out = &ra->out[ra->out_head];
+    int frame_end = out->frame_end;
+    vibe_zstd_frame_tracker frame = out->frame;
+
+    pthread_mutex_lock(&ra->lock);
+    ra->out_head = (ra->out_head + 1) % ra->out_cap;
+    ra->out_count--;
+    pthread_cond_broadcast(&ra->cond);
+    pthread_mutex_unlock(&ra->lock);
+
+    if (frame_end) reader_frame_notify(self, &frame);
+}
+
+// Readahead mode read: copy up to requested_size decoded bytes from the
+// output ring, feeding io input to the thread and waiting for it as needed.
+// Returns nil once the thread has finished and every chunk was returned.
+static VALUE
+reader_readahead_read(VALUE self, vibe_zstd_dstream* dstream, size_t requested_size) {
+    vibe_zstd_readahead* ra = dstream->readahead;
+    if (ra->pid != getpid()) {
+        rb_raise(rb_eRuntimeError, "DecompressReader readahead thread does not survive fork");
+    }
+
+    size_t default_out_size = ZSTD_DStreamOutSize();
+    size_t initial_alloc = (requested_size < default_out_size) ? requested_size : default_out_size;
+    VALUE result = rb_str_buf_new((long)initial_alloc);
+    size_t total_read = 0;
+
+    while (total_read < requested_size) {
+        readahead_feed(dstream->io, ra);
+
+        pthread_mutex_lock(&ra->lock);
+        size_t ready = ra->out_count;
+        int finished = ra->finished;
+        size_t error = ra->error;
+        pthread_mutex_unlock(&ra->lock);
+
+        if (ready > 0) {
+            // The head chunk is ours until it is popped
+            readahead_chunk* out = &ra->out[ra->out_head];
+            size_t n = out->len - out->pos;
+            if (n > requested_size - total_read) n = requested_size - total_read;
+            rb_str_cat(result, out->data + out->pos, n);
+            out->pos += n;
+            total_read += n;
+            if (out->pos == out->len) readahead_pop(self, ra);
+            continue;
+        }
+        if (error) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(error));
+        }
+        if (finished) {
+            dstream->eof = 1;
+            break;
+        }
+
+        // Only waits for the native thread, so a Fiber scheduler may run the
+        // wait elsewhere and keep serving other fibers
+        ra->interrupted = 0;
+        vibe_zstd_call_offload(readahead_wait_without_gvl, ra, readahead_wait_ubf, ra);
+        rb_thread_check_ints();
+    }
+
+    if (total_read == 0) {
+        dstream->eof = 1;
+        return Qnil;
+    }
+    // Report a frame that ended exactly here now rather than on the next read
+    pthread_mutex_lock(&ra->lock);
+    int boundary = ra->out_count > 0 && ra->out[ra->out_head].pos == ra->out[ra->out_head].len;
+    pthread_mutex_unlock(&ra->lock);
+    if (boundary) readahead_pop(self, ra);
+
+    // Report EOF as soon as nothing is left, like the serial reader
+    pthread_mutex_lock(&ra->lock);
+    if (ra->finished && !ra->error && ra->out_count == 0) dstream->eof = 1;
+    pthread_mutex_unlock(&ra->lock);
+    return result;
+}
@@ -0,0 +1,295 @@
+// Dictionary registry for VibeZstd
+//
+// A DictionaryRegistry holds many DDicts keyed by dict_id and is accepted as
+// dict: by DCtx#decompress (and VibeZstd.decompress, Pool#decompress) and by
+// DecompressReader. Every frame header carries the dict_id it was compressed
+// with, so decompression picks the matching dictionary itself: callers with
+// one dictionary per tenant or schema version no longer parse frames and look
+// dictionaries up before each call.
+//
+// Dictionaries can be grouped under a name (a tenant, a table). Adding a new
+// version under a name retires the previous ones: they still decode frames
+// written with them, and prune(idle:) drops retired versions once no frame has
+// needed them for a while, so old versions are kept only as long as data
+// referencing them still turns up. Current versions are never pruned.
+//
+// All access happens with the GVL held. Decompression resolves dictionaries
+// before releasing it, so prune, delete and add may drop an entry while a
+// decode that picked it is still running without the GVL. Only the registry
+// references a DDict it built from a String, so the decoders hold the DDict
+// object themselves (dctx_call_opts.ddict_obj, RB_GC_GUARDed across the decode)
+// and a DecompressReader retains the DDicts it was created with.
+#include "vibe_zstd_internal.h"
+#include <time.h>
+
+static double
+registry_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static vibe_zstd_dict_registry*
+registry_get(VALUE self) {
+    vibe_zstd_dict_registry* registry;
+    TypedData_Get_Struct(self, vibe_zstd_dict_registry, &vibe_zstd_dict_registry_type, registry);
+    return registry;
+}
+
+static vibe_zstd_dict_registry_entry*
+registry_entry(const vibe_zstd_dict_registry* registry, unsigned int dict_id) {
+    st_data_t value;
+    if (!st_lookup(registry->entries, (st_data_t)dict_id, &value)) return NULL;
+    return (vibe_zstd_dict_registry_entry*)value;
+}
+
+// Find the dictionary for a frame's dict_id, recording the use so prune(idle:)
+// keeps it. Returns NULL when none is registered.
+static vibe_zstd_dict_registry_entry*
+vibe_zstd_dict_registry_find(VALUE self, unsigned int dict_id) {
+    vibe_zstd_dict_registry_entry* entry = registry_entry(registry_get(self), dict_id);
+    if (entry) entry->last_used = registry_now();
+    return entry;
+}
+
+static int
+registry_collect_i(st_data_t key, st_data_t value, st_data_t arg) {
+    (void)key;
+    rb_ary_push((VALUE)arg, ((vibe_zstd_dict_registry_entry*)value)->ddict);
+    return ST_CONTINUE;
+}
+
+// All registered DDicts, in no particular order
+static VALUE
+registry_ddicts(const vibe_zstd_dict_registry* registry) {
+    VALUE ddicts = rb_ary_new_capa((long)registry->entries->num_entries);
+    st_foreach(registry->entries, registry_collect_i, (st_data_t)ddicts);
+    return ddicts;
+}
+
+// Reference every registered dictionary on dctx with ZSTD_d_refMultipleDDicts
+// so that a streaming decoder selects each frame's dictionary by itself. zstd
+// keeps raw pointers, so the returned Array of DDicts must be retained for as
+// long as dctx decodes.
+static VALUE
+vibe_zstd_dict_registry_ref_all(VALUE self, ZSTD_DCtx* dctx) {
+    VALUE ddicts = registry_ddicts(registry_get(self));
+    size_t result = ZSTD_DCtx_setParameter(dctx, ZSTD_d_refMultipleDDicts, ZSTD_rmd_refMultipleDDicts);
+    if (ZSTD_isError(result)) {
+        rb_raise(rb_eRuntimeError, "Failed to enable multiple dictionaries: %s", ZSTD_getErrorName(result));
+    }
+    for (long i = 0; i < RARRAY_LEN(ddicts); i++) {
+        vibe_zstd_ddict* ddict;
+        TypedData_Get_Struct(RARRAY_AREF(ddicts, i), vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict);
+        result = ZSTD_DCtx_refDDict(dctx, ddict->ddict);
+        if (ZSTD_isError(result)) {
+            rb_raise(rb_eRuntimeError, "Failed to set dictionary: %s", ZSTD_getErrorName(result));
+        }
+    }
+    vibe_zstd_mem_flush();
+    return rb_ary_freeze(ddicts);
+}
+
+// DictionaryRegistry.new(dicts = []) - Registry holding the given DDicts
+static VALUE
+vibe_zstd_dict_registry_initialize(int argc, VALUE* argv, VALUE self) {
+    VALUE dicts = Qnil;
+    rb_scan_args(argc, argv, "01", &dicts);
+    if (!NIL_P(dicts)) {
+        dicts = rb_Array(dicts);
+        for (long i = 0; i < RARRAY_LEN(dicts); i++) {
+            rb_funcall(self, rb_intern("add"), 1, RARRAY_AREF(dicts, i));
+        }
+    }
+    return self;
+}
+
+typedef struct {
+    VALUE name;
+    double now;
+} registry_retire_args;
+
+static int
+registry_retire_i(st_data_t key, st_data_t value, st_data_t arg) {
+    (void)key;
+    vibe_zstd_dict_registry_entry* entry = (vibe_zstd_dict_registry_entry*)value;
+    registry_retire_args* args = (registry_retire_args*)arg;
+    if (!entry->retired && rb_eql(entry->name, args->name)) {
+        entry->retired = 1;
+        entry->last_used = args->now;  // prune(idle:) counts from retirement
+    }
+    return ST_CONTINUE;
+}
+
+// DictionaryRegistry#add(dict, name: nil) - Register a DDict (or raw
+// dictionary bytes) under its dict_id and return the DDict
+//
+// With name:, the dictionary becomes the current version for that name and
+// earlier versions with the same name are retired. Adding a dict_id that is
+// already registered replaces that entry.
+static VALUE
+vibe_zstd_dict_registry_add(int argc, VALUE* argv, VALUE self) {
+    VALUE dict, options = Qnil;
+    rb_scan_args(argc, argv, "1:", &dict, &options);
+    VALUE name = NIL_P(options) ? Qnil : rb_hash_aref(options, ID2SYM(rb_intern("name")));
+    if (!rb_typeddata_is_kind_of(dict, &vibe_zstd_ddict_type)) {
+        dict = rb_class_new_instance(1, &dict, rb_cVibeZstdDDict);
+    }
+    vibe_zstd_ddict* ddict;
+    TypedData_Get_Struct(dict, vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict);
+    unsigned int dict_id = ZSTD_getDictID_fromDDict(ddict->ddict);
+    if (dict_id == 0) {
+        rb_raise(rb_eArgError, "Dictionary has no dict_id (raw content dictionaries cannot be selected by frame)");
+    }
+    if (!NIL_P(name)) {
+        name = rb_obj_freeze(rb_obj_dup(name));
+    }
+
+    vibe_zstd_dict_registry* registry = registry_get(self);
+    double now = registry_now();
+    if (!NIL_P(name)) {
+        registry_retire_args args = { name, now };
+        st_foreach(registry->entries, registry_retire_i, (st_data_t)&args);
+    }
+
+    vibe_zstd_dict_registry_entry* entry = registry_entry(registry, dict_id);
+    if (!entry) {
+        entry = ZALLOC(vibe_zstd_dict_registry_entry);
+        st_insert(registry->entries, (st_data_t)dict_id, (st_data_t)entry);
+    }
+    entry->ddict = dict;
+    entry->dict_id = dict_id;
+    entry->name = name;
+    entry->version = ++registry->last_version;
+    entry->retired = 0;
+    entry->last_used = now;
+    RB_OBJ_WRITTEN(self, Qundef, dict);
+    RB_OBJ_WRITTEN(self, Qundef, name);
+    return dict;
+}
+
+// DictionaryRegistry#[](dict_id) - The DDict registered for dict_id, or nil
+static VALUE
+vibe_zstd_dict_registry_aref(VALUE self, VALUE dict_id) {
+    vibe_zstd_dict_registry_entry* entry = registry_entry(registry_get(self), NUM2UINT(dict_id));
+    return entry ? entry->ddict : Qnil;
+}
+
+// DictionaryRegistry#delete(dict_id) - Remove a dictionary, returning its DDict or nil
+static VALUE
+vibe_zstd_dict_registry_delete(VALUE self, VALUE dict_id) {
+    vibe_zstd_dict_registry* registry = registry_get(self);
+    st_data_t key = (st_data_t)NUM2UINT(dict_id), value;
+    if (!st_delete(registry->entries, &key, &value)) return Qnil;
+    vibe_zstd_dict_registry_entry* entry = (vibe_zstd_dict_registry_entry*)value;
+    VALUE ddict = entry->ddict;
+    ruby_xfree(entry);
+    return ddict;
+}
+
+static int
+registry_ids_i(st_data_t key, st_data_t value, st_data_t arg) {
+    (void)value;
+    rb_ary_push((VALUE)arg, UINT2NUM((unsigned int)key));
+    return ST_CONTINUE;
+}
+
+// DictionaryRegistry#dict_ids - Registered dict_ids, sorted
+static VALUE
+vibe_zstd_dict_registry_dict_ids(VALUE self) {
+    vibe_zstd_dict_registry* registry = registry_get(self);
+    VALUE ids = rb_ary_new_capa((long)registry->entries->num_entries);
+    st_foreach(registry->entries, registry_ids_i, (st_data_t)ids);
+    return rb_ary_sort_bang(ids);
+}
+
+// DictionaryRegistry#size - Number of registered dictionaries
+static VALUE
+vibe_zstd_dict_registry_size(VALUE self) {
+    return SIZET2NUM(registry_get(self)->entries->num_entries);
+}
+
+typedef struct {
+    VALUE name;
+    vibe_zstd_dict_registry_entry* found;
+} registry_current_args;
+
+static int
+registry_current_i(st_data_t key, st_data_t value, st_data_t arg) {
+    (void)key;
+    vibe_zstd_dict_registry_entry* entry = (vibe_zstd_dict_registry_entry*)value;
+    registry_current_args* args = (registry_current_args*)arg;
+    if (!entry->retired && rb_eql(entry->name, args->name) &&
+        (!args->found || entry->version > args->found->version)) {
+        args->found = entry;
+    }
+    return ST_CONTINUE;
+}
+
+// DictionaryRegistry#current(name) - The current (most recently added)
+// dictionary for name, or nil
+static VALUE
+vibe_zstd_dict_registry_current(VALUE self, VALUE name) {
+    registry_current_args args = { name, NULL };
+    st_foreach(registry_get(self)->entries, registry_current_i, (st_data_t)&args);
+    return args.found ? args.found->ddict : Qnil;
+}
+
+// DictionaryRegistry#retired?(dict_id) - Whether a newer version replaced it
+static VALUE
+vibe_zstd_dict_registry_retired_p(VALUE self, VALUE dict_id) {
+    vibe_zstd_dict_registry_entry* entry = registry_entry(registry_get(self), NUM2UINT(dict_id));
+    return (entry && entry->retired) ? Qtrue : Qfalse;
+}
+
+typedef struct {
+    double cutoff;
+    VALUE removed;
+} registry_prune_args;
+
+static int
+registry_prune_i(st_data_t key, st_data_t value, st_data_t arg) {
+    vibe_zstd_dict_registry_entry* entry = (vibe_zstd_dict_registry_entry*)value;
+    registry_prune_args* args = (registry_prune_args*)arg;
+    if (entry->retired && entry->last_used <= args->cutoff) {
+        rb_ary_push(args->removed, UINT2NUM((unsigned int)key));
+        ruby_xfree(entry);
+        return ST_DELETE;
+    }
+    return ST_CONTINUE;
+}
+
+// DictionaryRegistry#prune(idle: 0) - Remove retired versions that no frame
+// has needed for at least idle seconds. Returns the removed dict_ids.
+static VALUE
+vibe_zstd_dict_registry_prune(int argc, VALUE* argv, VALUE self) {
+    VALUE options = Qnil;
+    rb_scan_args(argc, argv, ":", &options);
+    double idle = 0;
+    if (!NIL_P(options)) {
+        VALUE v_idle = rb_hash_aref(options, ID2SYM(rb_intern("idle")));
+        if (!NIL_P(v_idle)) {
+            idle = NUM2DBL(v_idle);
+            if (idle < 0) {
+                rb_raise(rb_eArgError, "idle must be non-negative");
+            }
+        }
+    }
+    registry_prune_args args = { registry_now() - idle, rb_ary_new() };
+    st_foreach(registry_get(self)->entries, registry_prune_i, (st_data_t)&args);
+    return rb_ary_sort_bang(args.removed);
+}
+
+void
+vibe_zstd_dict_registry_init_class(VALUE rb_cVibeZstdDictionaryRegistry) {
+    rb_define_alloc_func(rb_cVibeZstdDictionaryRegistry, vibe_zstd_dict_registry_alloc);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "initialize", vibe_zstd_dict_registry_initialize, -1);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "add", vibe_zstd_dict_registry_add, -1);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "[]", vibe_zstd_dict_registry_aref, 1);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "delete", vibe_zstd_dict_registry_delete, 1);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "dict_ids", vibe_zstd_dict_registry_dict_ids, 0);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "size", vibe_zstd_dict_registry_size, 0);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "current", vibe_zstd_dict_registry_current, 1);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "retired?", vibe_zstd_dict_registry_retired_p, 1);
+    rb_define_method(rb_cVibeZstdDictionaryRegistry, "prune", vibe_zstd_dict_registry_prune, -1);
+}
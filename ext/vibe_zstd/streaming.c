@@ -1,9 +1,22 @@
 // Streaming implementation for VibeZstd
+//
+// Under a Fiber scheduler (Falcon, async), io.write and io.read are plain
+// method calls, so a real IO waits through the scheduler's io_wait / io_read /
+// io_write hooks like any other Ruby code. Compression and decompression
+// steps of at least VIBE_ZSTD_OFFLOAD_MIN bytes go through
+// vibe_zstd_call_offload, which lets the scheduler run them on another thread
+// (Ruby 3.4+) while the thread's other fibers keep running.
 #include "vibe_zstd_internal.h"
 
+// Bytes of input to compress (or of output to decompress) from which a step
+// is offloaded under a Fiber scheduler; smaller steps finish faster than the
+// handoff to another thread
+#define VIBE_ZSTD_OFFLOAD_MIN (64 * 1024)
+
 // Cached method IDs for frequently called methods
 static ID id_write;
 static ID id_read;
+static ID id_call;
 
 // Forward declarations
 static VALUE vibe_zstd_writer_initialize(int argc, VALUE *argv, VALUE self);
@@ -13,13 +26,31 @@ static VALUE vibe_zstd_writer_finish(VALUE self);
 static VALUE vibe_zstd_reader_initialize(int argc, VALUE *argv, VALUE self);
 static VALUE vibe_zstd_reader_read(int argc, VALUE *argv, VALUE self);
 static VALUE vibe_zstd_reader_eof(VALUE self);
+static vibe_zstd_readahead* vibe_zstd_readahead_start(ZSTD_DStream* dstream, size_t out_cap, size_t chunk_size);
+static VALUE reader_readahead_read(VALUE self, vibe_zstd_dstream* dstream, size_t requested_size);
 
-// State struct for rb_ensure-based string lock/unlock in vibe_zstd_writer_write
+// State struct for the rb_ensure-wrapped compress loop shared by write, flush
+// and finish.  data is Qnil for flush/finish (no new input); src/src_size
+// are its bytes.  locked is set while an IO::Buffer data is locked.
 typedef struct {
     vibe_zstd_cstream* cstream;
     VALUE data;
+    const char* src;
+    size_t src_size;
+    int locked;
+    ZSTD_EndDirective mode;
+    const char* what;  // Error message prefix ("Compression", "Flush", "Finish")
 } vibe_zstd_write_state;
 
+// Arguments for running ZSTD_compressStream2 without the GVL
+typedef struct {
+    ZSTD_CCtx* cctx;
+    ZSTD_outBuffer* output;
+    ZSTD_inBuffer* input;
+    ZSTD_EndDirective mode;
+    size_t result;
+} writer_compress_args;
+
 // TypedData types - defined in vibe_zstd.c
 extern rb_data_type_t vibe_zstd_cstream_type;
 extern rb_data_type_t vibe_zstd_dstream_type;
@@ -43,40 +74,81 @@ vibe_zstd_writer_initialize(int argc, VALUE *argv, VALUE self) {
     RB_OBJ_WRITE(self, &cstream->io, io);
     rb_ivar_set(self, rb_intern("@io"), io);
 
-    // Parse options
-    int level = 3; // default compression level
+    // Parse options. level, dict and pledged_size are the writer's own; any
+    // other key is a CCtx parameter (workers:, window_log:, thread_pool:, ...),
+    // applied through CCtx.new so it is validated exactly like a one-shot
+    // context. cctx: copies the configuration of an existing CCtx instead.
+    VALUE level = Qnil;
     VALUE dict = Qnil;
+    VALUE cctx = Qnil;
+    VALUE async = Qnil;
     unsigned long long pledged_size = ZSTD_CONTENTSIZE_UNKNOWN;
 
     if (!NIL_P(options)) {
         Check_Type(options, T_HASH);
-        VALUE v_level = rb_hash_aref(options, ID2SYM(rb_intern("level")));
-        if (!NIL_P(v_level)) {
-            level = NUM2INT(v_level);
-        }
-        dict = rb_hash_aref(options, ID2SYM(rb_intern("dict")));
+        VALUE params = rb_hash_dup(options);
+        level = rb_hash_delete(params, ID2SYM(rb_intern("level")));
+        dict = rb_hash_delete(params, ID2SYM(rb_intern("dict")));
+        cctx = rb_hash_delete(params, ID2SYM(rb_intern("cctx")));
+        async = rb_hash_delete(params, ID2SYM(rb_intern("async")));
 
-        VALUE v_pledged = rb_hash_aref(options, ID2SYM(rb_intern("pledged_size")));
+        VALUE v_pledged = rb_hash_delete(params, ID2SYM(rb_intern("pledged_size")));
         if (!NIL_P(v_pledged)) {
             pledged_size = NUM2ULL(v_pledged);
         }
+
+        if (RHASH_SIZE(params) > 0) {
+            if (!NIL_P(cctx)) {
+                rb_raise(rb_eArgError, "pass either cctx: or CCtx parameters, not both");
+            }
+            cctx = rb_class_new_instance_kw(1, &params, rb_cVibeZstdCCtx, RB_PASS_KEYWORDS);
+        }
     }
 
     // Create compression context (CStream and CCtx are the same since v1.3.0)
-    cstream->cstream = ZSTD_createCStream();
+    cstream->cstream = ZSTD_createCStream_advanced(vibe_zstd_custom_mem);
     if (!cstream->cstream) {
         rb_raise(rb_eRuntimeError, "Failed to create compression stream");
     }
+    vibe_zstd_mem_flush();
 
-    // Reset context for streaming and set compression level
+    // Reset context for streaming
     size_t result = ZSTD_CCtx_reset((ZSTD_CCtx*)cstream->cstream, ZSTD_reset_session_only);
     if (ZSTD_isError(result)) {
         rb_raise(rb_eRuntimeError, "Failed to reset compression context: %s", ZSTD_getErrorName(result));
     }
 
-    result = ZSTD_CCtx_setParameter((ZSTD_CCtx*)cstream->cstream, ZSTD_c_compressionLevel, level);
-    if (ZSTD_isError(result)) {
-        rb_raise(rb_eRuntimeError, "Failed to set compression level: %s", ZSTD_getErrorName(result));
+    // Copy the context configuration (including workers, which makes
+    // write/flush hand blocks to worker threads, and a shared thread_pool)
+    // before the first write, which is when zstd starts the workers
+    if (!NIL_P(cctx)) {
+        vibe_zstd_cctx_configure_stream(self, (ZSTD_CCtx*)cstream->cstream, cctx, level, pledged_size);
+    }
+
+    // async: compress on a background thread. With nbWorkers >= 1,
+    // ZSTD_compressStream2 only copies input into zstd's round buffer and
+    // returns; a worker compresses each filled job section while the caller
+    // produces the next, and finished output is drained to io by later
+    // write/flush calls. One worker is enough for that pipeline; blocking
+    // happens only when every job buffer is still waiting to be compressed.
+    if (RTEST(async)) {
+        int workers = 0;
+        ZSTD_CCtx_getParameter((ZSTD_CCtx*)cstream->cstream, ZSTD_c_nbWorkers, &workers);
+        if (workers == 0) {
+            result = ZSTD_CCtx_setParameter((ZSTD_CCtx*)cstream->cstream, ZSTD_c_nbWorkers, 1);
+            if (ZSTD_isError(result)) {
+                rb_raise(rb_eRuntimeError, "Failed to enable async compression: %s", ZSTD_getErrorName(result));
+            }
+        }
+    }
+
+    // level: overrides the context's level (default 3). With a cctx it is
+    // applied by vibe_zstd_cctx_configure_stream, ahead of workers: :auto.
+    if (!NIL_P(level) && NIL_P(cctx)) {
+        result = ZSTD_CCtx_setParameter((ZSTD_CCtx*)cstream->cstream, ZSTD_c_compressionLevel, NUM2INT(level));
+        if (ZSTD_isError(result)) {
+            rb_raise(rb_eRuntimeError, "Failed to set compression level: %s", ZSTD_getErrorName(result));
+        }
     }
 
     // Set pledged source size if provided
@@ -103,30 +175,72 @@ vibe_zstd_writer_initialize(int argc, VALUE *argv, VALUE self) {
     // Allocate reusable output buffer (write barrier for WB_PROTECTED)
     RB_OBJ_WRITE(self, &cstream->output_buffer, rb_str_buf_new(ZSTD_CStreamOutSize()));
 
+    // Worker threads (started by the first write) belong to this process
+    int workers = 0;
+    ZSTD_CCtx_getParameter((ZSTD_CCtx*)cstream->cstream, ZSTD_c_nbWorkers, &workers);
+    if (workers > 0) cstream->pid = getpid();
+
     return self;
 }
 
-// Body of the rb_ensure wrapper: runs the compress loop with data locked
+// Fill the output buffer as far as possible without the GVL.  Returns once
+// the buffer is full, the input is consumed (ZSTD_e_continue), the directive
+// has completed (ZSTD_e_flush/ZSTD_e_end: result == 0) or an error occurs.
+// Batching several ZSTD_compressStream2 calls per GVL release means io.write
+// is only called with a full buffer, not once per internal block.
+static void*
+writer_compress_without_gvl(void* arg) {
+    writer_compress_args* args = (writer_compress_args*)arg;
+    do {
+        args->result = ZSTD_compressStream2(args->cctx, args->output, args->input, args->mode);
+        if (ZSTD_isError(args->result)) {
+            break;
+        }
+    } while (args->output->pos < args->output->size &&
+             (args->mode == ZSTD_e_continue ? args->input->pos < args->input->size
+                                            : args->result != 0));
+    return NULL;
+}
+
+// Whether the next compression step is worth offloading: remaining input
+// plus what zstd buffered from earlier writes (flush and finish compress
+// that) reaches VIBE_ZSTD_OFFLOAD_MIN. Writers with worker threads may wait
+// on their jobs for any length of time, so they always offload.
+static int
+writer_step_offload(vibe_zstd_cstream* cstream, size_t remaining) {
+    if (cstream->pid) {
+        return 1;
+    }
+    ZSTD_frameProgression progress = ZSTD_getFrameProgression(cstream->cstream);
+    return remaining + (size_t)(progress.ingested - progress.consumed) >= VIBE_ZSTD_OFFLOAD_MIN;
+}
+
+// Body of the rb_ensure wrapper: alternates between compressing without the
+// GVL and handing each filled output buffer to io.write with the GVL held.
 static VALUE
-vibe_zstd_writer_write_body(VALUE arg) {
+vibe_zstd_writer_run_body(VALUE arg) {
     vibe_zstd_write_state* state = (vibe_zstd_write_state*)arg;
     vibe_zstd_cstream* cstream = state->cstream;
-    VALUE data = state->data;
 
     // Input buffer: pos advances as ZSTD consumes data.
-    // data is locked (rb_str_locktmp) for the duration of this call so that
-    // RSTRING_PTR remains valid even when rb_funcall runs arbitrary Ruby code.
-    ZSTD_inBuffer input = {
-        .src = RSTRING_PTR(data),
-        .size = RSTRING_LEN(data),
-        .pos = 0
-    };
+    // data is a frozen snapshot (or a locked IO::Buffer), so src remains valid
+    // both while the GVL is released and while rb_funcall runs arbitrary Ruby
+    // code.
+    ZSTD_inBuffer input = { state->src, state->src_size, 0 };
+    if (state->mode == ZSTD_e_continue && input.size == 0) {
+        return Qnil;
+    }
 
     size_t outBufferSize = ZSTD_CStreamOutSize();
     VALUE outBuffer = cstream->output_buffer;
+    writer_compress_args args = {
+        .cctx = (ZSTD_CCtx*)cstream->cstream,
+        .input = &input,
+        .mode = state->mode,
+        .result = 0
+    };
 
-    // Process all input data in chunks
-    while (input.pos < input.size) {
+    do {
         // Unshare buffer if COW-shared by a prior IO#write receiver (Ruby 3.3+),
         // then restore capacity which may have shrunk during unsharing
         rb_str_modify(outBuffer);
@@ -137,129 +251,120 @@ vibe_zstd_writer_write_body(VALUE arg) {
             .size = outBufferSize,
             .pos = 0
         };
-
-        // ZSTD_e_continue: continue compression without flushing
-        // Return value is a hint for preferred input size (can be ignored)
-        size_t result = ZSTD_compressStream2((ZSTD_CCtx*)cstream->cstream, &output, &input, ZSTD_e_continue);
-        if (ZSTD_isError(result)) {
-            rb_raise(rb_eRuntimeError, "Compression failed: %s", ZSTD_getErrorName(result));
+        args.output = &output;
+
+        // The output buffer is locked too: an io.write receiver may have kept a
+        // reference to it, and other threads run Ruby code while we write into it
+        if (writer_step_offload(cstream, input.size - input.pos)) {
+            vibe_zstd_offload_with_str_locked(writer_compress_without_gvl, &args, outBuffer);
+        } else {
+            vibe_zstd_nogvl_with_str_locked(writer_compress_without_gvl, &args, outBuffer);
+        }
+        if (ZSTD_isError(args.result)) {
+            rb_raise(rb_eRuntimeError, "%s failed: %s", state->what, ZSTD_getErrorName(args.result));
         }
 
         // Write any compressed output that was produced
         if (output.pos > 0) {
             rb_str_set_len(outBuffer, output.pos);
-            // rb_funcall may run arbitrary Ruby code, but input.src stays valid
-            // because data is locked against mutation/reallocation
             rb_funcall(cstream->io, id_write, 1, outBuffer);
         }
-    }
+    } while (state->mode == ZSTD_e_continue ? input.pos < input.size : args.result != 0);
 
     return Qnil;
 }
 
-// Ensure function: always unlocks data regardless of raise/return
+// Ensure function: always releases the writer regardless of raise/return
 static VALUE
-vibe_zstd_writer_write_unlock(VALUE arg) {
-    rb_str_unlocktmp((VALUE)arg);
+vibe_zstd_writer_run_ensure(VALUE arg) {
+    vibe_zstd_write_state* state = (vibe_zstd_write_state*)arg;
+    state->cstream->busy = 0;
+    if (state->locked) vibe_zstd_bytes_unlock(state->data);
     return Qnil;
 }
 
-static VALUE
-vibe_zstd_writer_write(VALUE self, VALUE data) {
-    Check_Type(data, T_STRING);
-
+// Shared driver for write (ZSTD_e_continue), flush (ZSTD_e_flush) and
+// finish (ZSTD_e_end).
+//
+// Since the GVL is released while compressing, two threads could otherwise
+// drive the same ZSTD_CCtx at once (and io.write could re-enter the writer),
+// so the writer is marked busy for the duration and concurrent use raises.
+static void
+vibe_zstd_writer_run(VALUE self, VALUE data, ZSTD_EndDirective mode, const char* what) {
     vibe_zstd_cstream* cstream;
     TypedData_Get_Struct(self, vibe_zstd_cstream, &vibe_zstd_cstream_type, cstream);
 
-    // Lock data for the duration of the compress loop so that RSTRING_PTR(data)
-    // stays valid even when io.write (called inside the loop) runs Ruby code that
-    // could otherwise mutate or resize the string.  rb_str_locktmp raises if the
-    // string is already locked; the ensure always unlocks it.
-    rb_str_locktmp(data);
+    if (cstream->busy) {
+        rb_raise(rb_eRuntimeError, "CompressWriter is already in use by another write, flush or finish");
+    }
+    // A frame half-written by the parent's worker threads cannot be continued
+    if (cstream->pid && cstream->pid != getpid()) {
+        rb_raise(rb_eRuntimeError, "CompressWriter worker threads do not survive fork; create the writer after forking");
+    }
 
-    vibe_zstd_write_state state = { cstream, data };
-    rb_ensure(vibe_zstd_writer_write_body, (VALUE)&state,
-              vibe_zstd_writer_write_unlock, data);
+    // Pin data with a frozen snapshot so that RSTRING_PTR stays valid even when
+    // io.write (called inside the loop) or another thread mutates the caller's
+    // string.  This is a cheap copy-on-write share for heap strings and a no-op
+    // for frozen ones; unlike rb_str_locktmp it also lets several writers on
+    // different threads consume the same string at once.  An IO::Buffer is
+    // locked for the duration instead, which keeps it from being resized or
+    // freed without copying its contents.
+    vibe_zstd_write_state state = { cstream, data, NULL, 0, 0, mode, what };
+    if (!NIL_P(data)) {
+        int io_buffer = vibe_zstd_io_buffer_p(data);
+        if (!io_buffer) {
+            data = rb_str_new_frozen(data);
+            state.data = data;
+        }
+        vibe_zstd_input_bytes(data, &state.src, &state.src_size);
+        if (io_buffer) {
+            vibe_zstd_bytes_lock(data);
+            state.locked = 1;
+        }
+    }
+    cstream->busy = 1;
 
-    return self;
+    rb_ensure(vibe_zstd_writer_run_body, (VALUE)&state,
+              vibe_zstd_writer_run_ensure, (VALUE)&state);
+    RB_GC_GUARD(data);
 }
 
 static VALUE
-vibe_zstd_writer_flush(VALUE self) {
-    vibe_zstd_cstream* cstream;
-    TypedData_Get_Struct(self, vibe_zstd_cstream, &vibe_zstd_cstream_type, cstream);
-
-    size_t outBufferSize = ZSTD_CStreamOutSize();
-    VALUE outBuffer = cstream->output_buffer;
+vibe_zstd_writer_write(VALUE self, VALUE data) {
+    if (!vibe_zstd_io_buffer_p(data)) {
+        Check_Type(data, T_STRING);
+    }
 
-    ZSTD_inBuffer input = { NULL, 0, 0 };
-    size_t remaining;
+    // ZSTD_e_continue: continue compression without flushing
+    vibe_zstd_writer_run(self, data, ZSTD_e_continue, "Compression");
+    return self;
+}
 
+static VALUE
+vibe_zstd_writer_flush(VALUE self) {
     // ZSTD_e_flush: flush internal buffers, making all data readable
-    // Loop until remaining == 0 (flush complete)
-    do {
-        rb_str_modify(outBuffer);
-        rb_str_resize(outBuffer, (long)outBufferSize);
-        rb_str_set_len(outBuffer, 0);
-        ZSTD_outBuffer output = {
-            .dst = RSTRING_PTR(outBuffer),
-            .size = outBufferSize,
-            .pos = 0
-        };
-
-        // Return value > 0 means more flushing needed
-        remaining = ZSTD_compressStream2((ZSTD_CCtx*)cstream->cstream, &output, &input, ZSTD_e_flush);
-        if (ZSTD_isError(remaining)) {
-            rb_raise(rb_eRuntimeError, "Flush failed: %s", ZSTD_getErrorName(remaining));
-        }
-
-        if (output.pos > 0) {
-            rb_str_set_len(outBuffer, output.pos);
-            rb_funcall(cstream->io, id_write, 1, outBuffer);
-        }
-    } while (remaining > 0);
-
+    vibe_zstd_writer_run(self, Qnil, ZSTD_e_flush, "Flush");
     return self;
 }
 
 static VALUE
 vibe_zstd_writer_finish(VALUE self) {
-    vibe_zstd_cstream* cstream;
-    TypedData_Get_Struct(self, vibe_zstd_cstream, &vibe_zstd_cstream_type, cstream);
-
-    size_t outBufferSize = ZSTD_CStreamOutSize();
-    VALUE outBuffer = cstream->output_buffer;
-
-    ZSTD_inBuffer input = { NULL, 0, 0 };
-    size_t remaining;
-
     // ZSTD_e_end: finalize frame with checksum and epilogue
-    // Loop until remaining == 0 (frame complete)
-    do {
-        rb_str_modify(outBuffer);
-        rb_str_resize(outBuffer, (long)outBufferSize);
-        rb_str_set_len(outBuffer, 0);
-        ZSTD_outBuffer output = {
-            .dst = RSTRING_PTR(outBuffer),
-            .size = outBufferSize,
-            .pos = 0
-        };
-
-        // Return value > 0 means more epilogue data to write
-        remaining = ZSTD_compressStream2((ZSTD_CCtx*)cstream->cstream, &output, &input, ZSTD_e_end);
-        if (ZSTD_isError(remaining)) {
-            rb_raise(rb_eRuntimeError, "Finish failed: %s", ZSTD_getErrorName(remaining));
-        }
-
-        if (output.pos > 0) {
-            rb_str_set_len(outBuffer, output.pos);
-            rb_funcall(cstream->io, id_write, 1, outBuffer);
-        }
-    } while (remaining > 0);
-
+    vibe_zstd_writer_run(self, Qnil, ZSTD_e_end, "Finish");
     return self;
 }
 
+// CompressWriter#async? - Whether compression runs on worker threads, so
+// write returns once its input is buffered (async: true or workers > 0)
+static VALUE
+vibe_zstd_writer_async_p(VALUE self) {
+    vibe_zstd_cstream* cstream;
+    TypedData_Get_Struct(self, vibe_zstd_cstream, &vibe_zstd_cstream_type, cstream);
+    int workers = 0;
+    ZSTD_CCtx_getParameter((ZSTD_CCtx*)cstream->cstream, ZSTD_c_nbWorkers, &workers);
+    return workers > 0 ? Qtrue : Qfalse;
+}
+
 // DecompressReader implementation
 // Wraps ZSTD streaming decompression to read from a compressed IO object
 static VALUE
@@ -282,9 +387,32 @@ vibe_zstd_reader_initialize(int argc, VALUE *argv, VALUE self) {
     // Parse options
     VALUE dict = Qnil;
     size_t initial_chunk_size = 0;  // 0 = use default ZSTD_DStreamOutSize()
+    long threads = 0;               // 0 = serial streaming
+    long readahead = 0;             // 0 = decode on the calling thread
+    VALUE on_frame = Qnil;
     if (!NIL_P(options)) {
         Check_Type(options, T_HASH);
         dict = rb_hash_aref(options, ID2SYM(rb_intern("dict")));
+        on_frame = rb_hash_aref(options, ID2SYM(rb_intern("on_frame")));
+
+        VALUE v_threads = rb_hash_aref(options, ID2SYM(rb_intern("threads")));
+        if (!NIL_P(v_threads)) {
+            threads = NUM2LONG(v_threads);
+            if (threads < 1) {
+                rb_raise(rb_eArgError, "threads must be at least 1 (got %ld)", threads);
+            }
+        }
+
+        VALUE v_readahead = rb_hash_aref(options, ID2SYM(rb_intern("readahead")));
+        if (!NIL_P(v_readahead)) {
+            readahead = NUM2LONG(v_readahead);
+            if (readahead < 1) {
+                rb_raise(rb_eArgError, "readahead must be at least 1 (got %ld)", readahead);
+            }
+            if (threads > 1) {
+                rb_raise(rb_eArgError, "readahead cannot be combined with threads > 1");
+            }
+        }
 
         VALUE v_chunk_size = rb_hash_aref(options, ID2SYM(rb_intern("initial_chunk_size")));
         if (!NIL_P(v_chunk_size)) {
@@ -293,13 +421,26 @@ vibe_zstd_reader_initialize(int argc, VALUE *argv, VALUE self) {
                 rb_raise(rb_eArgError, "initial_chunk_size must be greater than 0");
             }
         }
+
+        // Parallel mode decodes whole groups of frames at once and only sees
+        // the group's combined output, so it has no per-frame sizes to report
+        if (!NIL_P(on_frame)) {
+            if (!rb_respond_to(on_frame, id_call)) {
+                rb_raise(rb_eTypeError, "on_frame must respond to call");
+            }
+            if (threads > 1) {
+                rb_raise(rb_eArgError, "on_frame cannot be combined with threads > 1");
+            }
+        }
     }
+    rb_ivar_set(self, rb_intern("@on_frame"), on_frame);
 
     // Create decompression context (DStream and DCtx are the same since v1.3.0)
-    dstream->dstream = ZSTD_createDStream();
+    dstream->dstream = ZSTD_createDStream_advanced(vibe_zstd_custom_mem);
     if (!dstream->dstream) {
         rb_raise(rb_eRuntimeError, "Failed to create decompression stream");
     }
+    vibe_zstd_mem_flush();
 
     // Reset context for streaming
     size_t result = ZSTD_DCtx_reset((ZSTD_DCtx*)dstream->dstream, ZSTD_reset_session_only);
@@ -307,8 +448,15 @@ vibe_zstd_reader_initialize(int argc, VALUE *argv, VALUE self) {
         rb_raise(rb_eRuntimeError, "Failed to reset decompression context: %s", ZSTD_getErrorName(result));
     }
 
-    // Set dictionary if provided
-    if (!NIL_P(dict)) {
+    // A DictionaryRegistry: reference every dictionary it holds now and let
+    // zstd pick each frame's by dict_id. The snapshot is retained in @dict, so
+    // later changes to the registry do not affect this reader.
+    if (rb_typeddata_is_kind_of(dict, &vibe_zstd_dict_registry_type)) {
+        if (threads > 1) {
+            rb_raise(rb_eArgError, "a DictionaryRegistry cannot be combined with threads > 1");
+        }
+        rb_ivar_set(self, rb_intern("@dict"), vibe_zstd_dict_registry_ref_all(dict, (ZSTD_DCtx*)dstream->dstream));
+    } else if (!NIL_P(dict)) {
         vibe_zstd_ddict* ddict_obj;
         TypedData_Get_Struct(dict, vibe_zstd_ddict, &vibe_zstd_ddict_type, ddict_obj);
         result = ZSTD_DCtx_refDDict((ZSTD_DCtx*)dstream->dstream, ddict_obj->ddict);
@@ -318,7 +466,17 @@ vibe_zstd_reader_initialize(int argc, VALUE *argv, VALUE self) {
         // Retain the DDict object so GC won't free it while the stream holds a raw
         // pointer to its internal ZSTD_DDict (ZSTD_DCtx_refDDict stores no Ruby ref)
         rb_ivar_set(self, rb_intern("@dict"), dict);
+        dstream->ddict = ddict_obj->ddict;
+    }
+
+    // Parallel mode buffers compressed input until whole frames are available
+    dstream->threads = (size_t)threads;
+    if (threads > 1) {
+        RB_OBJ_WRITE(self, &dstream->pending, rb_str_buf_new(0));
+        RB_OBJ_WRITE(self, &dstream->decoded, rb_str_new(NULL, 0));
     }
+    dstream->decoded_pos = 0;
+    dstream->io_eof = 0;
 
     // Initialize input buffer management
     RB_OBJ_WRITE(self, &dstream->input_data, rb_str_new(NULL, 0));
@@ -328,9 +486,304 @@ vibe_zstd_reader_initialize(int argc, VALUE *argv, VALUE self) {
     dstream->eof = 0;
     dstream->initial_chunk_size = initial_chunk_size;
 
+    // Readahead mode: from here on the decoder thread owns the stream
+    if (readahead > 0) {
+        size_t chunk_size = (initial_chunk_size > 0) ? initial_chunk_size : ZSTD_DStreamOutSize();
+        dstream->readahead = vibe_zstd_readahead_start(dstream->dstream, (size_t)readahead, chunk_size);
+    }
+
     return self;
 }
 
+// Arguments for running ZSTD_decompressStream without the GVL
+typedef struct {
+    ZSTD_DStream* dstream;
+    ZSTD_outBuffer* output;
+    ZSTD_inBuffer* input;
+    size_t result;
+    volatile int interrupted;
+} reader_decompress_args;
+
+// Decompress the currently buffered input without the GVL.  Returns once the
+// output space is full, the buffered input is consumed, the frame ends
+// (result == 0), an error occurs, or the thread is interrupted.
+static void*
+reader_decompress_without_gvl(void* arg) {
+    reader_decompress_args* args = (reader_decompress_args*)arg;
+    do {
+        args->result = ZSTD_decompressStream(args->dstream, args->output, args->input);
+        if (ZSTD_isError(args->result) || args->result == 0) {
+            break;
+        }
+    } while (!args->interrupted &&
+             args->output->pos < args->output->size &&
+             args->input->pos < args->input->size);
+    return NULL;
+}
+
+// Unblocking function: stop at the next ZSTD_decompressStream boundary so
+// Thread#raise / Ctrl-C are delivered; the read loop simply resumes otherwise
+static void
+reader_decompress_ubf(void* arg) {
+    reader_decompress_args* args = (reader_decompress_args*)arg;
+    args->interrupted = 1;
+}
+
+// State struct for the rb_ensure-wrapped read loop
+typedef struct {
+    VALUE self;
+    vibe_zstd_dstream* dstream;
+    size_t requested_size;
+} vibe_zstd_read_state;
+
+// Record one decode step of the current frame: consumed is the compressed
+// input it used (the frame's first bytes are kept to recognize skippable
+// frames) and produced is how much it decoded.
+static void
+reader_frame_track(vibe_zstd_frame_tracker* frame, const char* consumed, size_t consumed_len, size_t produced) {
+    while (frame->magic_len < sizeof(frame->magic) && consumed_len > 0) {
+        frame->magic[frame->magic_len++] = *consumed++;
+        consumed_len--;
+    }
+    frame->size += produced;
+}
+
+// Close the current frame once ZSTD_decompressStream returns 0. Returns 1 and
+// copies the frame to *ended when it was a data frame; skippable frames are
+// dropped silently.
+static int
+reader_frame_end(vibe_zstd_frame_tracker* frame, vibe_zstd_frame_tracker* ended) {
+    int data_frame = !ZSTD_isSkippableFrame(frame->magic, frame->magic_len);
+    *ended = *frame;
+    frame->magic_len = 0;
+    frame->size = 0;
+    if (data_frame) frame->index++;
+    return data_frame;
+}
+
+// Call the reader's on_frame: callback, if any, with (index, size)
+static void
+reader_frame_notify(VALUE self, const vibe_zstd_frame_tracker* ended) {
+    VALUE on_frame = rb_attr_get(self, rb_intern("@on_frame"));
+    if (!NIL_P(on_frame)) {
+        rb_funcall(on_frame, id_call, 2, ULL2NUM(ended->index), ULL2NUM(ended->size));
+    }
+}
+
+// Parallel mode tuning: bytes requested per io.read, how many complete
+// frames per thread to gather before decoding a group, and how much
+// compressed input per thread may be buffered before giving up on a group
+#define VIBE_ZSTD_PARALLEL_READ_CHUNK (1 << 20)
+#define VIBE_ZSTD_PARALLEL_FRAMES_PER_THREAD 2
+#define VIBE_ZSTD_PARALLEL_PENDING_PER_THREAD (8 << 20)
+
+// Replace the buffered input with its unscanned tail
+static void
+reader_parallel_take(VALUE self, vibe_zstd_dstream* dstream, const char* rest, size_t rest_len) {
+    RB_OBJ_WRITE(self, &dstream->pending, rb_str_new(rest, rest_len));
+    dstream->scanned = 0;
+    dstream->scanned_frames = 0;
+}
+
+// Parallel mode fallback: decode the frame at the front of the buffered input
+// through the reader's own DStream, a read chunk of output at a time, so a
+// frame too large to buffer whole streams like the serial reader. Input past
+// the end of the frame goes back to pending and parallel decoding resumes.
+static int
+reader_parallel_stream(VALUE self, vibe_zstd_dstream* dstream) {
+    if (!dstream->streaming) {
+        // pending is private to the reader, so it can be consumed in place
+        RB_OBJ_WRITE(self, &dstream->input_data, dstream->pending);
+        dstream->input.src = RSTRING_PTR(dstream->input_data);
+        dstream->input.size = RSTRING_LEN(dstream->input_data);
+        dstream->input.pos = 0;
+        reader_parallel_take(self, dstream, NULL, 0);
+        dstream->streaming = 1;
+    }
+
+    VALUE out = rb_str_buf_new(VIBE_ZSTD_PARALLEL_READ_CHUNK);
+    ZSTD_outBuffer output = { RSTRING_PTR(out), VIBE_ZSTD_PARALLEL_READ_CHUNK, 0 };
+    for (;;) {
+        // Called even without new input: a full output may have left
+        // decoded data inside the DStream
+        reader_decompress_args args = {
+            .dstream = dstream->dstream,
+            .output = &output,
+            .input = &dstream->input,
+            .result = 0,
+            .interrupted = 0
+        };
+        if (output.size - output.pos >= VIBE_ZSTD_OFFLOAD_MIN) {
+            vibe_zstd_call_offload(reader_decompress_without_gvl, &args,
+                                   reader_decompress_ubf, &args);
+        } else {
+            vibe_zstd_call_without_gvl(reader_decompress_without_gvl, &args,
+                                       reader_decompress_ubf, &args);
+        }
+        if (ZSTD_isError(args.result)) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(args.result));
+        }
+        if (args.result == 0) {
+            reader_parallel_take(self, dstream, (const char*)dstream->input.src + dstream->input.pos,
+                                 dstream->input.size - dstream->input.pos);
+            RB_OBJ_WRITE(self, &dstream->input_data, rb_str_new(NULL, 0));
+            dstream->input.src = NULL;
+            dstream->input.size = 0;
+            dstream->input.pos = 0;
+            dstream->streaming = 0;
+            break;
+        }
+        if (output.pos == output.size) break;
+        if (dstream->input.pos < dstream->input.size) continue;  // interrupted
+
+        if (dstream->io_eof) {
+            rb_raise(rb_eRuntimeError, "Truncated frame: incomplete zstd data");
+        }
+        VALUE chunk = rb_funcall(dstream->io, id_read, 1, SIZET2NUM(VIBE_ZSTD_PARALLEL_READ_CHUNK));
+        if (NIL_P(chunk)) {
+            dstream->io_eof = 1;
+            continue;
+        }
+        StringValue(chunk);
+        // Frozen copy, as in the serial reader: the GVL is released while
+        // zstd reads from it
+        VALUE frozen_chunk = rb_str_new_frozen(chunk);
+        RB_OBJ_WRITE(self, &dstream->input_data, frozen_chunk);
+        dstream->input.src = RSTRING_PTR(frozen_chunk);
+        dstream->input.size = RSTRING_LEN(frozen_chunk);
+        dstream->input.pos = 0;
+    }
+
+    rb_str_set_len(out, output.pos);
+    RB_OBJ_WRITE(self, &dstream->decoded, out);
+    dstream->decoded_pos = 0;
+    return 1;
+}
+
+// Parallel mode: decode the next group of complete frames from the buffered
+// input into dstream->decoded. Reads more input from io until enough frames
+// are complete (or io is exhausted). Returns 0 when no input remains.
+//
+// Frames in a group are decoded whole, so each is buffered once compressed
+// and once decompressed. The scan for frame boundaries resumes where the
+// previous read left it. A group that would hold a single frame, and a frame
+// still incomplete once the per-thread input cap is buffered, are streamed
+// through reader_parallel_stream instead, which keeps a single-frame file in
+// bounded memory.
+static int
+reader_parallel_refill(VALUE self, vibe_zstd_dstream* dstream) {
+    size_t want_frames = dstream->threads * VIBE_ZSTD_PARALLEL_FRAMES_PER_THREAD;
+    size_t max_pending = dstream->threads * VIBE_ZSTD_PARALLEL_PENDING_PER_THREAD;
+
+    if (dstream->streaming) return reader_parallel_stream(self, dstream);
+
+    for (;;) {
+        const char* buf = RSTRING_PTR(dstream->pending);
+        size_t len = RSTRING_LEN(dstream->pending);
+        size_t corrupt = 0;  // error other than srcSize_wrong for the frame after scanned
+        while (dstream->scanned < len) {
+            const char* frame = buf + dstream->scanned;
+            size_t frame_size = ZSTD_findFrameCompressedSize(frame, len - dstream->scanned);
+            if (ZSTD_isError(frame_size)) {
+                // Only srcSize_wrong means the frame is still arriving; bad
+                // magic or a corrupt header will not improve with more input
+                if (ZSTD_getErrorCode(frame_size) != ZSTD_error_srcSize_wrong) corrupt = frame_size;
+                break;
+            }
+            if (!ZSTD_isSkippableFrame(frame, len - dstream->scanned)) dstream->scanned_frames++;
+            dstream->scanned += frame_size;
+        }
+        size_t complete = dstream->scanned;
+        size_t frames = dstream->scanned_frames;
+        // Frames ahead of the corrupt one are still served, like the serial
+        // reader does; the error is raised once it reaches the front
+        if (corrupt && complete == 0) {
+            rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(corrupt));
+        }
+
+        int full = len >= max_pending;
+        if (complete == 0 && full) {
+            return reader_parallel_stream(self, dstream);
+        }
+        if (complete > 0 && (frames >= want_frames || dstream->io_eof || corrupt || full)) {
+            if (frames == 1) return reader_parallel_stream(self, dstream);
+
+            VALUE group = rb_str_new(buf, complete);
+            reader_parallel_take(self, dstream, buf + complete, len - complete);
+
+            if (frames == 0) continue;  // only skippable frames
+
+            dctx_call_opts opts = {
+                .ddict = dstream->ddict,
+                .dict_id = dstream->ddict ? ZSTD_getDictID_fromDDict(dstream->ddict) : 0,
+                .initial_capacity = ZSTD_DStreamOutSize(),
+                .max_size = 0
+            };
+            VALUE decoded = vibe_zstd_decompress_frames_parallel(group, 0, &opts, 0,
+                                                                 SIZET2NUM(dstream->threads), 1);
+            if (NIL_P(decoded)) {
+                rb_raise(rb_eRuntimeError, "Decompression failed: invalid frame");
+            }
+            RB_OBJ_WRITE(self, &dstream->decoded, decoded);
+            dstream->decoded_pos = 0;
+            return 1;
+        }
+
+        if (dstream->io_eof) {
+            if (len > 0) {
+                rb_raise(rb_eRuntimeError, "Truncated frame: incomplete zstd data");
+            }
+            return 0;
+        }
+
+        VALUE chunk = rb_funcall(dstream->io, id_read, 1, SIZET2NUM(VIBE_ZSTD_PARALLEL_READ_CHUNK));
+        if (NIL_P(chunk)) {
+            dstream->io_eof = 1;
+            continue;
+        }
+        StringValue(chunk);
+        rb_str_cat(dstream->pending, RSTRING_PTR(chunk), RSTRING_LEN(chunk));
+    }
+}
+
+// Parallel mode read: serve from the decoded buffer, refilling a group of
+// frames at a time.
+static VALUE
+reader_parallel_read(VALUE self, vibe_zstd_dstream* dstream, size_t requested_size) {
+    size_t default_out_size = ZSTD_DStreamOutSize();
+    size_t initial_alloc = (requested_size < default_out_size) ? requested_size : default_out_size;
+    VALUE result = rb_str_buf_new((long)initial_alloc);
+    size_t total_read = 0;
+
+    while (total_read < requested_size) {
+        size_t available = RSTRING_LEN(dstream->decoded) - dstream->decoded_pos;
+        if (available == 0) {
+            if (!reader_parallel_refill(self, dstream)) break;
+            continue;
+        }
+        size_t n = requested_size - total_read;
+        if (n > available) n = available;
+        rb_str_cat(result, RSTRING_PTR(dstream->decoded) + dstream->decoded_pos, n);
+        dstream->decoded_pos += n;
+        total_read += n;
+    }
+
+    // Drop the decoded group once consumed so it can be collected
+    if (dstream->decoded_pos >= (size_t)RSTRING_LEN(dstream->decoded)) {
+        RB_OBJ_WRITE(self, &dstream->decoded, rb_str_new(NULL, 0));
+        dstream->decoded_pos = 0;
+        if (dstream->io_eof && !dstream->streaming && RSTRING_LEN(dstream->pending) == 0) {
+            dstream->eof = 1;
+        }
+    }
+
+    if (total_read == 0) {
+        dstream->eof = 1;
+        return Qnil;
+    }
+    return result;
+}
+
 // DecompressReader read - Read decompressed data from stream
 //
 // Handles streaming decompression with buffered input management:
@@ -339,14 +792,20 @@ vibe_zstd_reader_initialize(int argc, VALUE *argv, VALUE self) {
 //
 // Buffer management:
 // - Maintains internal compressed input buffer that refills from IO as needed
-// - Calls ZSTD_decompressStream incrementally to produce output
+// - Decompresses the buffered input without the GVL; the GVL is only held to
+//   call io.read for more input and to grow the result string
 // - Tracks EOF state based on IO exhaustion and frame completion
 // - Input chunks are stored as frozen copies so that IOs which mutate/reuse
 //   the returned string cannot invalidate dstream->input.src between calls
 //
 // EOF handling:
 // - Returns nil when no more data available
-// - Sets eof flag when: IO returns nil, frame complete (ret==0), or no progress made
+// - Sets eof flag when: IO returns nil or no progress made
+//
+// Frames:
+// - Concatenated frames are decoded in sequence and skippable frames skipped,
+//   so appended or multi-frame (e.g. seekable) files read back as one stream
+// - on_frame: is called with (index, decompressed_size) as each data frame ends
 // - read(0) always returns "" immediately without touching stream state
 //
 // Allocation strategy:
@@ -357,28 +816,20 @@ vibe_zstd_reader_initialize(int argc, VALUE *argv, VALUE self) {
 // This implements proper streaming semantics for incremental decompression
 // of arbitrarily large files without loading everything into memory.
 static VALUE
-vibe_zstd_reader_read(int argc, VALUE *argv, VALUE self) {
-    VALUE size_arg;
-    rb_scan_args(argc, argv, "01", &size_arg);
-
-    vibe_zstd_dstream* dstream;
-    TypedData_Get_Struct(self, vibe_zstd_dstream, &vibe_zstd_dstream_type, dstream);
+vibe_zstd_reader_read_body(VALUE arg) {
+    vibe_zstd_read_state* state = (vibe_zstd_read_state*)arg;
+    VALUE self = state->self;
+    vibe_zstd_dstream* dstream = state->dstream;
+    size_t requested_size = state->requested_size;
+    size_t inBufferSize = ZSTD_DStreamInSize();
 
-    // read(0): per IO semantics, always return "" without touching stream state
-    if (!NIL_P(size_arg) && NUM2SIZET(size_arg) == 0) {
-        return rb_str_new(NULL, 0);
+    if (dstream->threads > 1) {
+        return reader_parallel_read(self, dstream, requested_size);
     }
-
-    if (dstream->eof) {
-        return Qnil;
+    if (dstream->readahead) {
+        return reader_readahead_read(self, dstream, requested_size);
     }
 
-    // Unbounded reads use configurable chunk size (defaults to ZSTD_DStreamOutSize() ~128KB)
-    // This provides chunked streaming behavior for true streaming use cases
-    size_t default_chunk_size = (dstream->initial_chunk_size > 0) ? dstream->initial_chunk_size : ZSTD_DStreamOutSize();
-    size_t requested_size = NIL_P(size_arg) ? default_chunk_size : NUM2SIZET(size_arg);
-    size_t inBufferSize = ZSTD_DStreamInSize();
-
     // Cap the initial allocation to avoid multi-gigabyte pre-allocations when
     // the caller passes a huge size argument for a small stream.  The buffer
     // grows geometrically below as output accumulates.
@@ -407,9 +858,9 @@ vibe_zstd_reader_read(int argc, VALUE *argv, VALUE self) {
 
             // Store a private frozen copy so that an IO that reuses/mutates its
             // returned buffer string cannot invalidate dstream->input.src between
-            // successive read() calls.  rb_str_new_frozen is cheap (copy-on-write
-            // snapshot) when the string is already frozen, and allocates a
-            // separate copy otherwise.
+            // successive read() calls, nor while the GVL is released below.
+            // rb_str_new_frozen is cheap (copy-on-write snapshot) when the string
+            // is already frozen, and allocates a separate copy otherwise.
             VALUE frozen_chunk = rb_str_new_frozen(chunk);
 
             // Reset input buffer with new data (write barrier for WB_PROTECTED)
@@ -447,26 +898,49 @@ vibe_zstd_reader_read(int argc, VALUE *argv, VALUE self) {
             .pos = 0
         };
 
-        // ZSTD_decompressStream advances input.pos and output.pos
+        // ZSTD_decompressStream advances input.pos and output.pos.  result is
+        // private to this call (not yet visible to Ruby) and input_data is a
+        // frozen snapshot, so both stay valid while the GVL is released.
         // Return value: 0 = frame complete, >0 = hint for next input size, error if < 0
-        size_t ret = ZSTD_decompressStream(dstream->dstream, &output, &dstream->input);
+        reader_decompress_args args = {
+            .dstream = dstream->dstream,
+            .output = &output,
+            .input = &dstream->input,
+            .result = 0,
+            .interrupted = 0
+        };
+        size_t in_start = dstream->input.pos;
+        if (space_left >= VIBE_ZSTD_OFFLOAD_MIN) {
+            vibe_zstd_call_offload(reader_decompress_without_gvl, &args,
+                                   reader_decompress_ubf, &args);
+        } else {
+            vibe_zstd_call_without_gvl(reader_decompress_without_gvl, &args,
+                                       reader_decompress_ubf, &args);
+        }
+        size_t ret = args.result;
         if (ZSTD_isError(ret)) {
             rb_raise(rb_eRuntimeError, "Decompression failed: %s", ZSTD_getErrorName(ret));
         }
+        reader_frame_track(&dstream->frame, (const char*)dstream->input.src + in_start,
+                           dstream->input.pos - in_start, output.pos);
 
         if (output.pos > 0) {
             total_read += output.pos;
             made_progress = 1;
         }
 
-        // Exit when we've read enough data
-        if (total_read >= requested_size) {
-            break;
+        // ret == 0 signals the end of a frame. zstd stops there, and the next
+        // call starts on the following frame (skipping skippable frames), so
+        // concatenated input reads as one stream.
+        if (ret == 0) {
+            vibe_zstd_frame_tracker ended;
+            if (reader_frame_end(&dstream->frame, &ended)) {
+                reader_frame_notify(self, &ended);
+            }
         }
 
-        // ret == 0 signals end of current frame
-        if (ret == 0) {
-            dstream->eof = 1;
+        // Exit when we've read enough data
+        if (total_read >= requested_size) {
             break;
         }
 
@@ -485,6 +959,48 @@ vibe_zstd_reader_read(int argc, VALUE *argv, VALUE self) {
     return result;
 }
 
+// Ensure function: always releases the reader regardless of raise/return
+static VALUE
+vibe_zstd_reader_read_ensure(VALUE arg) {
+    vibe_zstd_read_state* state = (vibe_zstd_read_state*)arg;
+    state->dstream->busy = 0;
+    return Qnil;
+}
+
+static VALUE
+vibe_zstd_reader_read(int argc, VALUE *argv, VALUE self) {
+    VALUE size_arg;
+    rb_scan_args(argc, argv, "01", &size_arg);
+
+    vibe_zstd_dstream* dstream;
+    TypedData_Get_Struct(self, vibe_zstd_dstream, &vibe_zstd_dstream_type, dstream);
+
+    // read(0): per IO semantics, always return "" without touching stream state
+    if (!NIL_P(size_arg) && NUM2SIZET(size_arg) == 0) {
+        return rb_str_new(NULL, 0);
+    }
+
+    if (dstream->eof) {
+        return Qnil;
+    }
+
+    // The GVL is released mid-read, so two threads could otherwise drive the
+    // same ZSTD_DStream at once (and io.read could re-enter the reader)
+    if (dstream->busy) {
+        rb_raise(rb_eRuntimeError, "DecompressReader is already in use by another read");
+    }
+
+    // Unbounded reads use configurable chunk size (defaults to ZSTD_DStreamOutSize() ~128KB)
+    // This provides chunked streaming behavior for true streaming use cases
+    size_t default_chunk_size = (dstream->initial_chunk_size > 0) ? dstream->initial_chunk_size : ZSTD_DStreamOutSize();
+    size_t requested_size = NIL_P(size_arg) ? default_chunk_size : NUM2SIZET(size_arg);
+
+    vibe_zstd_read_state state = { self, dstream, requested_size };
+    dstream->busy = 1;
+    return rb_ensure(vibe_zstd_reader_read_body, (VALUE)&state,
+                     vibe_zstd_reader_read_ensure, (VALUE)&state);
+}
+
 static VALUE
 vibe_zstd_reader_eof(VALUE self) {
     vibe_zstd_dstream* dstream;
@@ -498,10 +1014,12 @@ vibe_zstd_streaming_init_classes(VALUE rb_cVibeZstdCompressWriter, VALUE rb_cVib
     // Cache method IDs for frequently called methods
     id_write = rb_intern("write");
     id_read = rb_intern("read");
+    id_call = rb_intern("call");
 
     // CompressWriter setup
     rb_define_alloc_func(rb_cVibeZstdCompressWriter, vibe_zstd_cstream_alloc);
     rb_define_method(rb_cVibeZstdCompressWriter, "initialize", vibe_zstd_writer_initialize, -1);
+    rb_define_method(rb_cVibeZstdCompressWriter, "async?", vibe_zstd_writer_async_p, 0);
     rb_define_method(rb_cVibeZstdCompressWriter, "write", vibe_zstd_writer_write, 1);
     rb_define_method(rb_cVibeZstdCompressWriter, "flush", vibe_zstd_writer_flush, 0);
     rb_define_method(rb_cVibeZstdCompressWriter, "finish", vibe_zstd_writer_finish, 0);
@@ -0,0 +1,191 @@
+// Shared compression worker threads for VibeZstd
+//
+// By default every CCtx with workers > 0 starts its own set of zstd worker
+// threads on its first multi-threaded compression and keeps them until it is
+// freed, so N contexts with W workers each hold N * W threads. A ThreadPool
+// wraps ZSTD_createThreadPool: contexts attached to it with
+// ZSTD_CCtx_refThreadPool queue their jobs on the shared threads instead, which
+// bounds the thread count for the whole process regardless of how many
+// contexts and writers exist.
+//
+// zstd stores only a raw pointer to the pool, so every context that uses one
+// retains the Ruby object in @thread_pool and the threads are stopped only
+// once no context can reach them.
+//
+// The threads do not survive fork(). In a forked child a pool is rebuilt with
+// the same size the next time a context is attached to it (or eagerly, for
+// ThreadPool.default, by VibeZstd.after_fork!); the parent's pool is
+// abandoned, since its threads cannot be joined from the child.
+//
+// A ThreadPool is frozen once created and can be shared between Ractors: zstd
+// synchronizes its job queue itself, so contexts in every Ractor can run on
+// ThreadPool.default.
+#include "vibe_zstd_internal.h"
+
+static VALUE vibe_zstd_default_thread_pool = Qnil;
+
+// ThreadPool.new(threads = nil)
+//
+// threads defaults to the number of online CPUs: more workers than cores only
+// adds contention, since each job is CPU-bound.
+static VALUE
+vibe_zstd_thread_pool_initialize(int argc, VALUE* argv, VALUE self) {
+    VALUE threads_val = Qnil;
+    rb_scan_args(argc, argv, "01", &threads_val);
+    vibe_zstd_thread_pool* thread_pool;
+    TypedData_Get_Struct(self, vibe_zstd_thread_pool, &vibe_zstd_thread_pool_type, thread_pool);
+    if (thread_pool->pool) {
+        rb_raise(rb_eRuntimeError, "ThreadPool already initialized");
+    }
+
+    long threads;
+    if (NIL_P(threads_val)) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (threads < 1) threads = 1;
+    } else {
+        threads = NUM2LONG(threads_val);
+        if (threads < 1) {
+            rb_raise(rb_eArgError, "threads must be positive (got %ld)", threads);
+        }
+    }
+
+    thread_pool->pool = ZSTD_createThreadPool((size_t)threads);
+    if (!thread_pool->pool) {
+        rb_raise(rb_eRuntimeError, "Failed to create thread pool with %ld threads", threads);
+    }
+    thread_pool->threads = (size_t)threads;
+    thread_pool->pid = getpid();
+    rb_obj_freeze(self);
+    return self;
+}
+
+// The pool's threads, started again if they were the parent's before fork
+static ZSTD_threadPool*
+thread_pool_get_zstd(vibe_zstd_thread_pool* thread_pool) {
+    if (!thread_pool->pool) {
+        rb_raise(rb_eRuntimeError, "ThreadPool not initialized");
+    }
+    if (thread_pool->pid != getpid()) {
+        ZSTD_threadPool* pool = ZSTD_createThreadPool(thread_pool->threads);
+        if (!pool) {
+            rb_raise(rb_eRuntimeError, "Failed to create thread pool with %zu threads", thread_pool->threads);
+        }
+        thread_pool->pool = pool;
+        thread_pool->pid = getpid();
+    }
+    return thread_pool->pool;
+}
+
+// ThreadPool#threads - Number of worker threads the pool was created with
+static VALUE
+vibe_zstd_thread_pool_threads(VALUE self) {
+    vibe_zstd_thread_pool* thread_pool;
+    TypedData_Get_Struct(self, vibe_zstd_thread_pool, &vibe_zstd_thread_pool_type, thread_pool);
+    return SIZET2NUM(thread_pool->threads);
+}
+
+// ThreadPool.default - Process-wide pool sized to the online CPUs, created on
+// first use and never freed. Ractors asking at once may each create one; only
+// the first is kept, and the others stop their threads when collected.
+static VALUE
+vibe_zstd_thread_pool_default(VALUE klass) {
+    VALUE pool = RUBY_ATOMIC_VALUE_CAS(vibe_zstd_default_thread_pool, Qnil, Qnil);
+    if (NIL_P(pool)) {
+        VALUE created = rb_class_new_instance(0, NULL, klass);
+        pool = RUBY_ATOMIC_VALUE_CAS(vibe_zstd_default_thread_pool, Qnil, created);
+        if (NIL_P(pool)) pool = created;
+    }
+    return pool;
+}
+
+// Worker count a context on pool runs with when asked for workers. zstd sizes
+// the shared pool to a context's nbWorkers whenever that changes between
+// frames (ZSTDMT_resize calls POOL_resize on it), so any other value would
+// start more threads than the pool was created with, or cap every other
+// context on it. On a pool, workers > 0 therefore means the pool's size.
+static int
+vibe_zstd_thread_pool_workers(VALUE pool, int workers) {
+    if (NIL_P(pool) || workers <= 0) return workers;
+    vibe_zstd_thread_pool* thread_pool;
+    TypedData_Get_Struct(pool, vibe_zstd_thread_pool, &vibe_zstd_thread_pool_type, thread_pool);
+    ZSTD_bounds bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+    if (!ZSTD_isError(bounds.error) && thread_pool->threads > (size_t)bounds.upperBound) {
+        return bounds.upperBound;
+    }
+    return (int)thread_pool->threads;
+}
+
+// Attach pool (a ThreadPool, or nil to go back to per-context threads) to
+// cctx and retain it on owner. Shared by CCtx#thread_pool= and
+// CompressWriter.new(thread_pool:).
+//
+// zstd only reads the pool when it creates the context's multi-threading
+// state, on the first compression with workers > 0; assigning a pool after
+// that has no effect, so this belongs right after construction. workers
+// already set on cctx become the pool's size (vibe_zstd_thread_pool_workers).
+static void
+vibe_zstd_thread_pool_ref(VALUE owner, ZSTD_CCtx* cctx, VALUE pool) {
+    ZSTD_threadPool* zpool = NULL;
+    if (!NIL_P(pool)) {
+        vibe_zstd_thread_pool* thread_pool;
+        TypedData_Get_Struct(pool, vibe_zstd_thread_pool, &vibe_zstd_thread_pool_type, thread_pool);
+        zpool = thread_pool_get_zstd(thread_pool);
+    }
+    size_t result = ZSTD_CCtx_refThreadPool(cctx, zpool);
+    if (ZSTD_isError(result)) {
+        rb_raise(rb_eRuntimeError, "Failed to set thread pool: %s", ZSTD_getErrorName(result));
+    }
+    int workers = 0;
+    ZSTD_CCtx_getParameter(cctx, ZSTD_c_nbWorkers, &workers);
+    int pooled = vibe_zstd_thread_pool_workers(pool, workers);
+    if (pooled != workers) {
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, pooled);
+    }
+    rb_ivar_set(owner, rb_intern("@thread_pool"), pool);
+}
+
+// CCtx#thread_pool=(pool) - Run this context's workers on a shared ThreadPool
+static VALUE
+vibe_zstd_cctx_set_thread_pool(VALUE self, VALUE pool) {
+    vibe_zstd_cctx* cctx;
+    TypedData_Get_Struct(self, vibe_zstd_cctx, &vibe_zstd_cctx_type, cctx);
+    vibe_zstd_thread_pool_ref(self, cctx->cctx, pool);
+    // zstd keeps the pool's address, which is stale in a forked child
+    if (!NIL_P(pool)) cctx->pid = getpid();
+    return pool;
+}
+
+// CCtx#thread_pool - The shared ThreadPool, or nil
+static VALUE
+vibe_zstd_cctx_get_thread_pool(VALUE self) {
+    return rb_attr_get(self, rb_intern("@thread_pool"));
+}
+
+// VibeZstd.after_fork! - Called in a forked child by the Process._fork hook in
+// lib/vibe_zstd.rb. Restarts ThreadPool.default's threads if the parent had
+// started them. Everything else is repaired when next used: other ThreadPools
+// when a context is attached to them, contexts with workers on their next
+// compression, and the compress_many engine on its next batch.
+static VALUE
+vibe_zstd_after_fork(VALUE self) {
+    (void)self;
+    if (!NIL_P(vibe_zstd_default_thread_pool)) {
+        vibe_zstd_thread_pool* thread_pool;
+        TypedData_Get_Struct(vibe_zstd_default_thread_pool, vibe_zstd_thread_pool, &vibe_zstd_thread_pool_type, thread_pool);
+        thread_pool_get_zstd(thread_pool);
+    }
+    return Qnil;
+}
+
+void
+vibe_zstd_thread_pool_init_class(VALUE rb_cVibeZstdThreadPool, VALUE rb_cVibeZstdCCtx) {
+    rb_gc_register_address(&vibe_zstd_default_thread_pool);
+
+    rb_define_alloc_func(rb_cVibeZstdThreadPool, vibe_zstd_thread_pool_alloc);
+    rb_define_method(rb_cVibeZstdThreadPool, "initialize", vibe_zstd_thread_pool_initialize, -1);
+    rb_define_method(rb_cVibeZstdThreadPool, "threads", vibe_zstd_thread_pool_threads, 0);
+    rb_define_singleton_method(rb_cVibeZstdThreadPool, "default", vibe_zstd_thread_pool_default, 0);
+
+    rb_define_method(rb_cVibeZstdCCtx, "thread_pool=", vibe_zstd_cctx_set_thread_pool, 1);
+    rb_define_method(rb_cVibeZstdCCtx, "thread_pool", vibe_zstd_cctx_get_thread_pool, 0);
+}
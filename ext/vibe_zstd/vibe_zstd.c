@@ -1,7 +1,10 @@
 #include "vibe_zstd_internal.h"
 #include <ruby/thread.h>
+#include <ruby/ractor.h>
 #define ZDICT_STATIC_LINKING_ONLY
 #include <zdict.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 // Ruby module and class handles
 VALUE rb_mVibeZstd;
@@ -11,16 +14,166 @@ VALUE rb_cVibeZstdCDict;
 VALUE rb_cVibeZstdDDict;
 VALUE rb_cVibeZstdCompressWriter;
 VALUE rb_cVibeZstdDecompressReader;
+VALUE rb_cVibeZstdPool;
+VALUE rb_cVibeZstdThreadPool;
+VALUE rb_cVibeZstdDictionaryRegistry;
+VALUE rb_cVibeZstdDictArena;
 
 // Forward declarations for free, mark, and dsize functions
 static void vibe_zstd_cctx_free(void* ptr);
 static void vibe_zstd_dctx_free(void* ptr);
 static void vibe_zstd_cdict_free(void* ptr);
+static void vibe_zstd_cdict_mark(void* ptr);
 static void vibe_zstd_ddict_free(void* ptr);
+static void vibe_zstd_ddict_mark(void* ptr);
+static void vibe_zstd_dict_content_release(vibe_zstd_dict_content* content);
 static void vibe_zstd_cstream_free(void* ptr);
 static void vibe_zstd_cstream_mark(void* ptr);
 static void vibe_zstd_dstream_free(void* ptr);
 static void vibe_zstd_dstream_mark(void* ptr);
+static void vibe_zstd_pool_free(void* ptr);
+static void vibe_zstd_pool_mark(void* ptr);
+static void vibe_zstd_thread_pool_free(void* ptr);
+static void vibe_zstd_dict_registry_free(void* ptr);
+static void vibe_zstd_dict_registry_mark(void* ptr);
+static void vibe_zstd_dict_arena_free(void* ptr);
+static void vibe_zstd_readahead_free(vibe_zstd_readahead* ra);
+
+// Memory accounting. Contexts, streams and DDicts are created with
+// vibe_zstd_custom_mem, and the output buffers the no-GVL paths build up come
+// from vibe_zstd_malloc, so every byte zstd holds for us is counted in
+// vibe_zstd_mem_live (CDicts, which must go through ZSTD_createCDict to keep
+// their compression level, are counted by size at creation and free).
+//
+// The dsize callbacks only feed ObjectSpace; they never cause a collection.
+// Reporting the same bytes through rb_gc_adjust_memory_usage counts them as
+// malloc pressure, so allocating large contexts triggers GC and contexts that
+// are no longer referenced are freed promptly instead of lingering until an
+// unrelated collection.
+//
+// Allocation happens on any thread (no-GVL loops, zstd's compression workers),
+// so the allocator only updates an atomic counter. vibe_zstd_mem_flush reports
+// the change since the previous flush; it runs with the GVL held after objects
+// are created and whenever the GVL is reacquired.
+typedef union {
+    size_t size;
+    long double align_ld;
+    long long align_ll;
+    void* align_ptr;
+} vibe_zstd_mem_header;
+
+static size_t vibe_zstd_mem_live;      // updated atomically from any thread
+static size_t vibe_zstd_mem_reported;  // last value given to the GC, exchanged atomically
+
+static void*
+vibe_zstd_malloc(size_t size) {
+    if (size > SIZE_MAX - sizeof(vibe_zstd_mem_header)) return NULL;
+    vibe_zstd_mem_header* header = malloc(sizeof(vibe_zstd_mem_header) + size);
+    if (!header) return NULL;
+    header->size = size;
+    RUBY_ATOMIC_SIZE_ADD(vibe_zstd_mem_live, size);
+    return header + 1;
+}
+
+static void*
+vibe_zstd_realloc(void* ptr, size_t size) {
+    if (!ptr) return vibe_zstd_malloc(size);
+    if (size > SIZE_MAX - sizeof(vibe_zstd_mem_header)) return NULL;
+    vibe_zstd_mem_header* header = (vibe_zstd_mem_header*)ptr - 1;
+    size_t old_size = header->size;
+    header = realloc(header, sizeof(vibe_zstd_mem_header) + size);
+    if (!header) return NULL;
+    header->size = size;
+    if (size > old_size) {
+        RUBY_ATOMIC_SIZE_ADD(vibe_zstd_mem_live, size - old_size);
+    } else {
+        RUBY_ATOMIC_SIZE_SUB(vibe_zstd_mem_live, old_size - size);
+    }
+    return header + 1;
+}
+
+static void
+vibe_zstd_free(void* ptr) {
+    if (!ptr) return;
+    vibe_zstd_mem_header* header = (vibe_zstd_mem_header*)ptr - 1;
+    RUBY_ATOMIC_SIZE_SUB(vibe_zstd_mem_live, header->size);
+    free(header);
+}
+
+static void*
+vibe_zstd_custom_alloc(void* opaque, size_t size) {
+    (void)opaque;
+    return vibe_zstd_malloc(size);
+}
+
+static void
+vibe_zstd_custom_free(void* opaque, void* address) {
+    (void)opaque;
+    vibe_zstd_free(address);
+}
+
+static const ZSTD_customMem vibe_zstd_custom_mem = { vibe_zstd_custom_alloc, vibe_zstd_custom_free, NULL };
+
+// Count (or stop counting) memory allocated outside vibe_zstd_malloc
+static void
+vibe_zstd_mem_track(size_t size) {
+    RUBY_ATOMIC_SIZE_ADD(vibe_zstd_mem_live, size);
+}
+
+static void
+vibe_zstd_mem_untrack(size_t size) {
+    RUBY_ATOMIC_SIZE_SUB(vibe_zstd_mem_live, size);
+}
+
+static size_t
+vibe_zstd_mem_usage(void) {
+    return RUBY_ATOMIC_SIZE_CAS(vibe_zstd_mem_live, 0, 0);
+}
+
+// Report the change in live zstd memory since the last flush. GVL required;
+// Ractors each hold their own, so the last reported value is swapped
+// atomically and every change is reported exactly once.
+static void
+vibe_zstd_mem_flush(void) {
+    size_t live = vibe_zstd_mem_usage();
+    size_t reported = RUBY_ATOMIC_SIZE_EXCHANGE(vibe_zstd_mem_reported, live);
+    ssize_t diff = (ssize_t)(live - reported);
+    if (diff == 0) return;
+    rb_gc_adjust_memory_usage(diff);
+}
+
+// rb_thread_call_without_gvl, then report what zstd allocated or freed while
+// the GVL was released.
+static void
+vibe_zstd_call_without_gvl(void* (*func)(void*), void* arg, rb_unblock_function_t* ubf, void* ubf_arg) {
+    rb_thread_call_without_gvl(func, arg, ubf, ubf_arg);
+    vibe_zstd_mem_flush();
+}
+
+// Same, for work that may run on any thread (it touches only memory the
+// caller keeps alive and no Ruby state). Under a Fiber scheduler implementing
+// blocking_operation_wait (Ruby 3.4+), rb_nogvl with RB_NOGVL_OFFLOAD_SAFE
+// hands func to a worker thread and suspends only the calling fiber, so the
+// scheduler keeps running the thread's other fibers meanwhile. Without a
+// scheduler, or on older Rubies, the thread simply releases the GVL.
+static void
+vibe_zstd_call_offload(void* (*func)(void*), void* arg, rb_unblock_function_t* ubf, void* ubf_arg) {
+#ifdef RB_NOGVL_OFFLOAD_SAFE
+    rb_nogvl(func, arg, ubf, ubf_arg, RB_NOGVL_OFFLOAD_SAFE);
+    vibe_zstd_mem_flush();
+#else
+    vibe_zstd_call_without_gvl(func, arg, ubf, ubf_arg);
+#endif
+}
+
+// VibeZstd.native_memory_usage - Bytes currently held by zstd contexts,
+// streams, dictionaries and in-flight output buffers
+static VALUE
+vibe_zstd_native_memory_usage(VALUE self) {
+    (void)self;
+    vibe_zstd_mem_flush();
+    return SIZET2NUM(vibe_zstd_mem_usage());
+}
 
 // dsize callbacks - report memory usage to Ruby GC for accurate memory pressure tracking
 static size_t vibe_zstd_cctx_dsize(const void* ptr) {
@@ -33,14 +186,17 @@ static size_t vibe_zstd_dctx_dsize(const void* ptr) {
     return sizeof(vibe_zstd_dctx) + (dctx->dctx ? ZSTD_sizeof_DCtx(dctx->dctx) : 0);
 }
 
+// Dictionaries built in a DictArena are counted by the arena
 static size_t vibe_zstd_cdict_dsize(const void* ptr) {
     const vibe_zstd_cdict* cdict = ptr;
-    return sizeof(vibe_zstd_cdict) + (cdict->cdict ? ZSTD_sizeof_CDict(cdict->cdict) : 0);
+    int owned = cdict->cdict && NIL_P(cdict->content.arena);
+    return sizeof(vibe_zstd_cdict) + (owned ? ZSTD_sizeof_CDict(cdict->cdict) : 0);
 }
 
 static size_t vibe_zstd_ddict_dsize(const void* ptr) {
     const vibe_zstd_ddict* ddict = ptr;
-    return sizeof(vibe_zstd_ddict) + (ddict->ddict ? ZSTD_sizeof_DDict(ddict->ddict) : 0);
+    int owned = ddict->ddict && NIL_P(ddict->content.arena);
+    return sizeof(vibe_zstd_ddict) + (owned ? ZSTD_sizeof_DDict(ddict->ddict) : 0);
 }
 
 static size_t vibe_zstd_cstream_dsize(const void* ptr) {
@@ -53,6 +209,27 @@ static size_t vibe_zstd_dstream_dsize(const void* ptr) {
     return sizeof(vibe_zstd_dstream) + (dstream->dstream ? ZSTD_sizeof_DStream(dstream->dstream) : 0);
 }
 
+static size_t vibe_zstd_pool_dsize(const void* ptr) {
+    const vibe_zstd_pool* pool = ptr;
+    return sizeof(vibe_zstd_pool) + 2 * pool->max_idle * sizeof(VALUE);
+}
+
+static size_t vibe_zstd_thread_pool_dsize(const void* ptr) {
+    (void)ptr;
+    return sizeof(vibe_zstd_thread_pool);
+}
+
+static size_t vibe_zstd_dict_registry_dsize(const void* ptr) {
+    const vibe_zstd_dict_registry* registry = ptr;
+    return sizeof(vibe_zstd_dict_registry) + st_memsize(registry->entries) +
+           registry->entries->num_entries * sizeof(vibe_zstd_dict_registry_entry);
+}
+
+static size_t vibe_zstd_dict_arena_dsize(const void* ptr) {
+    const vibe_zstd_dict_arena* arena = ptr;
+    return sizeof(vibe_zstd_dict_arena) + arena->capacity;
+}
+
 // TypedData type definitions (these are referenced by extern in the split files)
 rb_data_type_t vibe_zstd_cctx_type = {
     .wrap_struct_name = "vibe_zstd_cctx",
@@ -79,23 +256,23 @@ rb_data_type_t vibe_zstd_dctx_type = {
 rb_data_type_t vibe_zstd_cdict_type = {
     .wrap_struct_name = "vibe_zstd_cdict",
     .function = {
-        .dmark = NULL,
+        .dmark = (RUBY_DATA_FUNC)vibe_zstd_cdict_mark,
         .dfree = (RUBY_DATA_FUNC)vibe_zstd_cdict_free,
         .dsize = vibe_zstd_cdict_dsize,
     },
     .data = NULL,
-    .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED | RUBY_TYPED_FROZEN_SHAREABLE,
 };
 
 rb_data_type_t vibe_zstd_ddict_type = {
     .wrap_struct_name = "vibe_zstd_ddict",
     .function = {
-        .dmark = NULL,
+        .dmark = (RUBY_DATA_FUNC)vibe_zstd_ddict_mark,
         .dfree = (RUBY_DATA_FUNC)vibe_zstd_ddict_free,
         .dsize = vibe_zstd_ddict_dsize,
     },
     .data = NULL,
-    .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED | RUBY_TYPED_FROZEN_SHAREABLE,
 };
 
 rb_data_type_t vibe_zstd_cstream_type = {
@@ -120,11 +297,59 @@ rb_data_type_t vibe_zstd_dstream_type = {
     .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
 };
 
+rb_data_type_t vibe_zstd_pool_type = {
+    .wrap_struct_name = "vibe_zstd_pool",
+    .function = {
+        .dmark = (RUBY_DATA_FUNC)vibe_zstd_pool_mark,
+        .dfree = (RUBY_DATA_FUNC)vibe_zstd_pool_free,
+        .dsize = vibe_zstd_pool_dsize,
+    },
+    .data = NULL,
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
+};
+
+rb_data_type_t vibe_zstd_thread_pool_type = {
+    .wrap_struct_name = "vibe_zstd_thread_pool",
+    .function = {
+        .dmark = NULL,
+        .dfree = (RUBY_DATA_FUNC)vibe_zstd_thread_pool_free,
+        .dsize = vibe_zstd_thread_pool_dsize,
+    },
+    .data = NULL,
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED | RUBY_TYPED_FROZEN_SHAREABLE,
+};
+
+rb_data_type_t vibe_zstd_dict_registry_type = {
+    .wrap_struct_name = "vibe_zstd_dict_registry",
+    .function = {
+        .dmark = (RUBY_DATA_FUNC)vibe_zstd_dict_registry_mark,
+        .dfree = (RUBY_DATA_FUNC)vibe_zstd_dict_registry_free,
+        .dsize = vibe_zstd_dict_registry_dsize,
+    },
+    .data = NULL,
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_WB_PROTECTED,
+};
+
+rb_data_type_t vibe_zstd_dict_arena_type = {
+    .wrap_struct_name = "vibe_zstd_dict_arena",
+    .function = {
+        .dfree = (RUBY_DATA_FUNC)vibe_zstd_dict_arena_free,
+        .dsize = vibe_zstd_dict_arena_dsize,
+    },
+    .data = NULL,
+    .flags = RUBY_TYPED_FREE_IMMEDIATELY | RUBY_TYPED_FROZEN_SHAREABLE,
+};
+
 // Free functions
+//
+// Worker threads do not survive fork(): a context, stream or ThreadPool whose
+// threads were started in the parent would wait forever to join them, so in a
+// forked child it is abandoned instead of freed. Its memory is the parent's,
+// still shared copy-on-write.
 static void
 vibe_zstd_cctx_free(void* ptr) {
     vibe_zstd_cctx* cctx = ptr;
-    if (cctx->cctx) {
+    if (cctx->cctx && (!cctx->pid || cctx->pid == getpid())) {
         ZSTD_freeCCtx(cctx->cctx);
     }
     ruby_xfree(cctx);
@@ -139,24 +364,46 @@ vibe_zstd_dctx_free(void* ptr) {
     ruby_xfree(dctx);
 }
 
+// Dictionaries built by reference are freed before the content they point into.
+// Those built in a DictArena are never freed by zstd: the arena owns them.
 static void
 vibe_zstd_cdict_free(void* ptr) {
     vibe_zstd_cdict* cdict = ptr;
-    if (cdict->cdict) {
+    if (cdict->cdict && NIL_P(cdict->content.arena)) {
+        vibe_zstd_mem_untrack(ZSTD_sizeof_CDict(cdict->cdict));
         ZSTD_freeCDict(cdict->cdict);
     }
+    vibe_zstd_dict_content_release(&cdict->content);
     ruby_xfree(cdict);
 }
 
 static void
 vibe_zstd_ddict_free(void* ptr) {
     vibe_zstd_ddict* ddict = ptr;
-    if (ddict->ddict) {
+    if (ddict->ddict && NIL_P(ddict->content.arena)) {
         ZSTD_freeDDict(ddict->ddict);
     }
+    vibe_zstd_dict_content_release(&ddict->content);
     ruby_xfree(ddict);
 }
 
+// rb_gc_mark (not the movable variant) pins the referenced String: zstd holds
+// a raw pointer into it, so GC compaction must not move an embedded string
+static void
+vibe_zstd_cdict_mark(void* ptr) {
+    vibe_zstd_cdict* cdict = ptr;
+    rb_gc_mark(cdict->content.source);
+    rb_gc_mark(cdict->content.arena);
+    rb_gc_mark(cdict->ddict);
+}
+
+static void
+vibe_zstd_ddict_mark(void* ptr) {
+    vibe_zstd_ddict* ddict = ptr;
+    rb_gc_mark(ddict->content.source);
+    rb_gc_mark(ddict->content.arena);
+}
+
 static void
 vibe_zstd_cstream_mark(void* ptr) {
     vibe_zstd_cstream* cstream = ptr;
@@ -167,7 +414,7 @@ vibe_zstd_cstream_mark(void* ptr) {
 static void
 vibe_zstd_cstream_free(void* ptr) {
     vibe_zstd_cstream* cstream = ptr;
-    if (cstream->cstream) {
+    if (cstream->cstream && (!cstream->pid || cstream->pid == getpid())) {
         ZSTD_freeCStream(cstream->cstream);
     }
     ruby_xfree(cstream);
@@ -178,37 +425,118 @@ vibe_zstd_dstream_mark(void* ptr) {
     vibe_zstd_dstream* dstream = ptr;
     rb_gc_mark(dstream->io);
     rb_gc_mark(dstream->input_data);
+    rb_gc_mark(dstream->pending);
+    rb_gc_mark(dstream->decoded);
 }
 
 static void
 vibe_zstd_dstream_free(void* ptr) {
     vibe_zstd_dstream* dstream = ptr;
+    // Join the decoder thread before freeing the stream it decodes with
+    if (dstream->readahead) {
+        vibe_zstd_readahead_free(dstream->readahead);
+    }
     if (dstream->dstream) {
         ZSTD_freeDStream(dstream->dstream);
     }
     ruby_xfree(dstream);
 }
 
+static void
+vibe_zstd_pool_mark(void* ptr) {
+    vibe_zstd_pool* pool = ptr;
+    for (size_t i = 0; i < pool->cctxs.idle_count; i++) rb_gc_mark(pool->cctxs.idle[i]);
+    for (size_t i = 0; i < pool->dctxs.idle_count; i++) rb_gc_mark(pool->dctxs.idle[i]);
+    rb_gc_mark(pool->cctx_params);
+    rb_gc_mark(pool->dctx_params);
+}
+
+static void
+vibe_zstd_pool_free(void* ptr) {
+    vibe_zstd_pool* pool = ptr;
+    ruby_xfree(pool->cctxs.idle);
+    ruby_xfree(pool->dctxs.idle);
+    ruby_xfree(pool);
+}
+
+// Stops and joins the worker threads. Contexts using the pool hold a
+// reference to it (@thread_pool), so it is only freed once they are too.
+static void
+vibe_zstd_thread_pool_free(void* ptr) {
+    vibe_zstd_thread_pool* thread_pool = ptr;
+    if (thread_pool->pid == getpid()) {
+        ZSTD_freeThreadPool(thread_pool->pool);
+    }
+    ruby_xfree(thread_pool);
+}
+
+static int
+vibe_zstd_dict_registry_mark_i(st_data_t key, st_data_t value, st_data_t arg) {
+    (void)key;
+    (void)arg;
+    vibe_zstd_dict_registry_entry* entry = (vibe_zstd_dict_registry_entry*)value;
+    rb_gc_mark(entry->ddict);
+    rb_gc_mark(entry->name);
+    return ST_CONTINUE;
+}
+
+static void
+vibe_zstd_dict_registry_mark(void* ptr) {
+    vibe_zstd_dict_registry* registry = ptr;
+    st_foreach(registry->entries, vibe_zstd_dict_registry_mark_i, 0);
+}
+
+static int
+vibe_zstd_dict_registry_free_i(st_data_t key, st_data_t value, st_data_t arg) {
+    (void)key;
+    (void)arg;
+    ruby_xfree((void*)value);
+    return ST_CONTINUE;
+}
+
+static void
+vibe_zstd_dict_registry_free(void* ptr) {
+    vibe_zstd_dict_registry* registry = ptr;
+    st_foreach(registry->entries, vibe_zstd_dict_registry_free_i, 0);
+    st_free_table(registry->entries);
+    ruby_xfree(registry);
+}
+
+// Dictionaries built in the arena reference it (content.arena), so it is only
+// unmapped once they are gone too
+static void
+vibe_zstd_dict_arena_free(void* ptr) {
+    vibe_zstd_dict_arena* arena = ptr;
+    if (arena->base) {
+        munmap(arena->base, arena->capacity);
+    }
+    ruby_xfree(arena);
+}
+
 // Alloc functions
 static VALUE
 vibe_zstd_cctx_alloc(VALUE klass) {
     vibe_zstd_cctx* cctx = ALLOC(vibe_zstd_cctx);
-    cctx->cctx = ZSTD_createCCtx();
+    cctx->cctx = ZSTD_createCCtx_advanced(vibe_zstd_custom_mem);
     if (!cctx->cctx) {
         ruby_xfree(cctx);
         rb_raise(rb_eRuntimeError, "Failed to create ZSTD_CCtx");
     }
+    cctx->auto_workers = 0;
+    cctx->pid = 0;
+    vibe_zstd_mem_flush();
     return TypedData_Wrap_Struct(klass, &vibe_zstd_cctx_type, cctx);
 }
 
 static VALUE
 vibe_zstd_dctx_alloc(VALUE klass) {
     vibe_zstd_dctx* dctx = ALLOC(vibe_zstd_dctx);
-    dctx->dctx = ZSTD_createDCtx();
+    dctx->dctx = ZSTD_createDCtx_advanced(vibe_zstd_custom_mem);
     if (!dctx->dctx) {
         ruby_xfree(dctx);
         rb_raise(rb_eRuntimeError, "Failed to create ZSTD_DCtx");
     }
+    vibe_zstd_mem_flush();
     dctx->initial_capacity = 0;  // 0 = use class default
     dctx->max_decompressed_size = 0;  // 0 = inherit class default
     return TypedData_Wrap_Struct(klass, &vibe_zstd_dctx_type, dctx);
@@ -218,6 +546,11 @@ static VALUE
 vibe_zstd_cdict_alloc(VALUE klass) {
     vibe_zstd_cdict* cdict = ALLOC(vibe_zstd_cdict);
     cdict->cdict = NULL; // Will be set in initialize
+    cdict->content.source = Qnil;
+    cdict->content.map = NULL;
+    cdict->content.map_size = 0;
+    cdict->content.arena = Qnil;
+    cdict->ddict = Qnil;
     return TypedData_Wrap_Struct(klass, &vibe_zstd_cdict_type, cdict);
 }
 
@@ -225,6 +558,10 @@ static VALUE
 vibe_zstd_ddict_alloc(VALUE klass) {
     vibe_zstd_ddict* ddict = ALLOC(vibe_zstd_ddict);
     ddict->ddict = NULL; // Will be set in initialize
+    ddict->content.source = Qnil;
+    ddict->content.map = NULL;
+    ddict->content.map_size = 0;
+    ddict->content.arena = Qnil;
     return TypedData_Wrap_Struct(klass, &vibe_zstd_ddict_type, ddict);
 }
 
@@ -234,6 +571,8 @@ vibe_zstd_cstream_alloc(VALUE klass) {
     cstream->cstream = NULL;
     cstream->io = Qnil;
     cstream->output_buffer = Qnil;
+    cstream->busy = 0;
+    cstream->pid = 0;
     return TypedData_Wrap_Struct(klass, &vibe_zstd_cstream_type, cstream);
 }
 
@@ -246,9 +585,52 @@ vibe_zstd_dstream_alloc(VALUE klass) {
     dstream->input.src = NULL;
     dstream->input.size = 0;
     dstream->input.pos = 0;
+    dstream->busy = 0;
+    dstream->threads = 0;
+    dstream->ddict = NULL;
+    dstream->pending = Qnil;
+    dstream->scanned = 0;
+    dstream->scanned_frames = 0;
+    dstream->streaming = 0;
+    dstream->decoded = Qnil;
+    dstream->decoded_pos = 0;
+    dstream->io_eof = 0;
+    dstream->readahead = NULL;
+    memset(&dstream->frame, 0, sizeof(dstream->frame));
     return TypedData_Wrap_Struct(klass, &vibe_zstd_dstream_type, dstream);
 }
 
+static VALUE
+vibe_zstd_pool_alloc(VALUE klass) {
+    vibe_zstd_pool* pool = ZALLOC(vibe_zstd_pool);
+    pool->cctx_params = Qnil;
+    pool->dctx_params = Qnil;
+    return TypedData_Wrap_Struct(klass, &vibe_zstd_pool_type, pool);
+}
+
+static VALUE
+vibe_zstd_thread_pool_alloc(VALUE klass) {
+    vibe_zstd_thread_pool* thread_pool = ALLOC(vibe_zstd_thread_pool);
+    thread_pool->pool = NULL;  // Will be set in initialize
+    thread_pool->threads = 0;
+    thread_pool->pid = 0;
+    return TypedData_Wrap_Struct(klass, &vibe_zstd_thread_pool_type, thread_pool);
+}
+
+static VALUE
+vibe_zstd_dict_registry_alloc(VALUE klass) {
+    vibe_zstd_dict_registry* registry = ALLOC(vibe_zstd_dict_registry);
+    registry->entries = st_init_numtable();
+    registry->last_version = 0;
+    return TypedData_Wrap_Struct(klass, &vibe_zstd_dict_registry_type, registry);
+}
+
+static VALUE
+vibe_zstd_dict_arena_alloc(VALUE klass) {
+    vibe_zstd_dict_arena* arena = ZALLOC(vibe_zstd_dict_arena);
+    return TypedData_Wrap_Struct(klass, &vibe_zstd_dict_arena_type, arena);
+}
+
 // Module-level version and compression level functions
 static VALUE
 vibe_zstd_version_number(VALUE self) {
@@ -280,41 +662,202 @@ vibe_zstd_default_c_level(VALUE self) {
     return INT2NUM(ZSTD_defaultCLevel());
 }
 
-// Run func(arg) without the GVL while str is locked against mutation.
-// rb_thread_call_without_gvl can deliver a pending async exception (e.g.
-// Thread#raise, Timeout) after reacquiring the GVL, so the unlock must go
-// through rb_ensure or the string would be left permanently locked.
+// IO::Buffer support. Wherever a String is accepted as binary input, an
+// IO::Buffer (including an IO::Buffer.map'd file) is accepted too and read in
+// place, without copying it into a Ruby String. The public accessors used here
+// appeared in Ruby 3.2; on older Rubies IO::Buffer arguments raise TypeError
+// like any other non-String.
+static int
+vibe_zstd_io_buffer_p(VALUE obj) {
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+    return RTEST(rb_obj_is_kind_of(obj, rb_cIOBuffer));
+#else
+    (void)obj;
+    return 0;
+#endif
+}
+
+// Resolve binary input to a pointer and length. Strings go through
+// StringValue (so to_str is honored); the returned VALUE is what must be kept
+// alive and locked while the bytes are in use.
+static VALUE
+vibe_zstd_input_bytes(VALUE data, const char** ptr, size_t* len) {
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+    if (vibe_zstd_io_buffer_p(data)) {
+        const void* base;
+        rb_io_buffer_get_bytes_for_reading(data, &base, len);
+        *ptr = base;
+        return data;
+    }
+#endif
+    StringValue(data);
+    *ptr = RSTRING_PTR(data);
+    *len = RSTRING_LEN(data);
+    return data;
+}
+
+// Lock a String or IO::Buffer against mutation, resizing and freeing.
+static void
+vibe_zstd_bytes_lock(VALUE obj) {
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+    if (vibe_zstd_io_buffer_p(obj)) {
+        rb_io_buffer_lock(obj);
+        return;
+    }
+#endif
+    rb_str_locktmp(obj);
+}
+
+static void
+vibe_zstd_bytes_unlock(VALUE obj) {
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+    if (vibe_zstd_io_buffer_p(obj)) {
+        rb_io_buffer_unlock(obj);
+        return;
+    }
+#endif
+    rb_str_unlocktmp(obj);
+}
+
+// Run func(arg) without the GVL while str (a String or IO::Buffer) is locked
+// against mutation. rb_thread_call_without_gvl can deliver a pending async
+// exception (e.g. Thread#raise, Timeout) after reacquiring the GVL, so the
+// unlock must go through rb_ensure or the string would be left permanently
+// locked.
 typedef struct {
     void* (*func)(void*);
     void* arg;
+    int offload;  // Run through vibe_zstd_call_offload
 } nogvl_locked_call;
 
 static VALUE
 nogvl_locked_body(VALUE p) {
     nogvl_locked_call* call = (nogvl_locked_call*)p;
-    rb_thread_call_without_gvl(call->func, call->arg, NULL, NULL);
+    if (call->offload) {
+        vibe_zstd_call_offload(call->func, call->arg, NULL, NULL);
+    } else {
+        vibe_zstd_call_without_gvl(call->func, call->arg, NULL, NULL);
+    }
     return Qnil;
 }
 
 static VALUE
 nogvl_locked_unlock(VALUE str) {
-    rb_str_unlocktmp(str);
+    vibe_zstd_bytes_unlock(str);
     return Qnil;
 }
 
 static void
 vibe_zstd_nogvl_with_str_locked(void* (*func)(void*), void* arg, VALUE str) {
-    nogvl_locked_call call = { func, arg };
-    rb_str_locktmp(str);
+    nogvl_locked_call call = { func, arg, 0 };
+    vibe_zstd_bytes_lock(str);
+    rb_ensure(nogvl_locked_body, (VALUE)&call, nogvl_locked_unlock, str);
+}
+
+// vibe_zstd_nogvl_with_str_locked through vibe_zstd_call_offload
+static void
+vibe_zstd_offload_with_str_locked(void* (*func)(void*), void* arg, VALUE str) {
+    nogvl_locked_call call = { func, arg, 1 };
+    vibe_zstd_bytes_lock(str);
     rb_ensure(nogvl_locked_body, (VALUE)&call, nogvl_locked_unlock, str);
 }
 
+// Same as vibe_zstd_nogvl_with_str_locked, for calls that read src and write
+// into a caller-owned dst (compress_into / decompress_into). dst is locked
+// inside the ensured body so a failed lock (dst already locked by another
+// thread) still unlocks src.
+typedef struct {
+    void* (*func)(void*);
+    void* arg;
+    VALUE src;
+    VALUE dst;
+    int dst_locked;
+} nogvl_locked_pair_call;
+
+static VALUE
+nogvl_locked_pair_body(VALUE p) {
+    nogvl_locked_pair_call* call = (nogvl_locked_pair_call*)p;
+    vibe_zstd_bytes_lock(call->dst);
+    call->dst_locked = 1;
+    vibe_zstd_call_without_gvl(call->func, call->arg, NULL, NULL);
+    return Qnil;
+}
+
+static VALUE
+nogvl_locked_pair_unlock(VALUE p) {
+    nogvl_locked_pair_call* call = (nogvl_locked_pair_call*)p;
+    if (call->dst_locked) vibe_zstd_bytes_unlock(call->dst);
+    vibe_zstd_bytes_unlock(call->src);
+    return Qnil;
+}
+
+static void
+vibe_zstd_nogvl_with_strs_locked(void* (*func)(void*), void* arg, VALUE src, VALUE dst) {
+    nogvl_locked_pair_call call = { func, arg, src, dst, 0 };
+    vibe_zstd_bytes_lock(src);
+    rb_ensure(nogvl_locked_pair_body, (VALUE)&call, nogvl_locked_pair_unlock, (VALUE)&call);
+}
+
+// Resolve the destination of compress_into / decompress_into. An IO::Buffer
+// is written in place and never resized: *capacity becomes its size and 1 is
+// returned. Otherwise dst is prepared as a String of at least capacity bytes
+// (see vibe_zstd_prepare_output_buffer) and 0 is returned.
+static void vibe_zstd_prepare_output_buffer(VALUE src, VALUE dst, size_t capacity);
+
+static int
+vibe_zstd_output_target(VALUE src, VALUE dst, char** ptr, size_t* capacity) {
+    if (dst == src) {
+        rb_raise(rb_eArgError, "output buffer must be a different object from the input");
+    }
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+    if (vibe_zstd_io_buffer_p(dst)) {
+        void* base;
+        rb_io_buffer_get_bytes_for_writing(dst, &base, capacity);
+        *ptr = base;
+        return 1;
+    }
+#endif
+    vibe_zstd_prepare_output_buffer(src, dst, *capacity);
+    *ptr = RSTRING_PTR(dst);
+    return 0;
+}
+
+// Prepare a caller-supplied output String for compress_into / decompress_into:
+// it must be a distinct, mutable String, ends up binary, and is grown only when
+// its capacity is below the required size, to at least double its capacity so
+// slowly growing payloads do not reallocate on every call. Existing capacity
+// is never given back, so a buffer reused across calls stops allocating once
+// it is large enough.
+static void
+vibe_zstd_prepare_output_buffer(VALUE src, VALUE dst, size_t capacity) {
+    if (!RB_TYPE_P(dst, T_STRING)) {
+        rb_raise(rb_eTypeError, "output buffer must be a String (given %"PRIsVALUE")", rb_obj_class(dst));
+    }
+    if (dst == src) {
+        rb_raise(rb_eArgError, "output buffer must be a different object from the input");
+    }
+    rb_str_modify(dst);
+    size_t current = rb_str_capacity(dst);
+    if (current < capacity) {
+        if (capacity < current * 2) capacity = current * 2;
+        rb_str_modify_expand(dst, (long)(capacity - RSTRING_LEN(dst)));
+    }
+    rb_enc_associate_index(dst, rb_ascii8bit_encindex());
+}
+
 // Include the split implementation files
+#include "thread_pool.c"
+#include "registry.c"
 #include "cctx.c"
 #include "dctx.c"
 #include "dict.c"
+#include "dict_arena.c"
 #include "streaming.c"
+#include "readahead.c"
 #include "frames.c"
+#include "parallel.c"
+#include "files.c"
+#include "context_pool.c"
 
 // Main initialization function
 RUBY_FUNC_EXPORTED void
@@ -323,6 +866,15 @@ Init_vibe_zstd(void)
   // Parameter lookup tables are initialized in vibe_zstd_cctx_init_class()
   // and vibe_zstd_dctx_init_class() respectively - no need to call here.
 
+#ifdef HAVE_RB_EXT_RACTOR_SAFE
+  // Methods may be called from any Ractor. Process-wide state is either set
+  // up here and read-only afterwards (classes, parameter tables, IDs), updated
+  // atomically (memory accounting, DCtx class defaults, ThreadPool.default) or
+  // kept per Ractor (Pool.default). CDict, DDict and ThreadPool objects are
+  // frozen and shareable; everything else belongs to the Ractor that made it.
+  rb_ext_ractor_safe(true);
+#endif
+
   rb_mVibeZstd = rb_define_module("VibeZstd");
 
   // Define classes
@@ -332,6 +884,10 @@ Init_vibe_zstd(void)
   rb_cVibeZstdDDict = rb_define_class_under(rb_mVibeZstd, "DDict", rb_cObject);
   rb_cVibeZstdCompressWriter = rb_define_class_under(rb_mVibeZstd, "CompressWriter", rb_cObject);
   rb_cVibeZstdDecompressReader = rb_define_class_under(rb_mVibeZstd, "DecompressReader", rb_cObject);
+  rb_cVibeZstdPool = rb_define_class_under(rb_mVibeZstd, "Pool", rb_cObject);
+  rb_cVibeZstdThreadPool = rb_define_class_under(rb_mVibeZstd, "ThreadPool", rb_cObject);
+  rb_cVibeZstdDictionaryRegistry = rb_define_class_under(rb_mVibeZstd, "DictionaryRegistry", rb_cObject);
+  rb_cVibeZstdDictArena = rb_define_class_under(rb_mVibeZstd, "DictArena", rb_cObject);
 
   // Initialize each subsystem
   vibe_zstd_cctx_init_class(rb_cVibeZstdCCtx);
@@ -340,6 +896,12 @@ Init_vibe_zstd(void)
   vibe_zstd_dict_init_module_methods(rb_mVibeZstd);
   vibe_zstd_streaming_init_classes(rb_cVibeZstdCompressWriter, rb_cVibeZstdDecompressReader);
   vibe_zstd_frames_init_module_methods(rb_mVibeZstd);
+  vibe_zstd_parallel_init_module_methods(rb_mVibeZstd);
+  vibe_zstd_files_init_methods(rb_cVibeZstdCCtx, rb_cVibeZstdDCtx);
+  vibe_zstd_pool_init_class(rb_cVibeZstdPool);
+  vibe_zstd_thread_pool_init_class(rb_cVibeZstdThreadPool, rb_cVibeZstdCCtx);
+  vibe_zstd_dict_registry_init_class(rb_cVibeZstdDictionaryRegistry);
+  vibe_zstd_dict_arena_init_class(rb_cVibeZstdDictArena);
 
   // Module-level version information
   rb_define_module_function(rb_mVibeZstd, "version_number", vibe_zstd_version_number, 0);
@@ -347,6 +909,8 @@ Init_vibe_zstd(void)
   rb_define_module_function(rb_mVibeZstd, "min_compression_level", vibe_zstd_min_c_level, 0);
   rb_define_module_function(rb_mVibeZstd, "max_compression_level", vibe_zstd_max_c_level, 0);
   rb_define_module_function(rb_mVibeZstd, "default_compression_level", vibe_zstd_default_c_level, 0);
+  rb_define_module_function(rb_mVibeZstd, "native_memory_usage", vibe_zstd_native_memory_usage, 0);
+  rb_define_module_function(rb_mVibeZstd, "after_fork!", vibe_zstd_after_fork, 0);
 
   // Aliases
   rb_define_module_function(rb_mVibeZstd, "min_level", vibe_zstd_min_c_level, 0);
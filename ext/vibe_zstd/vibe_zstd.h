@@ -8,6 +8,8 @@
 // TypedData structs
 typedef struct {
     ZSTD_CCtx* cctx;
+    int auto_workers;  // workers = :auto - nbWorkers/jobSize are picked per call from the input size
+    pid_t pid;         // Process the context may have started worker threads in (0 = never configured for them)
 } vibe_zstd_cctx;
 
 typedef struct {
@@ -16,20 +18,46 @@ typedef struct {
     size_t max_decompressed_size;  // Output size limit (0 = inherit class default; class default 0 = unlimited)
 } vibe_zstd_dctx;
 
+// Dictionary content a CDict/DDict built by reference points into (dict.c).
+// Copying dictionaries (the default) leave all fields empty.
+typedef struct {
+    VALUE source;     // by_reference: frozen String, pinned by the dict's mark function
+    void* map;        // open: read-only mapping of the dictionary file
+    size_t map_size;
+    VALUE arena;      // DictArena the whole dictionary was built in (dict_arena.c); not freed by zstd
+} vibe_zstd_dict_content;
+
 typedef struct {
     ZSTD_CDict* cdict;
+    vibe_zstd_dict_content content;
+    VALUE ddict;      // Matching DDict once to_ddict has built it, else nil
 } vibe_zstd_cdict;
 
 typedef struct {
     ZSTD_DDict* ddict;
+    vibe_zstd_dict_content content;
 } vibe_zstd_ddict;
 
 typedef struct {
     ZSTD_CStream* cstream;
     VALUE io;
     VALUE output_buffer;  // Reusable output buffer to avoid ~128KB allocation per write/flush/finish
+    int busy;             // Set while write/flush/finish runs (the GVL is released mid-call)
+    pid_t pid;            // Process owning the stream's worker threads (0 = single-threaded)
 } vibe_zstd_cstream;
 
+// Frame currently being decoded by a DecompressReader. The leading bytes
+// identify skippable frames, which decode to nothing and are not reported.
+typedef struct {
+    char magic[4];             // First bytes of the frame (magic number)
+    size_t magic_len;
+    unsigned long long size;   // Decompressed bytes so far
+    unsigned long long index;  // Data frames completed before this one
+} vibe_zstd_frame_tracker;
+
+// Decoder thread state for DecompressReader readahead mode (readahead.c)
+typedef struct vibe_zstd_readahead vibe_zstd_readahead;
+
 typedef struct {
     ZSTD_DStream* dstream;
     VALUE io;
@@ -37,8 +65,67 @@ typedef struct {
     VALUE input_data;      // Ruby string holding input data
     int eof;               // Flag to track if we've reached end of stream
     size_t initial_chunk_size;  // Initial chunk size for unbounded reads (0 = use default)
+    int busy;              // Set while read runs (the GVL is released mid-call)
+    size_t threads;        // > 1 enables parallel frame decoding (0/1 = serial)
+    ZSTD_DDict* ddict;     // Dictionary for parallel mode (object retained via @dict)
+    VALUE pending;         // Parallel mode: buffered compressed input not yet decoded
+    size_t scanned;        // Parallel mode: bytes of pending already split into complete frames
+    size_t scanned_frames; // Parallel mode: data frames within those bytes
+    int streaming;         // Parallel mode: the front frame is decoded through dstream
+    VALUE decoded;         // Parallel mode: decoded output not yet returned
+    size_t decoded_pos;    // Parallel mode: read offset into decoded
+    int io_eof;            // Parallel mode: io.read has returned nil
+    vibe_zstd_readahead* readahead;  // Readahead mode: decoder thread (owns dstream while running)
+    vibe_zstd_frame_tracker frame;   // Serial mode: frame boundaries for on_frame:
 } vibe_zstd_dstream;
 
+// Shared zstd worker threads for multi-threaded compression (thread_pool.c)
+typedef struct {
+    ZSTD_threadPool* pool;
+    size_t threads;
+    pid_t pid;           // Process the threads run in; the pool is rebuilt after fork
+} vibe_zstd_thread_pool;
+
+// One dictionary held by a DictionaryRegistry (registry.c)
+typedef struct {
+    VALUE ddict;                 // DDict object
+    unsigned int dict_id;
+    VALUE name;                  // Version group (e.g. a tenant), or nil
+    unsigned long long version;  // Insertion order; the newest is current(name)
+    int retired;                 // A newer version of name was added
+    double last_used;            // Monotonic seconds: last lookup, or retirement
+} vibe_zstd_dict_registry_entry;
+
+typedef struct {
+    st_table* entries;           // dict_id => vibe_zstd_dict_registry_entry*
+    unsigned long long last_version;
+} vibe_zstd_dict_registry;
+
+// Region static CDicts/DDicts are built in before forking (dict_arena.c)
+typedef struct {
+    char* base;          // Anonymous private mapping, page aligned
+    size_t capacity;
+    size_t used;
+    size_t dict_count;
+    int sealed;          // Mapping made read-only; no more dictionaries
+} vibe_zstd_dict_arena;
+
+// Idle contexts of one kind in a Pool: a LIFO stack of CCtx or DCtx objects.
+typedef struct {
+    VALUE* idle;           // idle[0, idle_count) are parked contexts
+    size_t idle_count;
+    size_t in_use;         // checked out right now
+    size_t created;        // contexts the pool has ever created
+} vibe_zstd_pool_stack;
+
+typedef struct {
+    vibe_zstd_pool_stack cctxs;
+    vibe_zstd_pool_stack dctxs;
+    size_t max_idle;       // per stack; returns beyond this drop the context
+    VALUE cctx_params;     // frozen Hash of CCtx.new keywords, or nil
+    VALUE dctx_params;     // frozen Hash of DCtx.new keywords, or nil
+} vibe_zstd_pool;
+
 // TypedData types
 extern rb_data_type_t vibe_zstd_cctx_type;
 extern rb_data_type_t vibe_zstd_dctx_type;
@@ -46,6 +133,10 @@ extern rb_data_type_t vibe_zstd_cdict_type;
 extern rb_data_type_t vibe_zstd_ddict_type;
 extern rb_data_type_t vibe_zstd_cstream_type;
 extern rb_data_type_t vibe_zstd_dstream_type;
+extern rb_data_type_t vibe_zstd_pool_type;
+extern rb_data_type_t vibe_zstd_thread_pool_type;
+extern rb_data_type_t vibe_zstd_dict_registry_type;
+extern rb_data_type_t vibe_zstd_dict_arena_type;
 
 // Ruby classes and modules
 extern VALUE rb_cVibeZstdCCtx;
@@ -54,5 +145,9 @@ extern VALUE rb_cVibeZstdCDict;
 extern VALUE rb_cVibeZstdDDict;
 extern VALUE rb_cVibeZstdCompressWriter;
 extern VALUE rb_cVibeZstdDecompressReader;
+extern VALUE rb_cVibeZstdPool;
+extern VALUE rb_cVibeZstdThreadPool;
+extern VALUE rb_cVibeZstdDictionaryRegistry;
+extern VALUE rb_cVibeZstdDictArena;
 
 #endif /* VIBE_ZSTD_H */
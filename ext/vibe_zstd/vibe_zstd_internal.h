@@ -3,6 +3,11 @@
 
 #include "vibe_zstd.h"
 #include <ruby/thread.h>
+#include <ruby/atomic.h>
+#include <ruby/encoding.h>
+#ifdef HAVE_RB_IO_BUFFER_GET_BYTES_FOR_READING
+#include <ruby/io/buffer.h>
+#endif
 #define ZDICT_STATIC_LINKING_ONLY
 #include <zdict.h>
 
@@ -24,4 +29,22 @@ void vibe_zstd_streaming_init_classes(VALUE rb_cVibeZstdCompressWriter, VALUE rb
 // Frame utility functions (frames.c)
 void vibe_zstd_frames_init_module_methods(VALUE rb_mVibeZstd);
 
+// Parallel batch engine (parallel.c)
+void vibe_zstd_parallel_init_module_methods(VALUE rb_mVibeZstd);
+
+// File-to-file compression (files.c)
+void vibe_zstd_files_init_methods(VALUE rb_cVibeZstdCCtx, VALUE rb_cVibeZstdDCtx);
+
+// Shared compression worker threads (thread_pool.c)
+void vibe_zstd_thread_pool_init_class(VALUE rb_cVibeZstdThreadPool, VALUE rb_cVibeZstdCCtx);
+
+// Dictionary registry (registry.c)
+void vibe_zstd_dict_registry_init_class(VALUE rb_cVibeZstdDictionaryRegistry);
+
+// Pre-fork dictionary arena (dict_arena.c)
+void vibe_zstd_dict_arena_init_class(VALUE rb_cVibeZstdDictArena);
+
+// Shared context pool (context_pool.c)
+void vibe_zstd_pool_init_class(VALUE rb_cVibeZstdPool);
+
 #endif /* VIBE_ZSTD_INTERNAL_H */
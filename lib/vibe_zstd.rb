@@ -3,6 +3,8 @@
 require_relative "vibe_zstd/version"
 require "vibe_zstd/vibe_zstd"
 require_relative "vibe_zstd/constants"
+require_relative "vibe_zstd/seekable"
+require_relative "vibe_zstd/preload"
 
 module VibeZstd
   class Error < StandardError; end
@@ -13,7 +15,7 @@ module VibeZstd
   # VibeZstd.decompress(data, format: 1) work through the convenience methods.
   # An unknown keyword raises NoMethodError from the corresponding setter.
   COMPRESS_CALL_OPTIONS = %i[level dict pledged_size].freeze
-  DECOMPRESS_CALL_OPTIONS = %i[dict initial_capacity max_decompressed_size max_size].freeze
+  DECOMPRESS_CALL_OPTIONS = %i[dict initial_capacity max_decompressed_size max_size threads].freeze
   private_constant :COMPRESS_CALL_OPTIONS, :DECOMPRESS_CALL_OPTIONS
 
   # Convenience method for one-off compression.
@@ -27,29 +29,49 @@ module VibeZstd
   end
 
   # Convenience method for one-off decompression.
-  # Per-call options (dict, initial_capacity, max_decompressed_size/max_size) are
-  # passed to #decompress; any other keyword is a context parameter (e.g.
-  # format:, window_log_max:) applied to a fresh DCtx.
+  # Per-call options (dict, initial_capacity, max_decompressed_size/max_size,
+  # threads) are passed to #decompress; any other keyword is a context
+  # parameter (e.g. format:, window_log_max:) applied to a fresh DCtx.
   def self.decompress(data, **options)
     call_opts = options.slice(*DECOMPRESS_CALL_OPTIONS)
     ctx_opts = options.except(*DECOMPRESS_CALL_OPTIONS)
     DCtx.new(**ctx_opts).decompress(data, **call_opts)
   end
 
+  # Compress the file at src_path into dst_path natively (see CCtx#compress_file).
+  # Options are split like compress: level/dict/pledged_size per call, anything
+  # else (e.g. workers:, checksum_flag:) configures the context.
+  def self.compress_file(src_path, dst_path, **options)
+    call_opts = options.slice(*COMPRESS_CALL_OPTIONS)
+    ctx_opts = options.except(*COMPRESS_CALL_OPTIONS)
+    CCtx.new(**ctx_opts).compress_file(src_path, dst_path, **call_opts)
+  end
+
+  # Decompress the file at src_path into dst_path natively (see
+  # DCtx#decompress_file). dict and max_decompressed_size/max_size apply per
+  # call; anything else (e.g. window_log_max:) configures the context.
+  def self.decompress_file(src_path, dst_path, **options)
+    call_opts = options.slice(*DECOMPRESS_CALL_OPTIONS)
+    ctx_opts = options.except(*DECOMPRESS_CALL_OPTIONS)
+    DCtx.new(**ctx_opts).decompress_file(src_path, dst_path, **call_opts)
+  end
+
   # Get the decompressed content size from a compressed frame
   # Returns nil if size is unknown or data is invalid
   def self.frame_content_size(data)
     DCtx.frame_content_size(data)
   end
 
-  # Iterate over all skippable frames in the data
+  # Iterate over all skippable frames in the data (a String or IO::Buffer)
   # Yields [content, magic_variant, offset] for each skippable frame
   def self.each_skippable_frame(data)
     return enum_for(:each_skippable_frame, data) unless block_given?
 
+    io_buffer = data.is_a?(IO::Buffer)
+    size = io_buffer ? data.size : data.bytesize
     offset = 0
-    while offset < data.bytesize
-      frame_data = data.byteslice(offset..-1)
+    while offset < size
+      frame_data = io_buffer ? data.slice(offset) : data.byteslice(offset..-1)
       frame_size = find_frame_compressed_size(frame_data)
 
       # Defense: Prevent infinite loop on malformed data
@@ -72,18 +94,6 @@ module VibeZstd
     alias_method :default_level, :default_compression_level
   end
 
-  # Add helper method to CDict for creating matching DDict
-  class CDict
-    # Get or create a matching DDict from this CDict's dictionary data
-    # The DDict is cached so it's only created once
-    #
-    # @return [DDict] Decompression dictionary matching this compression dictionary
-    def to_ddict
-      @ddict ||= DDict.new(@dict_data)
-    end
-    alias_method :ddict, :to_ddict
-  end
-
   # Thread-local context pooling for high-performance reuse
   # Ideal for Rails/Puma applications where threads are reused across requests
   #
@@ -103,13 +113,52 @@ module VibeZstd
   # Memory footprint: ~128KB per DCtx × unique dictionaries × threads
   # Example: 3 dicts × 5 Puma threads = 1.9MB total
   #
+  # Bounded: each thread keeps at most max_contexts compression and
+  # max_contexts decompression contexts, evicting the least recently used, and
+  # drops contexts unused for idle_timeout seconds so a level-19 workspace is
+  # not pinned for the life of the thread. Evicted contexts are freed by the GC.
+  #
   # Storage: uses Thread#thread_variable_get/set (true thread-local) so that
   # fiber-based servers (Falcon, async) share one pool per OS thread rather
   # than allocating a fresh pool for every fiber.
+  # Threads belong to one Ractor, so each Ractor has pools of its own;
+  # max_contexts and idle_timeout are shared and set from the main Ractor.
   #
   # Note: Only supports per-operation parameters (level, dict, pledged_size, initial_capacity)
   # Does NOT support context-level settings (nb_workers, checksum_flag, etc.)
+  #
+  # With many threads and dictionaries, prefer VibeZstd::Pool: it shares a
+  # bounded set of contexts across threads instead of keeping one per thread
+  # per dictionary.
   module ThreadLocal
+    DEFAULT_MAX_CONTEXTS = 8
+    DEFAULT_IDLE_TIMEOUT = 60
+
+    # A pooled context and the monotonic time it was last checked out
+    Entry = Struct.new(:context, :last_used)
+    private_constant :Entry
+
+    @max_contexts = DEFAULT_MAX_CONTEXTS
+    @idle_timeout = DEFAULT_IDLE_TIMEOUT
+
+    class << self
+      # Contexts kept per thread for each of compression and decompression
+      attr_reader :max_contexts
+
+      # Seconds after which an unused context is dropped (nil = never)
+      attr_reader :idle_timeout
+
+      def max_contexts=(count)
+        raise ArgumentError, "max_contexts must be a positive Integer" unless count.is_a?(Integer) && count.positive?
+        @max_contexts = count
+      end
+
+      def idle_timeout=(seconds)
+        raise ArgumentError, "idle_timeout must be positive or nil" if seconds && !seconds.positive?
+        @idle_timeout = seconds
+      end
+    end
+
     # Compress data using thread-local context pool
     # Contexts are keyed by dictionary ID for automatic isolation
     #
@@ -121,11 +170,7 @@ module VibeZstd
     def self.compress(data, level: nil, dict: nil, pledged_size: nil)
       # Key by dictionary ID, or :default if no dict
       key = dict ? dict.dict_id : :default
-
-      # Get or create thread-local context pool (true thread-local, not fiber-local)
-      pool = Thread.current.thread_variable_get(:vibe_zstd_cctx_pool) || {}
-      cctx = pool[key] ||= VibeZstd::CCtx.new
-      Thread.current.thread_variable_set(:vibe_zstd_cctx_pool, pool)
+      cctx = checkout(:vibe_zstd_cctx_pool, key, CCtx)
 
       # Build options hash
       options = {}
@@ -146,11 +191,7 @@ module VibeZstd
     # @return [String] Decompressed data
     def self.decompress(data, dict: nil, initial_capacity: nil, max_decompressed_size: nil)
       key = dict ? dict.dict_id : :default
-
-      # Get or create thread-local context pool (true thread-local, not fiber-local)
-      pool = Thread.current.thread_variable_get(:vibe_zstd_dctx_pool) || {}
-      dctx = pool[key] ||= VibeZstd::DCtx.new
-      Thread.current.thread_variable_set(:vibe_zstd_dctx_pool, pool)
+      dctx = checkout(:vibe_zstd_dctx_pool, key, DCtx)
 
       # Build options hash
       options = {}
@@ -170,6 +211,25 @@ module VibeZstd
       nil
     end
 
+    # Drop contexts unused for at least idle_for seconds, on the current thread
+    # or (all_threads: true) on every live thread, e.g. from a periodic timer so
+    # threads that went quiet release their workspaces too.
+    #
+    # @return [Integer] Number of contexts dropped
+    def self.trim!(idle_for = idle_timeout || 0, all_threads: false)
+      now = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      threads = all_threads ? Thread.list : [Thread.current]
+      threads.sum do |thread|
+        %i[vibe_zstd_cctx_pool vibe_zstd_dctx_pool].sum do |var|
+          pool = thread.thread_variable_get(var)
+          next 0 unless pool
+          # Snapshot first: another thread's pool may change while we work
+          stale = pool.to_a.select { |_key, entry| now - entry.last_used >= idle_for }
+          stale.count { |key, entry| pool.delete(key) if pool[key].equal?(entry) }
+        end
+      end
+    end
+
     # Get statistics about the current thread's context pools
     # @return [Hash] Pool statistics
     def self.thread_cache_stats
@@ -179,9 +239,38 @@ module VibeZstd
         compression_contexts: cctx_pool&.size || 0,
         decompression_contexts: dctx_pool&.size || 0,
         compression_keys: cctx_pool&.keys || [],
-        decompression_keys: dctx_pool&.keys || []
+        decompression_keys: dctx_pool&.keys || [],
+        compression_bytes: cctx_pool&.sum { |_key, entry| entry.context.memory_size } || 0,
+        decompression_bytes: dctx_pool&.sum { |_key, entry| entry.context.memory_size } || 0
       }
     end
+
+    # Fetch (or create) the context for key, keeping the pool in LRU order:
+    # the entry is re-inserted on every hit, so the first entry is always the
+    # least recently used one and both eviction and idle trimming look only at
+    # the front.
+    def self.checkout(var, key, klass)
+      pool = Thread.current.thread_variable_get(var)
+      Thread.current.thread_variable_set(var, pool = {}) unless pool
+      now = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+
+      if (timeout = @idle_timeout)
+        while (oldest = pool.first) && now - oldest[1].last_used >= timeout
+          pool.delete(oldest[0])
+        end
+      end
+
+      entry = pool.delete(key)
+      if entry
+        entry.last_used = now
+      else
+        pool.delete(pool.first[0]) while pool.size >= @max_contexts
+        entry = Entry.new(klass.new, now)
+      end
+      pool[key] = entry
+      entry.context
+    end
+    private_class_method :checkout
   end
 
   class CompressWriter
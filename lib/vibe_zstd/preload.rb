@@ -0,0 +1,79 @@
+# frozen_string_literal: true
+
+module VibeZstd
+  # Input preload! compresses at each level: 128 KB, one full zstd block, so
+  # the warmed contexts size their workspaces for typical payloads
+  PRELOAD_SAMPLE = ("VibeZstd preload sample: the quick brown fox jumps over the lazy dog. " * 1900).byteslice(0, 128 * 1024).freeze
+  private_constant :PRELOAD_SAMPLE
+
+  # Do in the master of a preforking server (Puma cluster mode, Unicorn,
+  # Pitchfork) what every freshly forked worker would otherwise repeat on its
+  # first requests: digest dictionaries and build and size compression and
+  # decompression contexts. Call it before forking; the workers then inherit
+  # warm contexts in the shared pool and ready dictionaries.
+  #
+  # String entries of dicts are digested into a CDict per level plus a DDict.
+  # CDict, DDict and DictionaryRegistry entries are used as they are. For every
+  # level and every CDict (decompressed with its DDict, if one was given or
+  # built), one frame is compressed and decompressed on each warmed context.
+  #
+  # @param levels [Array<Integer>] Compression levels the workers will use
+  # @param dicts [Array<String, CDict, DDict, DictionaryRegistry>] Dictionaries to preload
+  # @param pool [Pool] Pool whose contexts are warmed
+  # @param contexts [Integer] Contexts of each kind to warm, e.g. threads per worker
+  # @return [Hash{Symbol => Array}] cdicts: and ddicts: every dictionary preloaded
+  def self.preload!(levels: [default_compression_level], dicts: [], pool: Pool.default, contexts: 1)
+    cdicts = []
+    ddicts = []
+    dicts.each do |dict|
+      case dict
+      when CDict then cdicts << dict
+      when DDict then ddicts << dict
+      when DictionaryRegistry then ddicts.concat(dict.dict_ids.map { |id| dict[id] })
+      else
+        levels.each { |level| cdicts << CDict.new(dict, level) }
+        ddicts << DDict.new(dict)
+      end
+    end
+
+    ddicts_by_id = ddicts.to_h { |ddict| [ddict.dict_id, ddict] }
+    preload_contexts(pool, contexts) do |cctx, dctx|
+      levels.each { |level| dctx.decompress(cctx.compress(PRELOAD_SAMPLE, level: level)) }
+      cdicts.each do |cdict|
+        frame = cctx.compress(PRELOAD_SAMPLE, dict: cdict)
+        ddict = ddicts_by_id[cdict.dict_id]
+        dctx.decompress(frame, dict: ddict) if ddict
+      end
+    end
+
+    {cdicts: cdicts, ddicts: ddicts}
+  end
+
+  # Check out count contexts of each kind at once, so the pool warms (and
+  # keeps) that many, and yield each CCtx/DCtx pair
+  def self.preload_contexts(pool, count, pairs = [], &block)
+    if pairs.size >= count
+      pairs.each { |cctx, dctx| yield cctx, dctx }
+      return
+    end
+    pool.with_cctx do |cctx|
+      pool.with_dctx { |dctx| preload_contexts(pool, count, pairs << [cctx, dctx], &block) }
+    end
+  end
+  private_class_method :preload_contexts
+
+  # zstd worker threads do not survive fork. Process._fork (Ruby 3.1+) runs for
+  # every fork (Kernel#fork, Process.fork, Process.daemon, IO.popen("-")), so
+  # the child rebuilds ThreadPool.default right away; contexts, writers and
+  # other pools detect the fork on their next use (see VibeZstd.after_fork!).
+  module ForkHook
+    def _fork
+      pid = super
+      VibeZstd.after_fork! if pid == 0
+      pid
+    end
+  end
+  private_constant :ForkHook
+
+  Process.singleton_class.prepend(ForkHook)
+end
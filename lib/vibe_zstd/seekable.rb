@@ -0,0 +1,261 @@
+# frozen_string_literal: true
+
+module VibeZstd
+  # Zstandard seekable format
+  # (https://github.com/facebook/zstd/blob/dev/contrib/seekable_format/zstd_seekable_compression_format.md)
+  #
+  # The data is split into independent frames of a fixed decompressed size,
+  # followed by a skippable frame holding a seek table (compressed and
+  # decompressed size of every frame). Any zstd decoder can still decompress
+  # the whole file; SeekableReader uses the table to decompress only the
+  # frames covering a requested range.
+  #
+  # Layout of the seek table frame:
+  #   Skippable magic 0x184D2A5E (u32) | Frame size (u32)
+  #   Entries: Compressed size (u32) | Decompressed size (u32) [| Checksum (u32)]
+  #   Footer:  Number of frames (u32) | Descriptor (u8) | Seekable magic 0x8F92EAB1 (u32)
+  module Seekable
+    SKIPPABLE_MAGIC_VARIANT = 0xE
+    SEEKABLE_MAGIC = 0x8F92EAB1
+    FOOTER_SIZE = 9
+    SKIPPABLE_HEADER_SIZE = 8
+    CHECKSUM_FLAG = 0x80
+    MAX_FRAMES = 0x8000000
+    MAX_FRAME_SIZE = 1 << 30
+    DEFAULT_FRAME_SIZE = 1 << 20
+
+    # Counts the compressed bytes CompressWriter hands to the IO so the
+    # writer can record each frame's compressed size in the seek table.
+    class CountingIO # :nodoc:
+      attr_reader :bytes
+
+      def initialize(io)
+        @io = io
+        @bytes = 0
+      end
+
+      def write(data)
+        @io.write(data)
+        @bytes += data.bytesize
+      end
+    end
+  end
+
+  # Writes data in the seekable format: independent frames of frame_size
+  # decompressed bytes each, then the seek table on finish.
+  #
+  # Options other than frame_size (level:, dict:) are passed to the
+  # underlying CompressWriter.
+  #
+  #   VibeZstd::SeekableWriter.open(File.open("events.zst", "wb"), frame_size: 4 << 20) do |w|
+  #     events.each { |event| w.write(event) }
+  #   end
+  class SeekableWriter
+    attr_reader :frame_size
+
+    def self.open(io, **options)
+      writer = new(io, **options)
+      return writer unless block_given?
+
+      begin
+        yield writer
+      ensure
+        writer.finish
+      end
+    end
+
+    def initialize(io, frame_size: Seekable::DEFAULT_FRAME_SIZE, **options)
+      unless frame_size.is_a?(Integer) && frame_size.between?(1, Seekable::MAX_FRAME_SIZE)
+        raise ArgumentError, "frame_size must be between 1 and #{Seekable::MAX_FRAME_SIZE}"
+      end
+      raise ArgumentError, "pledged_size is not supported by SeekableWriter" if options.key?(:pledged_size)
+
+      @io = io
+      @frame_size = frame_size
+      @counter = Seekable::CountingIO.new(io)
+      @writer = CompressWriter.new(@counter, **options)
+      @entries = []
+      @frame_bytes = 0
+      @frame_start = 0
+      @finished = false
+    end
+
+    # Compress data, ending a frame every frame_size decompressed bytes
+    def write(data)
+      raise IOError, "SeekableWriter already finished" if @finished
+
+      data = data.to_str
+      pos = 0
+      while pos < data.bytesize
+        room = @frame_size - @frame_bytes
+        piece = (pos == 0 && data.bytesize <= room) ? data : data.byteslice(pos, room)
+        @writer.write(piece)
+        @frame_bytes += piece.bytesize
+        pos += piece.bytesize
+        end_frame if @frame_bytes == @frame_size
+      end
+      self
+    end
+    alias_method :<<, :write
+
+    # Number of frames completed so far
+    def frame_count
+      @entries.size
+    end
+
+    # End the current frame and write the seek table. Further writes raise.
+    def finish
+      return self if @finished
+
+      end_frame if @frame_bytes > 0
+      table = +"".b
+      @entries.each { |compressed, decompressed| table << [compressed, decompressed].pack("VV") }
+      table << [@entries.size, 0, Seekable::SEEKABLE_MAGIC].pack("VCV")
+      @io.write(VibeZstd.write_skippable_frame(table, magic_number: Seekable::SKIPPABLE_MAGIC_VARIANT))
+      @finished = true
+      self
+    end
+    alias_method :close, :finish
+
+    private
+
+    def end_frame
+      @writer.finish
+      raise Error, "Too many frames for the seekable format" if @entries.size >= Seekable::MAX_FRAMES
+
+      @entries << [@counter.bytes - @frame_start, @frame_bytes]
+      @frame_start = @counter.bytes
+      @frame_bytes = 0
+    end
+  end
+
+  # Random access into seekable-format data.
+  #
+  # io must respond to pread and size (File does); a String is treated as a
+  # path and opened (and closed by #close). Only the frames covering the
+  # requested range are read and decompressed. The most recently decompressed
+  # frame is cached, so sequential small reads do not decompress it again.
+  #
+  # A reader holds one DCtx and a frame cache, so it must not be shared
+  # between threads without external locking.
+  #
+  #   reader = VibeZstd::SeekableReader.new("events.zst")
+  #   tail = reader.read_at(reader.size - 4096, 4096)
+  class SeekableReader
+    attr_reader :size, :frame_count
+
+    def self.open(io, **options)
+      reader = new(io, **options)
+      return reader unless block_given?
+
+      begin
+        yield reader
+      ensure
+        reader.close
+      end
+    end
+
+    def initialize(io, dict: nil)
+      if io.is_a?(String)
+        @io = File.open(io, "rb")
+        @owns_io = true
+      else
+        raise TypeError, "IO object must respond to pread" unless io.respond_to?(:pread)
+        @io = io
+        @owns_io = false
+      end
+      @dict = dict
+      @dctx = DCtx.new
+      @cached_index = nil
+      @cached_frame = nil
+      load_seek_table
+    end
+
+    # Read length decompressed bytes starting at offset. Returns a shorter
+    # String at the end of the data and nil when offset is at or past the end.
+    def read_at(offset, length)
+      raise ArgumentError, "negative offset" if offset.negative?
+      raise ArgumentError, "negative length" if length.negative?
+      return +"" if length.zero?
+      return nil if offset >= @size
+
+      stop = [offset + length, @size].min
+      index = frame_index(offset)
+      result = +"".b
+      while offset < stop
+        frame = decompress_frame(index)
+        start = offset - @d_offsets[index]
+        piece = frame.byteslice(start, stop - offset)
+        result << piece
+        offset += piece.bytesize
+        index += 1
+      end
+      result
+    end
+
+    # Decompressed size of the frame at index
+    def frame_decompressed_size(index)
+      @d_offsets.fetch(index + 1) - @d_offsets.fetch(index)
+    end
+
+    def close
+      @io.close if @owns_io && !@io.closed?
+      @cached_frame = nil
+      nil
+    end
+
+    private
+
+    def load_seek_table
+      file_size = @io.size
+      raise Error, "Data too small for a seek table" if file_size < Seekable::SKIPPABLE_HEADER_SIZE + Seekable::FOOTER_SIZE
+
+      frames, descriptor, magic = @io.pread(Seekable::FOOTER_SIZE, file_size - Seekable::FOOTER_SIZE).unpack("VCV")
+      raise Error, "Seek table not found (bad seekable magic number)" unless magic == Seekable::SEEKABLE_MAGIC
+      raise Error, "Seek table descriptor has reserved bits set" unless (descriptor & 0x7C).zero?
+      raise Error, "Seek table has too many frames (#{frames})" if frames > Seekable::MAX_FRAMES
+
+      entry_size = (descriptor & Seekable::CHECKSUM_FLAG).zero? ? 8 : 12
+      table_size = Seekable::SKIPPABLE_HEADER_SIZE + frames * entry_size + Seekable::FOOTER_SIZE
+      raise Error, "Seek table larger than the data" if table_size > file_size
+
+      table = @io.pread(table_size, file_size - table_size)
+      content, variant = VibeZstd.read_skippable_frame(table)
+      unless variant == Seekable::SKIPPABLE_MAGIC_VARIANT && content.bytesize == table_size - Seekable::SKIPPABLE_HEADER_SIZE
+        raise Error, "Malformed seek table frame"
+      end
+
+      @frame_count = frames
+      @c_offsets = Array.new(frames + 1, 0)
+      @d_offsets = Array.new(frames + 1, 0)
+      frames.times do |i|
+        compressed, decompressed = content.unpack("VV", offset: i * entry_size)
+        @c_offsets[i + 1] = @c_offsets[i] + compressed
+        @d_offsets[i + 1] = @d_offsets[i] + decompressed
+      end
+      raise Error, "Seek table does not match the data size" unless @c_offsets.last == file_size - table_size
+
+      @size = @d_offsets.last
+    end
+
+    # Index of the frame containing decompressed offset (offset < @size)
+    def frame_index(offset)
+      (0...@frame_count).bsearch { |i| @d_offsets[i + 1] > offset }
+    end
+
+    def decompress_frame(index)
+      return @cached_frame if @cached_index == index
+
+      compressed_size = @c_offsets[index + 1] - @c_offsets[index]
+      expected = frame_decompressed_size(index)
+      compressed = @io.pread(compressed_size, @c_offsets[index])
+      options = {max_decompressed_size: [expected, 1].max}
+      options[:dict] = @dict if @dict
+      frame = @dctx.decompress(compressed, **options)
+      raise Error, "Frame #{index} decompressed to #{frame.bytesize} bytes, seek table says #{expected}" unless frame.bytesize == expected
+
+      @cached_index = index
+      @cached_frame = frame
+    end
+  end
+end
@@ -1,6 +1,7 @@
 # frozen_string_literal: true
 
 require "test_helper"
+require "objspace"
 
 class TestCCtx < Minitest::Test
   # Basic construction and compression
@@ -906,6 +907,36 @@ class TestCCtx < Minitest::Test
     assert_equal(data, decompressed)
   end
 
+  def test_workers_auto
+    cctx = VibeZstd::CCtx.new(workers: :auto)
+    assert_equal :auto, cctx.workers
+    data = Random.new(3).bytes(1024) * 8192
+    assert_equal data, VibeZstd.decompress(cctx.compress(data))
+    assert_equal data, VibeZstd.decompress(VibeZstd.compress(data, workers: :auto, level: 1))
+    assert_equal ["small"], cctx.compress_batch(["small"]).map { |frame| VibeZstd.decompress(frame) }
+
+    cctx.workers = 2
+    assert_equal 2, cctx.workers
+    assert_raises(ArgumentError) { cctx.workers = :many }
+  end
+
+  def test_auto_workers_heuristic
+    # Small inputs stay single-threaded at any level
+    assert_equal({workers: 0, job_size: 0}, VibeZstd::CCtx.auto_workers(100_000, threads: 8))
+    assert_equal 0, VibeZstd::CCtx.auto_workers(3_000_000, level: 1, threads: 8)[:workers]
+    # Higher levels split smaller inputs
+    assert_equal 2, VibeZstd::CCtx.auto_workers(1_048_576, level: 19, threads: 8)[:workers]
+    # Tens of MB fan out to every core, one job each
+    pick = VibeZstd::CCtx.auto_workers(40 << 20, level: 3, threads: 8)
+    assert_equal 8, pick[:workers]
+    assert_equal 5 << 20, pick[:job_size]
+    # Capped by the thread budget
+    assert_equal 0, VibeZstd::CCtx.auto_workers(40 << 20, threads: 1)[:workers]
+    # Unknown-size streams (SIZE_MAX) and huge inputs keep zstd's default job size
+    assert_equal({workers: 8, job_size: 0}, VibeZstd::CCtx.auto_workers(2**64 - 1, threads: 8))
+    assert_equal({workers: 8, job_size: 0}, VibeZstd::CCtx.auto_workers(2**62, threads: 8))
+  end
+
   def test_all_aliases_together
     cctx = VibeZstd::CCtx.new
     dctx = VibeZstd::DCtx.new
@@ -986,4 +1017,110 @@ class TestCCtx < Minitest::Test
     compressed = cctx.compress(data)
     assert_equal data, VibeZstd.decompress(compressed)
   end
+
+  # --- compress_batch --------------------------------------------------------
+
+  def test_compress_batch_round_trips_in_order
+    cctx = VibeZstd::CCtx.new
+    inputs = 50.times.map { |i| "cache entry #{i} " * (i + 1) }
+    compressed = cctx.compress_batch(inputs)
+
+    assert_equal inputs.size, compressed.size
+    dctx = VibeZstd::DCtx.new
+    inputs.zip(compressed).each do |input, frame|
+      assert_equal input, dctx.decompress(frame)
+    end
+  end
+
+  def test_compress_batch_matches_compress
+    cctx = VibeZstd::CCtx.new
+    inputs = ["alpha " * 40, "", "beta " * 10]
+    assert_equal inputs.map { |s| cctx.compress(s, level: 7) }, cctx.compress_batch(inputs, level: 7)
+  end
+
+  def test_compress_batch_empty_array
+    assert_equal [], VibeZstd::CCtx.new.compress_batch([])
+  end
+
+  def test_compress_batch_allows_repeated_string_object
+    shared = "the same object twice " * 10
+    compressed = VibeZstd::CCtx.new.compress_batch([shared, shared])
+    assert_equal [shared, shared], compressed.map { |c| VibeZstd.decompress(c) }
+  end
+
+  def test_compress_batch_with_dict_restores_context
+    dict_data = VibeZstd.train_dict(200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" })
+    cdict = VibeZstd::CDict.new(dict_data)
+    ddict = VibeZstd::DDict.new(dict_data)
+    cctx = VibeZstd::CCtx.new(compression_level: 5)
+
+    inputs = 10.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" }
+    compressed = cctx.compress_batch(inputs, dict: cdict, level: 1)
+
+    compressed.each { |frame| assert_equal cdict.dict_id, VibeZstd.get_dict_id_from_frame(frame) }
+    assert_equal inputs, compressed.map { |frame| VibeZstd.decompress(frame, dict: ddict) }
+
+    # Per-call level and dictionary do not stick to the context
+    assert_equal 5, cctx.compression_level
+    assert_equal 0, VibeZstd.get_dict_id_from_frame(cctx.compress("no dict"))
+  end
+
+  def test_compress_batch_survives_compaction
+    skip "GC.auto_compact not supported" unless GC.respond_to?(:auto_compact=)
+    # Small inputs and outputs are embedded Strings; with GC.stress every
+    # allocation in the batch setup compacts the heap and can move them
+    inputs = 50.times.map { |i| "entry #{i}" }
+    cctx = VibeZstd::CCtx.new
+    expected = cctx.compress_batch(inputs)
+    begin
+      GC.auto_compact = true
+      GC.stress = true
+      frames = cctx.compress_batch(inputs)
+    ensure
+      GC.stress = false
+      GC.auto_compact = false
+    end
+    assert_equal expected, frames
+  end
+
+  def test_compress_batch_rejects_non_strings_and_pledged_size
+    cctx = VibeZstd::CCtx.new
+    assert_raises(TypeError) { cctx.compress_batch(["ok", 42]) }
+    assert_raises(TypeError) { cctx.compress_batch("not an array") }
+    assert_raises(ArgumentError) { cctx.compress_batch(["ok"], pledged_size: 2) }
+  end
+
+  def test_compress_into_reuses_buffer
+    cctx = VibeZstd::CCtx.new(compression_level: 5)
+    data = "reuse me " * 500
+    buffer = +"previous contents"
+
+    size = cctx.compress_into(data, buffer)
+    assert_equal size, buffer.bytesize
+    assert_equal Encoding::BINARY, buffer.encoding
+    assert_equal cctx.compress(data), buffer
+    assert_equal data, VibeZstd.decompress(buffer)
+
+    # Once large enough, the buffer is rewritten in place
+    capacity = ObjectSpace.memsize_of(buffer)
+    10.times { |i| cctx.compress_into(data.byteslice(0, 4000 - i), buffer) }
+    assert_equal capacity, ObjectSpace.memsize_of(buffer)
+    assert_equal data.byteslice(0, 3991), VibeZstd.decompress(buffer)
+  end
+
+  def test_compress_into_honors_per_call_options
+    dict_data = VibeZstd.train_dict(200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" })
+    cdict = VibeZstd::CDict.new(dict_data)
+    buffer = +""
+    VibeZstd::CCtx.new.compress_into("{\"id\":1}", buffer, dict: cdict, level: 1)
+    assert_equal cdict.dict_id, VibeZstd.get_dict_id_from_frame(buffer)
+  end
+
+  def test_compress_into_rejects_invalid_buffers
+    cctx = VibeZstd::CCtx.new
+    data = +"data"
+    assert_raises(FrozenError) { cctx.compress_into(data, "frozen".freeze) }
+    assert_raises(TypeError) { cctx.compress_into(data, nil) }
+    assert_raises(ArgumentError) { cctx.compress_into(data, data) }
+  end
 end
@@ -1,6 +1,7 @@
 # frozen_string_literal: true
 
 require "test_helper"
+require "objspace"
 require "stringio"
 
 class TestDCtx < Minitest::Test
@@ -554,4 +555,187 @@ class TestDCtx < Minitest::Test
     end
     assert_match(/must be Symbol/i, error.message)
   end
+
+  # --- decompress_batch ------------------------------------------------------
+
+  def test_decompress_batch_round_trips_in_order
+    inputs = 50.times.map { |i| "payload #{i} " * (i + 1) }
+    frames = VibeZstd::CCtx.new.compress_batch(inputs)
+    assert_equal inputs, VibeZstd::DCtx.new.decompress_batch(frames)
+  end
+
+  def test_decompress_batch_mixes_known_and_unknown_size_frames
+    io = StringIO.new
+    writer = VibeZstd::CompressWriter.new(io)
+    writer.write("streamed without a content size")
+    writer.finish
+    frames = [VibeZstd.compress("known size"), io.string, VibeZstd.compress("")]
+
+    assert_equal ["known size", "streamed without a content size", ""],
+      VibeZstd::DCtx.new.decompress_batch(frames)
+  end
+
+  def test_decompress_batch_with_dict
+    dict_data = VibeZstd.train_dict(200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" })
+    cdict = VibeZstd::CDict.new(dict_data)
+    ddict = VibeZstd::DDict.new(dict_data)
+    inputs = 10.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" }
+    frames = VibeZstd::CCtx.new.compress_batch(inputs, dict: cdict)
+
+    dctx = VibeZstd::DCtx.new
+    assert_equal inputs, dctx.decompress_batch(frames, dict: ddict)
+    assert_raises(ArgumentError) { dctx.decompress_batch(frames) }
+  end
+
+  def test_decompress_batch_survives_compaction
+    skip "GC.auto_compact not supported" unless GC.respond_to?(:auto_compact=)
+    # See TestCCtx#test_compress_batch_survives_compaction
+    inputs = 50.times.map { |i| "entry #{i}" }
+    frames = VibeZstd::CCtx.new.compress_batch(inputs)
+    dctx = VibeZstd::DCtx.new
+    begin
+      GC.auto_compact = true
+      GC.stress = true
+      decoded = dctx.decompress_batch(frames)
+    ensure
+      GC.stress = false
+      GC.auto_compact = false
+    end
+    assert_equal inputs, decoded
+  end
+
+  def test_decompress_batch_enforces_max_size
+    frames = [VibeZstd.compress("a" * 10), VibeZstd.compress("b" * 1000)]
+    assert_raises(VibeZstd::DecompressedSizeExceeded) do
+      VibeZstd::DCtx.new.decompress_batch(frames, max_size: 100)
+    end
+  end
+
+  def test_decompress_batch_reports_failing_index
+    frames = [VibeZstd.compress("fine"), VibeZstd.compress("x" * 100).byteslice(0, 12)]
+    error = assert_raises(RuntimeError) { VibeZstd::DCtx.new.decompress_batch(frames) }
+    assert_match(/index 1/, error.message)
+  end
+
+  # --- Concatenated frames -----------------------------------------------------
+
+  def streamed_frame(data, **opts)
+    io = StringIO.new(+"".b)
+    VibeZstd::CompressWriter.open(io, **opts) { |w| w.write(data) }
+    io.string
+  end
+
+  def test_decompress_concatenated_known_size_frames
+    parts = ["first frame ", "second frame " * 50, "", "third"]
+    blob = parts.map { |part| VibeZstd.compress(part) }.join
+    assert_equal parts.join, VibeZstd::DCtx.new.decompress(blob)
+  end
+
+  def test_decompress_concatenated_frames_with_unknown_sizes_and_skippable_frames
+    blob = VibeZstd.compress("known ") +
+      VibeZstd.write_skippable_frame("metadata") +
+      streamed_frame("streamed " * 1000) +
+      VibeZstd.write_skippable_frame("trailer", magic_number: 3)
+    assert_equal "known " + "streamed " * 1000, VibeZstd::DCtx.new.decompress(blob)
+  end
+
+  def test_decompress_concatenated_frames_with_many_small_blocks
+    # Each flush emits a block, so ZSTD_decompressBound far exceeds the output
+    io = StringIO.new(+"".b)
+    writer = VibeZstd::CompressWriter.new(io)
+    500.times { |i| writer.write("line #{i}\n").flush }
+    writer.finish
+    blob = io.string * 2
+
+    expected = 500.times.map { |i| "line #{i}\n" }.join * 2
+    assert_equal expected, VibeZstd::DCtx.new.decompress(blob)
+  end
+
+  def test_decompress_concatenated_frames_enforces_total_max_size
+    blob = VibeZstd.compress("a" * 600) + VibeZstd.compress("b" * 600)
+    assert_raises(VibeZstd::DecompressedSizeExceeded) do
+      VibeZstd::DCtx.new.decompress(blob, max_size: 1000)
+    end
+    assert_equal 1200, VibeZstd::DCtx.new.decompress(blob, max_size: 1200).bytesize
+
+    streamed = streamed_frame("a" * 600) + streamed_frame("b" * 600)
+    assert_raises(VibeZstd::DecompressedSizeExceeded) do
+      VibeZstd::DCtx.new.decompress(streamed, max_size: 1000)
+    end
+  end
+
+  def test_decompress_concatenated_frames_checks_every_dictionary
+    samples = 200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\",\"active\":true}" }
+    dict_data = VibeZstd.train_dict(samples)
+    cdict = VibeZstd::CDict.new(dict_data)
+    ddict = VibeZstd::DDict.new(dict_data)
+    blob = VibeZstd.compress("plain ") + VibeZstd.compress("with dict", dict: cdict)
+
+    error = assert_raises(ArgumentError) { VibeZstd::DCtx.new.decompress(blob) }
+    assert_match(/requires dictionary/, error.message)
+    assert_equal "plain with dict", VibeZstd::DCtx.new.decompress(blob, dict: ddict)
+  end
+
+  def test_decompress_rejects_trailing_garbage
+    blob = VibeZstd.compress("payload") + "garbage!"
+    assert_raises(RuntimeError) { VibeZstd::DCtx.new.decompress(blob) }
+    assert_raises(RuntimeError) { VibeZstd::DCtx.new.decompress(streamed_frame("payload") + "garbage!") }
+  end
+
+  def test_decompress_batch_concatenated_frames
+    frames = [VibeZstd.compress("a") + VibeZstd.compress("b"), streamed_frame("c") + streamed_frame("d")]
+    assert_equal ["ab", "cd"], VibeZstd::DCtx.new.decompress_batch(frames)
+  end
+
+  # --- decompress_into ---------------------------------------------------------
+
+  def test_decompress_into_known_size_reuses_buffer
+    dctx = VibeZstd::DCtx.new
+    data = "known size " * 1000
+    frame = VibeZstd.compress(data)
+    buffer = +"stale"
+
+    assert_equal data.bytesize, dctx.decompress_into(frame, buffer)
+    assert_equal data, buffer
+    assert_equal Encoding::BINARY, buffer.encoding
+
+    capacity = ObjectSpace.memsize_of(buffer)
+    10.times { dctx.decompress_into(frame, buffer) }
+    assert_equal capacity, ObjectSpace.memsize_of(buffer)
+
+    assert_equal 0, dctx.decompress_into(VibeZstd.compress(""), buffer)
+    assert_equal "", buffer
+  end
+
+  def test_decompress_into_unknown_size_grows_buffer
+    data = Random.new(1).bytes(200_000) + "x" * 3_000_000
+    frame = streamed_frame(data)
+    buffer = +""
+    assert_equal data.bytesize * 2, VibeZstd::DCtx.new.decompress_into(frame + frame, buffer)
+    assert_equal data + data, buffer
+  end
+
+  def test_decompress_into_limits_dictionaries_and_errors
+    dctx = VibeZstd::DCtx.new
+    buffer = +""
+    assert_raises(VibeZstd::DecompressedSizeExceeded) { dctx.decompress_into(VibeZstd.compress("a" * 5000), buffer, max_size: 1000) }
+    assert_raises(VibeZstd::DecompressedSizeExceeded) { dctx.decompress_into(streamed_frame("a" * 500_000), buffer, max_size: 1000) }
+
+    truncated = streamed_frame(Random.new(2).bytes(100_000))
+    error = assert_raises(RuntimeError) { dctx.decompress_into(truncated.byteslice(0, 50_000), buffer) }
+    assert_match(/Truncated/, error.message)
+
+    samples = 200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" }
+    dict_data = VibeZstd.train_dict(samples)
+    frame = streamed_frame(samples.join, dict: VibeZstd::CDict.new(dict_data))
+    assert_raises(ArgumentError) { dctx.decompress_into(frame, buffer) }
+    dctx.decompress_into(frame, buffer, dict: VibeZstd::DDict.new(dict_data))
+    assert_equal samples.join, buffer
+    # The dictionary does not stick to the context
+    assert_equal "plain", dctx.decompress(streamed_frame("plain"))
+
+    input = VibeZstd.compress("x")
+    assert_raises(FrozenError) { dctx.decompress_into(input, "frozen".freeze) }
+    assert_raises(ArgumentError) { dctx.decompress_into(input, input) }
+  end
 end
@@ -2,6 +2,7 @@
 
 require "test_helper"
 require "stringio"
+require "tmpdir"
 
 class TestDict < Minitest::Test
   # CDict and DDict construction and basic usage
@@ -273,4 +274,61 @@ class TestDict < Minitest::Test
     # The key assertion is implicit: reaching this line without a crash means
     # no heap overflow occurred.
   end
+
+  def test_dictionary_by_reference
+    samples = 50.times.map { |i| "sample #{i} with common pattern " * 4 }
+    dict_data = VibeZstd.train_dict(samples, max_dict_size: 2048)
+    data = "sample 7 with common pattern " * 8
+
+    cdict = VibeZstd::CDict.new(dict_data.dup, 5, by_reference: true)
+    ddict = VibeZstd::DDict.new(dict_data.dup, by_reference: true)
+    assert cdict.by_reference?
+    assert ddict.by_reference?
+    refute VibeZstd::CDict.new(dict_data).by_reference?
+    assert_equal VibeZstd::CDict.new(dict_data).dict_id, cdict.dict_id
+
+    # The dictionaries must keep their content alive and in place
+    GC.start
+    GC.compact if GC.respond_to?(:compact)
+    compressed = VibeZstd.compress(data, dict: cdict)
+    assert_equal data, VibeZstd.decompress(compressed, dict: ddict)
+    assert_equal data, VibeZstd.decompress(compressed, dict: cdict.to_ddict)
+    assert cdict.to_ddict.by_reference?
+
+    # Changing the caller's String afterwards does not affect the dictionary
+    source = dict_data.dup
+    pinned = VibeZstd::DDict.new(source, by_reference: true)
+    source.replace("x" * source.bytesize)
+    assert_equal data, VibeZstd.decompress(compressed, dict: pinned)
+
+    assert_raises(TypeError) do
+      VibeZstd::DDict.new(IO::Buffer.for(dict_data), by_reference: true)
+    end
+  end
+
+  def test_dictionary_open
+    samples = 50.times.map { |i| "sample #{i} with common pattern " * 4 }
+    dict_data = VibeZstd.train_dict(samples, max_dict_size: 2048)
+    data = "sample 7 with common pattern " * 8
+
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, "dict.zdict")
+      File.binwrite(path, dict_data)
+
+      cdict = VibeZstd::CDict.open(path, level: 9)
+      ddict = VibeZstd::DDict.open(path)
+      assert cdict.by_reference?
+      assert_equal VibeZstd.get_dict_id(dict_data), ddict.dict_id
+      assert_equal VibeZstd::CDict.open(path, 9).dict_id, cdict.dict_id
+
+      compressed = VibeZstd.compress(data, dict: cdict)
+      assert_equal data, VibeZstd.decompress(compressed, dict: ddict)
+      assert_equal data, VibeZstd.decompress(compressed, dict: cdict.to_ddict)
+      assert_equal data, VibeZstd.decompress(compressed, dict: VibeZstd::DDict.new(dict_data))
+
+      File.binwrite(File.join(dir, "empty"), "")
+      assert_raises(ArgumentError) { VibeZstd::DDict.open(File.join(dir, "empty")) }
+      assert_raises(Errno::ENOENT) { VibeZstd::CDict.open(File.join(dir, "missing")) }
+    end
+  end
 end
@@ -0,0 +1,76 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "stringio"
+
+class TestDictArena < Minitest::Test
+  def setup
+    samples = 100.times.map { |i| "sample #{i} with common pattern #{i * 7} " * 4 }
+    @dict_data = VibeZstd.train_dict(samples, max_dict_size: 8192)
+    @data = "sample 42 with common pattern 294 " * 8
+  end
+
+  def test_round_trip
+    arena = VibeZstd::DictArena.new(4 * 1024 * 1024)
+    cdict = arena.cdict(@dict_data, 9)
+    ddict = arena.ddict(@dict_data)
+    assert_equal 2, arena.size
+    assert_equal VibeZstd::DictArena.cdict_size(@dict_data.bytesize, 9) +
+      VibeZstd::DictArena.ddict_size(@dict_data.bytesize), arena.used
+    assert_equal VibeZstd.get_dict_id(@dict_data), cdict.dict_id
+    assert_equal cdict.dict_id, ddict.dict_id
+
+    compressed = VibeZstd.compress(@data, dict: cdict)
+    assert_equal @data, VibeZstd.decompress(compressed, dict: ddict)
+    assert_equal @data, VibeZstd.decompress(compressed, dict: VibeZstd::DDict.new(@dict_data))
+    assert_equal @data, VibeZstd.decompress(VibeZstd.compress(@data, dict: VibeZstd::CDict.new(@dict_data)), dict: ddict)
+  end
+
+  def test_seal
+    arena = VibeZstd::DictArena.new(1024 * 1024)
+    cdict = arena.cdict(@dict_data)
+    ddict = arena.ddict(@dict_data)
+    refute arena.sealed?
+    assert_same arena, arena.seal
+    assert arena.sealed?
+
+    # Read-only pages are enough to compress, decompress and stream
+    compressed = VibeZstd.compress(@data, dict: cdict)
+    assert_equal @data, VibeZstd.decompress(compressed, dict: ddict)
+    assert_equal @data, VibeZstd::DecompressReader.new(StringIO.new(compressed), dict: ddict).read
+    assert_equal @data, VibeZstd.decompress(compressed, dict: VibeZstd::DictionaryRegistry.new([ddict]))
+    assert_raises(RuntimeError) { arena.ddict(@dict_data) }
+  end
+
+  def test_full
+    arena = VibeZstd::DictArena.new(VibeZstd::DictArena.ddict_size(@dict_data.bytesize))
+    arena.ddict(@dict_data) while arena.capacity - arena.used >= VibeZstd::DictArena.ddict_size(@dict_data.bytesize)
+    error = assert_raises(RuntimeError) { arena.ddict(@dict_data) }
+    assert_match(/full/, error.message)
+    assert_raises(ArgumentError) { VibeZstd::DictArena.new(0) }
+  end
+
+  def test_dictionaries_keep_arena_alive
+    cdict = VibeZstd::DictArena.new(1024 * 1024).cdict(@dict_data)
+    GC.start
+    GC.compact if GC.respond_to?(:compact)
+    compressed = VibeZstd.compress(@data, dict: cdict)
+    assert_equal @data, VibeZstd.decompress(compressed, dict: VibeZstd::DDict.new(@dict_data))
+  end
+
+  def test_forked_workers
+    skip "fork not available" unless Process.respond_to?(:fork)
+    arena = VibeZstd::DictArena.new(1024 * 1024)
+    cdict = arena.cdict(@dict_data)
+    ddict = arena.ddict(@dict_data)
+    arena.seal
+
+    pids = 2.times.map do
+      fork do
+        ok = VibeZstd.decompress(VibeZstd.compress(@data, dict: cdict), dict: ddict) == @data
+        exit!(ok ? 0 : 1)
+      end
+    end
+    pids.each { |pid| assert Process.wait2(pid)[1].success? }
+  end
+end
@@ -0,0 +1,144 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "json"
+require "stringio"
+
+class TestDictionaryRegistry < Minitest::Test
+  def setup
+    @dicts = %w[user product order].map do |type|
+      samples = 50.times.map { |i| {id: i, type: type, "#{type}_name": "#{type} #{i}"}.to_json }
+      VibeZstd.train_dict(samples, max_dict_size: 2048)
+    end
+    @cdicts = @dicts.map { |data| VibeZstd::CDict.new(data) }
+    @registry = VibeZstd::DictionaryRegistry.new(@dicts.map { |data| VibeZstd::DDict.new(data) })
+    @payloads = %w[user product order].map { |type| {id: 7, type: type, "#{type}_name": "#{type} 7"}.to_json }
+  end
+
+  def test_lookup
+    assert_equal 3, @registry.size
+    assert_equal @cdicts.map(&:dict_id).sort, @registry.dict_ids
+    assert_equal @cdicts[1].dict_id, @registry[@cdicts[1].dict_id].dict_id
+    assert_nil @registry[12345]
+    assert_raises(ArgumentError) { @registry.add(VibeZstd::DDict.new("raw content, no header" * 10)) }
+  end
+
+  def test_decompress_selects_dictionary
+    @payloads.zip(@cdicts).each do |payload, cdict|
+      frame = VibeZstd.compress(payload, dict: cdict)
+      assert_equal payload, VibeZstd::DCtx.new.decompress(frame, dict: @registry)
+      assert_equal payload, VibeZstd.decompress(frame, dict: @registry)
+      assert_equal payload, VibeZstd::Pool.new.decompress(frame, dict: @registry)
+    end
+    assert_equal "plain", VibeZstd.decompress(VibeZstd.compress("plain"), dict: @registry)
+  end
+
+  def test_decompress_mixed_dictionaries
+    blob = @payloads.zip(@cdicts).map { |payload, cdict| VibeZstd.compress(payload, dict: cdict) }.join
+    blob += VibeZstd.compress("no dictionary")
+    expected = @payloads.join + "no dictionary"
+    assert_equal expected, VibeZstd::DCtx.new.decompress(blob, dict: @registry)
+    assert_raises(VibeZstd::DecompressedSizeExceeded) do
+      VibeZstd::DCtx.new.decompress(blob, dict: @registry, max_decompressed_size: expected.bytesize - 1)
+    end
+    # Paths that decode with a single dictionary reject the mix
+    assert_raises(ArgumentError) { VibeZstd::DCtx.new.decompress_into(blob, +"", dict: @registry) }
+  end
+
+  def test_batches_mix_dictionaries_across_entries
+    frames = @payloads.zip(@cdicts).map { |payload, cdict| VibeZstd.compress(payload, dict: cdict) }
+    # Unknown content size takes the streaming path
+    io = StringIO.new(+"".b)
+    VibeZstd::CompressWriter.open(io, dict: @cdicts[1]) { |writer| writer.write(@payloads[1]) }
+    frames << io.string << VibeZstd.compress("no dictionary")
+    expected = @payloads + [@payloads[1], "no dictionary"]
+
+    assert_equal expected, VibeZstd::DCtx.new.decompress_batch(frames, dict: @registry)
+    assert_equal expected, VibeZstd.decompress_many(frames, dict: @registry, threads: 2)
+    assert_equal expected.reverse, VibeZstd.decompress_many(frames.reverse, dict: @registry, threads: 1)
+
+    # Frames within one entry still have to share a dictionary
+    mixed = frames[0] + frames[1]
+    assert_raises(ArgumentError) { VibeZstd::DCtx.new.decompress_batch([frames[2], mixed], dict: @registry) }
+    assert_raises(ArgumentError) { VibeZstd.decompress_many([frames[2], mixed], dict: @registry) }
+  end
+
+  def test_unknown_dict_id
+    other = VibeZstd.train_dict(50.times.map { |i| "other sample #{i} " * 4 }, max_dict_size: 2048)
+    frame = VibeZstd.compress("data", dict: VibeZstd::CDict.new(other))
+    error = assert_raises(ArgumentError) { VibeZstd.decompress(frame, dict: @registry) }
+    assert_match(/No dictionary registered/, error.message)
+  end
+
+  def test_decompress_reader
+    io = StringIO.new(+"".b)
+    @payloads.zip(@cdicts).each do |payload, cdict|
+      VibeZstd::CompressWriter.open(io, dict: cdict) { |writer| writer.write(payload) }
+    end
+    io.rewind
+    assert_equal @payloads.join, VibeZstd::DecompressReader.new(io, dict: @registry).read(1_000_000)
+
+    io.rewind
+    assert_equal @payloads.join, VibeZstd::DecompressReader.new(io, dict: @registry, readahead: 2).read(1_000_000)
+    assert_raises(ArgumentError) { VibeZstd::DecompressReader.new(io, dict: @registry, threads: 2) }
+  end
+
+  def test_reader_keeps_snapshot
+    frame = VibeZstd.compress(@payloads[0], dict: @cdicts[0])
+    reader = VibeZstd::DecompressReader.new(StringIO.new(frame), dict: @registry)
+    @registry.delete(@cdicts[0].dict_id)
+    GC.start
+    assert_equal @payloads[0], reader.read
+  end
+
+  def test_decode_survives_concurrent_prune
+    # DDicts the registry builds from Strings have no other owner, so a decode
+    # running without the GVL must keep the one it picked alive itself
+    payload = (@payloads[0] * 200_000).b
+    frame = VibeZstd.compress(payload, dict: @cdicts[0])
+    registry = VibeZstd::DictionaryRegistry.new
+    dict_id = @cdicts[0].dict_id
+    done = false
+    churn = Thread.new do
+      until done
+        registry.add(@dicts[0], name: "tenant")
+        registry.add(@dicts[1], name: "tenant")
+        registry.prune
+        registry.delete(@cdicts[1].dict_id)
+        GC.start
+      end
+    end
+    decoded = 0
+    10.times do
+      registry.add(@dicts[0]) unless registry[dict_id]
+      result = VibeZstd::DCtx.new.decompress(frame, dict: registry)
+      assert_equal payload.bytesize, result.bytesize
+      assert_equal payload, result
+      decoded += 1
+    rescue ArgumentError => e
+      # The churn thread dropped the dictionary before the frame was inspected
+      assert_match(/No dictionary registered/, e.message)
+    end
+    done = true
+    churn.join
+    assert_operator decoded, :>, 0
+  end
+
+  def test_versions_and_prune
+    registry = VibeZstd::DictionaryRegistry.new
+    v1 = registry.add(@dicts[0], name: "tenant")
+    v2 = registry.add(@dicts[1], name: "tenant")
+    assert_equal v2.dict_id, registry.current("tenant").dict_id
+    assert registry.retired?(v1.dict_id)
+    refute registry.retired?(v2.dict_id)
+
+    # A retired version still decodes, and using it keeps it past prune(idle:)
+    frame = VibeZstd.compress(@payloads[0], dict: @cdicts[0])
+    assert_equal @payloads[0], VibeZstd.decompress(frame, dict: registry)
+    assert_empty registry.prune(idle: 3600)
+    assert_equal [v1.dict_id], registry.prune
+    assert_equal [v2.dict_id], registry.dict_ids
+    assert_equal v2.dict_id, registry.current("tenant").dict_id
+    assert_nil registry.current("other")
+  end
+end
@@ -0,0 +1,172 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "stringio"
+
+class TestFiberScheduler < Minitest::Test
+  # Minimal Fiber scheduler: runs fibers on one thread, waits for IO with
+  # IO.select, and runs offloaded blocking operations (Ruby 3.4+) on a thread
+  # of their own while the calling fiber waits on a pipe.
+  class SelectScheduler
+    attr_reader :offloaded
+
+    def initialize
+      @readable = {}
+      @writable = {}
+      @sleeping = {}
+      @ready = []
+      @offloaded = 0
+    end
+
+    def fiber(&block)
+      fiber = Fiber.new(blocking: false, &block)
+      fiber.resume
+      fiber
+    end
+
+    def io_wait(io, events, _timeout)
+      @readable[io] = Fiber.current if events.anybits?(IO::READABLE)
+      @writable[io] = Fiber.current if events.anybits?(IO::WRITABLE)
+      Fiber.yield
+      events
+    ensure
+      @readable.delete(io)
+      @writable.delete(io)
+    end
+
+    def kernel_sleep(duration = nil)
+      @sleeping[Fiber.current] = now + duration if duration
+      Fiber.yield
+    ensure
+      @sleeping.delete(Fiber.current)
+    end
+
+    def block(_blocker, timeout = nil)
+      kernel_sleep(timeout)
+    end
+
+    def unblock(_blocker, fiber)
+      @ready << fiber
+    end
+
+    def blocking_operation_wait(work)
+      @offloaded += 1
+      done, signal = IO.pipe
+      thread = Thread.new do
+        work.call
+      ensure
+        signal.close
+      end
+      done.wait_readable
+      Fiber.blocking { thread.join }
+    ensure
+      done.close
+    end
+
+    def run
+      until @readable.empty? && @writable.empty? && @sleeping.empty? && @ready.empty?
+        deadline = @sleeping.values.min
+        timeout = deadline && [deadline - now, 0].max
+        timeout = 0 unless @ready.empty?
+        readable, writable = IO.select(@readable.keys, @writable.keys, [], timeout)
+        resume = @ready.shift(@ready.size)
+        resume.concat(readable.map { |io| @readable[io] }) if readable
+        resume.concat(writable.map { |io| @writable[io] }) if writable
+        resume.concat(@sleeping.select { |_fiber, wake| wake <= now }.keys)
+        resume.uniq.each { |fiber| fiber.resume if fiber.alive? }
+      end
+    end
+
+    def close
+      run
+    end
+
+    private
+
+    def now
+      Process.clock_gettime(Process::CLOCK_MONOTONIC)
+    end
+  end
+
+  # Run block on a fresh thread with a SelectScheduler, then run the fibers
+  # it scheduled to completion
+  def run_scheduled
+    scheduler = SelectScheduler.new
+    Thread.new do
+      Fiber.set_scheduler(scheduler)
+      yield scheduler
+      scheduler.run
+    end.join(30) || flunk("scheduled fibers did not finish")
+    scheduler
+  end
+
+  def setup
+    # Incompressible, so the frames are larger than a pipe's buffer
+    @data = Random.new(25).bytes(1 << 20)
+  end
+
+  def test_writer_waits_for_pipe_through_scheduler
+    compressed = +""
+    ticks = 0
+    run_scheduled do
+      reader, writer = IO.pipe
+      Fiber.schedule do
+        VibeZstd::CompressWriter.open(writer, level: 1) { |zstd| 4.times { zstd.write(@data) } }
+        writer.close
+      end
+      Fiber.schedule do
+        while (chunk = reader.read(16 * 1024))
+          compressed << chunk
+          ticks += 1
+        end
+        reader.close
+      end
+    end
+
+    # The writer suspended on the full pipe, and the other fiber drained it
+    assert_operator ticks, :>, 4
+    assert_equal @data * 4, VibeZstd.decompress(compressed)
+  end
+
+  def test_reader_waits_for_pipe_through_scheduler
+    compressed = VibeZstd.compress(@data * 2)
+    [{}, {readahead: 4}].each do |options|
+      result = +""
+      run_scheduled do
+        reader, writer = IO.pipe
+        Fiber.schedule do
+          zstd = VibeZstd::DecompressReader.new(reader, **options)
+          while (chunk = zstd.read(256 * 1024))
+            result << chunk
+          end
+          reader.close
+        end
+        Fiber.schedule do
+          0.step(compressed.bytesize - 1, 32 * 1024) { |offset| writer.write(compressed.byteslice(offset, 32 * 1024)) }
+          writer.close
+        end
+      end
+      assert_equal @data * 2, result, "options: #{options}"
+    end
+  end
+
+  def test_large_steps_are_offloaded
+    skip "rb_nogvl offloading needs Ruby 3.4" if RUBY_VERSION < "3.4"
+    compressed = VibeZstd.compress(@data)
+    scheduler = run_scheduled do
+      Fiber.schedule do
+        VibeZstd::CompressWriter.open(StringIO.new, level: 1) { |zstd| zstd.write(@data) }
+        VibeZstd::DecompressReader.new(StringIO.new(compressed)).read(@data.bytesize)
+      end
+    end
+    assert_operator scheduler.offloaded, :>=, 2
+
+    # Small steps stay on the fiber's thread
+    scheduler = run_scheduled do
+      Fiber.schedule do
+        VibeZstd::CompressWriter.open(StringIO.new) { |zstd| zstd.write("small") }
+      end
+    end
+    assert_equal 0, scheduler.offloaded
+  end
+end
@@ -0,0 +1,99 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "tmpdir"
+
+class TestFiles < Minitest::Test
+  def setup
+    @dir = Dir.mktmpdir("vibe_zstd")
+    @src = File.join(@dir, "data.txt")
+    @zst = File.join(@dir, "data.txt.zst")
+    @out = File.join(@dir, "data.out")
+    # Larger than one 1MB chunk so the read loop runs several times
+    @data = (0...60_000).map { |i| "line #{i} #{i * 7919 % 1000}\n" }.join.b
+    File.binwrite(@src, @data)
+  end
+
+  def teardown
+    FileUtils.remove_entry(@dir)
+  end
+
+  def test_round_trip
+    size = VibeZstd.compress_file(@src, @zst, level: 3)
+    assert_equal File.size(@zst), size
+    assert_equal @data.bytesize, VibeZstd.frame_content_size(File.binread(@zst))
+
+    assert_equal @data.bytesize, VibeZstd.decompress_file(@zst, @out)
+    assert_equal @data, File.binread(@out)
+  end
+
+  def test_output_matches_in_memory_decompress
+    VibeZstd.compress_file(@src, @zst, checksum_flag: 1)
+    assert_equal @data, VibeZstd.decompress(File.binread(@zst))
+  end
+
+  def test_workers
+    VibeZstd.compress_file(@src, @zst, workers: 2)
+    assert_equal @data, VibeZstd.decompress(File.binread(@zst))
+  end
+
+  def test_context_reuse_and_overwrite
+    cctx = VibeZstd::CCtx.new
+    dctx = VibeZstd::DCtx.new
+    File.binwrite(@out, "stale contents that must be truncated" * 100_000)
+    2.times do
+      cctx.compress_file(@src, @zst)
+      dctx.decompress_file(@zst, @out)
+      assert_equal @data, File.binread(@out)
+    end
+    assert_equal @data, cctx.compress(@data).then { |frame| dctx.decompress(frame) }
+  end
+
+  def test_dictionary
+    samples = 200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" }
+    dict = VibeZstd.train_dict(samples)
+    File.binwrite(@src, samples.join("\n"))
+    VibeZstd.compress_file(@src, @zst, dict: VibeZstd::CDict.new(dict))
+    VibeZstd.decompress_file(@zst, @out, dict: VibeZstd::DDict.new(dict))
+    assert_equal samples.join("\n"), File.binread(@out)
+  end
+
+  def test_concatenated_frames
+    File.binwrite(@zst, VibeZstd.compress("first ") + VibeZstd.compress("second"))
+    VibeZstd.decompress_file(@zst, @out)
+    assert_equal "first second", File.binread(@out)
+  end
+
+  def test_max_size
+    VibeZstd.compress_file(@src, @zst)
+    assert_raises(VibeZstd::DecompressedSizeExceeded) do
+      VibeZstd.decompress_file(@zst, @out, max_size: 1000)
+    end
+    refute File.exist?(@out)
+  end
+
+  def test_truncated_input_removes_destination
+    VibeZstd.compress_file(@src, @zst)
+    File.binwrite(@zst, File.binread(@zst)[0, 1000])
+    error = assert_raises(RuntimeError) { VibeZstd.decompress_file(@zst, @out) }
+    assert_match(/Truncated/, error.message)
+    refute File.exist?(@out)
+  end
+
+  def test_missing_source
+    assert_raises(Errno::ENOENT) { VibeZstd.compress_file(File.join(@dir, "missing"), @zst) }
+    refute File.exist?(@zst)
+  end
+
+  def test_same_file
+    assert_raises(ArgumentError) { VibeZstd.compress_file(@src, @src) }
+    assert_equal @data, File.binread(@src)
+  end
+
+  def test_accepts_pathname
+    require "pathname"
+    VibeZstd.compress_file(Pathname(@src), Pathname(@zst))
+    VibeZstd.decompress_file(Pathname(@zst), Pathname(@out))
+    assert_equal @data, File.binread(@out)
+  end
+end
@@ -0,0 +1,91 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "stringio"
+require "tempfile"
+
+class TestIOBuffer < Minitest::Test
+  def setup
+    skip "IO::Buffer input requires Ruby 3.2+" if RUBY_VERSION < "3.2"
+    @experimental = Warning[:experimental]
+    Warning[:experimental] = false
+  end
+
+  def teardown
+    Warning[:experimental] = @experimental unless @experimental.nil?
+  end
+
+  def data
+    @data ||= "io buffer payload " * 5_000
+  end
+
+  def test_compress_and_decompress_accept_io_buffer
+    frame = VibeZstd.compress(data)
+    assert_equal frame, VibeZstd::CCtx.new.compress(IO::Buffer.for(data))
+    assert_equal data, VibeZstd::DCtx.new.decompress(IO::Buffer.for(frame))
+    assert_equal data, VibeZstd.decompress(IO::Buffer.for(frame), max_size: data.bytesize)
+  end
+
+  def test_decompress_memory_mapped_file
+    Tempfile.create("vibe_zstd") do |file|
+      file.write(VibeZstd.compress(data) * 4)
+      file.flush
+      mapped = IO::Buffer.map(file, nil, 0, IO::Buffer::READONLY)
+
+      assert_equal data * 4, VibeZstd::DCtx.new.decompress(mapped)
+      assert_equal data * 4, VibeZstd::DCtx.new.decompress(mapped, threads: 2)
+      assert_equal data.bytesize, VibeZstd.frame_content_size(mapped)
+    ensure
+      mapped&.free
+    end
+  end
+
+  def test_decompress_into_io_buffer
+    frame = VibeZstd.compress(data)
+    out = IO::Buffer.new(data.bytesize + 100)
+    assert_equal data.bytesize, VibeZstd::DCtx.new.decompress_into(IO::Buffer.for(frame), out)
+    assert_equal data, out.get_string(0, data.bytesize)
+
+    # Frames without a declared size decode into the fixed buffer too
+    io = StringIO.new(+"".b)
+    VibeZstd::CompressWriter.open(io) { |w| w.write(data) }
+    assert_equal data.bytesize, VibeZstd::DCtx.new.decompress_into(io.string, out)
+
+    small = IO::Buffer.new(100)
+    assert_raises(ArgumentError) { VibeZstd::DCtx.new.decompress_into(frame, small) }
+    assert_raises(ArgumentError) { VibeZstd::DCtx.new.decompress_into(io.string, small) }
+    assert_raises(VibeZstd::DecompressedSizeExceeded) { VibeZstd::DCtx.new.decompress_into(io.string, out, max_size: 1000) }
+    assert_raises(IO::Buffer::AccessError) { VibeZstd::DCtx.new.decompress_into(frame, IO::Buffer.for(data)) }
+  end
+
+  def test_compress_into_io_buffer
+    out = IO::Buffer.new(VibeZstd.compress_bound(data.bytesize))
+    size = VibeZstd::CCtx.new.compress_into(IO::Buffer.for(data), out)
+    assert_equal data, VibeZstd.decompress(out.get_string(0, size))
+    assert_raises(ArgumentError) { VibeZstd::CCtx.new.compress_into(Random.new(1).bytes(5000), IO::Buffer.new(100)) }
+  end
+
+  def test_compress_writer_accepts_io_buffer
+    io = StringIO.new(+"".b)
+    buffer = IO::Buffer.for(data)
+    VibeZstd::CompressWriter.open(io) { |w| w.write(buffer) }
+    assert_equal data, VibeZstd.decompress(io.string)
+    refute buffer.locked?
+  end
+
+  def test_dictionaries_and_frame_utilities_accept_io_buffer
+    samples = 200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" }
+    dict = IO::Buffer.for(VibeZstd.train_dict(samples))
+    cdict = VibeZstd::CDict.new(dict)
+    ddict = VibeZstd::DDict.new(dict)
+    assert_equal VibeZstd.get_dict_id(dict), cdict.dict_id
+    frame = VibeZstd.compress(samples.first, dict: cdict)
+    assert_equal cdict.dict_id, VibeZstd.get_dict_id_from_frame(IO::Buffer.for(frame))
+    assert_equal samples.first, VibeZstd.decompress(IO::Buffer.for(frame), dict: ddict)
+
+    blob = VibeZstd.write_skippable_frame(IO::Buffer.for("meta"), magic_number: 3) + frame
+    assert VibeZstd.skippable_frame?(IO::Buffer.for(blob))
+    assert_equal ["meta", 3], VibeZstd.read_skippable_frame(IO::Buffer.for(blob))
+    assert_equal [["meta", 3, 0]], VibeZstd.each_skippable_frame(IO::Buffer.for(blob)).to_a
+  end
+end
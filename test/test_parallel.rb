@@ -0,0 +1,225 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "stringio"
+
+class TestParallel < Minitest::Test
+  def payloads(count = 200)
+    count.times.map { |i| "payload #{i} " + ("lorem ipsum dolor sit amet " * (i % 37 + 1)) }
+  end
+
+  def test_compress_many_matches_sequential_compression
+    inputs = payloads
+    expected = inputs.map { |s| VibeZstd.compress(s, level: 5) }
+    assert_equal expected, VibeZstd.compress_many(inputs, threads: 4, level: 5)
+  end
+
+  def test_decompress_many_preserves_order
+    inputs = payloads
+    frames = VibeZstd.compress_many(inputs, threads: 3)
+    assert_equal inputs, VibeZstd.decompress_many(frames, threads: 3)
+  end
+
+  def test_single_thread_and_default_thread_count
+    inputs = payloads(20)
+    frames = VibeZstd.compress_many(inputs, threads: 1)
+    assert_equal inputs, VibeZstd.decompress_many(frames)
+  end
+
+  def test_more_threads_than_payloads
+    inputs = ["one", "two"]
+    assert_equal inputs, VibeZstd.decompress_many(VibeZstd.compress_many(inputs, threads: 16), threads: 16)
+  end
+
+  def test_empty_array
+    assert_equal [], VibeZstd.compress_many([])
+    assert_equal [], VibeZstd.decompress_many([])
+  end
+
+  def test_shared_dictionary
+    samples = 200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\",\"active\":true}" }
+    dict_data = VibeZstd.train_dict(samples)
+    cdict = VibeZstd::CDict.new(dict_data)
+    ddict = VibeZstd::DDict.new(dict_data)
+
+    frames = VibeZstd.compress_many(samples, threads: 4, dict: cdict)
+    frames.each { |frame| assert_equal cdict.dict_id, VibeZstd.get_dict_id_from_frame(frame) }
+    assert_equal samples, VibeZstd.decompress_many(frames, threads: 4, dict: ddict)
+    assert_raises(ArgumentError) { VibeZstd.decompress_many(frames) }
+  end
+
+  def test_decompress_many_unknown_size_frames
+    frames = 10.times.map do |i|
+      io = StringIO.new
+      VibeZstd::CompressWriter.open(io) { |w| w.write("streamed #{i} " * 100) }
+      io.string
+    end
+    expected = 10.times.map { |i| "streamed #{i} " * 100 }
+    assert_equal expected, VibeZstd.decompress_many(frames, threads: 4)
+  end
+
+  def test_survives_compaction_during_setup
+    skip "GC.auto_compact not supported" unless GC.respond_to?(:auto_compact=)
+    # Small inputs and outputs are embedded Strings; with GC.stress every
+    # allocation while the jobs are set up compacts the heap and can move them
+    inputs = 50.times.map { |i| "entry #{i}" }
+    frames = VibeZstd.compress_many(inputs, threads: 2)
+    begin
+      GC.auto_compact = true
+      GC.stress = true
+      compressed = VibeZstd.compress_many(inputs, threads: 2)
+      decoded = VibeZstd.decompress_many(frames, threads: 2)
+    ensure
+      GC.stress = false
+      GC.auto_compact = false
+    end
+    assert_equal frames, compressed
+    assert_equal inputs, decoded
+  end
+
+  def test_decompress_many_enforces_max_size
+    frames = [VibeZstd.compress("small"), VibeZstd.compress("x" * 10_000)]
+    assert_raises(VibeZstd::DecompressedSizeExceeded) do
+      VibeZstd.decompress_many(frames, max_decompressed_size: 1000)
+    end
+  end
+
+  def test_decompress_many_reports_failing_index
+    frames = payloads(8).map { |s| VibeZstd.compress(s) }
+    frames[5] = frames[5].byteslice(0, frames[5].bytesize - 3)
+    error = assert_raises(RuntimeError) { VibeZstd.decompress_many(frames, threads: 2) }
+    assert_match(/index 5/, error.message)
+  end
+
+  def test_invalid_arguments
+    assert_raises(TypeError) { VibeZstd.compress_many("nope") }
+    assert_raises(TypeError) { VibeZstd.compress_many([1]) }
+    assert_raises(ArgumentError) { VibeZstd.compress_many(["a"], threads: 0) }
+    assert_raises(ArgumentError) { VibeZstd.compress_many(["a"], pledged_size: 1) }
+  end
+
+  def test_concurrent_callers_share_the_pool
+    inputs = payloads(100)
+    results = 4.times.map { Thread.new { VibeZstd.compress_many(inputs, threads: 4) } }.map(&:value)
+    expected = inputs.map { |s| VibeZstd.compress(s) }
+    results.each { |frames| assert_equal expected, frames }
+  end
+
+  # --- Multi-frame input -----------------------------------------------------
+
+  def multi_frame_blob(parts)
+    parts.map { |part| VibeZstd.compress(part) }.join
+  end
+
+  def streamed(data)
+    io = StringIO.new(+"".b)
+    VibeZstd::CompressWriter.open(io) { |w| w.write(data) }
+    io.string
+  end
+
+  def test_decompress_threads_known_size_frames
+    parts = payloads(64)
+    assert_equal parts.join, VibeZstd::DCtx.new.decompress(multi_frame_blob(parts), threads: 4)
+    assert_equal parts.join, VibeZstd.decompress(multi_frame_blob(parts), threads: 3)
+  end
+
+  def test_decompress_threads_mixed_sizes_and_skippable_frames
+    blob = VibeZstd.compress("known ") + VibeZstd.write_skippable_frame("meta") +
+      streamed("streamed " * 500) + VibeZstd.compress("") + streamed("tail")
+    assert_equal "known " + "streamed " * 500 + "tail", VibeZstd::DCtx.new.decompress(blob, threads: 4)
+  end
+
+  def test_decompress_threads_single_frame_and_seekable_input
+    assert_equal "single", VibeZstd::DCtx.new.decompress(VibeZstd.compress("single"), threads: 4)
+
+    data = payloads(300).join
+    io = StringIO.new(+"".b)
+    VibeZstd::SeekableWriter.open(io, frame_size: 4096) { |w| w.write(data) }
+    assert_equal data, VibeZstd::DCtx.new.decompress(io.string, threads: 4)
+  end
+
+  def test_decompress_threads_limits_and_errors
+    blob = multi_frame_blob(["a" * 600, "b" * 600])
+    assert_raises(VibeZstd::DecompressedSizeExceeded) { VibeZstd::DCtx.new.decompress(blob, threads: 2, max_size: 1000) }
+    streamed_blob = streamed("a" * 600) + streamed("b" * 600)
+    assert_raises(VibeZstd::DecompressedSizeExceeded) { VibeZstd::DCtx.new.decompress(streamed_blob, threads: 2, max_size: 1000) }
+    assert_raises(ArgumentError) { VibeZstd::DCtx.new.decompress(blob, threads: 0) }
+
+    corrupt = multi_frame_blob(payloads(4))
+    corrupt.setbyte(corrupt.bytesize - 5, corrupt.getbyte(corrupt.bytesize - 5) ^ 0xff)
+    error = assert_raises(RuntimeError) { VibeZstd::DCtx.new.decompress(corrupt, threads: 2) }
+    assert_match(/frame 3/, error.message)
+  end
+
+  def test_decompress_threads_with_dictionary
+    samples = 200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\",\"active\":true}" }
+    dict_data = VibeZstd.train_dict(samples)
+    cdict = VibeZstd::CDict.new(dict_data)
+    blob = samples.map { |s| VibeZstd.compress(s, dict: cdict) }.join
+    assert_equal samples.join, VibeZstd::DCtx.new.decompress(blob, threads: 4, dict: VibeZstd::DDict.new(dict_data))
+    assert_raises(ArgumentError) { VibeZstd::DCtx.new.decompress(blob, threads: 4) }
+  end
+
+  def test_decompress_reader_parallel_mode
+    parts = payloads(200)
+    blob = parts.map.with_index { |part, i| i.even? ? VibeZstd.compress(part) : streamed(part) }.join
+    reader = VibeZstd::DecompressReader.new(StringIO.new(blob), threads: 4)
+    out = +""
+    while (chunk = reader.read(3_000))
+      assert_operator chunk.bytesize, :<=, 3_000
+      out << chunk
+    end
+    assert_equal parts.join, out
+    assert reader.eof?
+  end
+
+  def test_decompress_reader_parallel_mode_line_reading_and_truncation
+    lines = 5_000.times.map { |i| "line #{i}\n" }
+    blob = lines.each_slice(100).map { |slice| VibeZstd.compress(slice.join) }.join
+    reader = VibeZstd::DecompressReader.new(StringIO.new(blob), threads: 2)
+    assert_equal lines, reader.each_line.to_a
+
+    truncated = VibeZstd::DecompressReader.new(StringIO.new(blob.byteslice(0, blob.bytesize - 4)), threads: 2)
+    assert_raises(RuntimeError) { truncated.read_all }
+    assert_raises(ArgumentError) { VibeZstd::DecompressReader.new(StringIO.new(blob), threads: 0) }
+  end
+
+  def test_decompress_reader_parallel_mode_streams_large_frames
+    # A single frame larger than the input cap streams instead of being
+    # buffered whole
+    data = Random.new(7).bytes(40 << 20)
+    big = VibeZstd.compress(data, level: 1)
+    io = StringIO.new(big)
+    reader = VibeZstd::DecompressReader.new(io, threads: 2)
+    assert_equal data.byteslice(0, 100), reader.read(100)
+    assert_operator io.pos, :<, big.bytesize
+    assert_equal data.byteslice(100..), reader.read_all
+
+    # Groups of small frames around it still decode, before and after
+    parts = payloads(50)
+    small = parts.map { |part| VibeZstd.compress(part) }
+    skippable = [0x184D2A50, 3].pack("VV") + "abc"
+    blob = small[0, 25].join + big + skippable + streamed(parts[25]) + small[26..].join
+    reader = VibeZstd::DecompressReader.new(StringIO.new(blob), threads: 2)
+    assert_equal parts[0, 25].join + data + parts[25..].join, reader.read_all
+
+    assert_raises(RuntimeError) do
+      VibeZstd::DecompressReader.new(StringIO.new(big.byteslice(0, big.bytesize - 100)), threads: 2).read_all
+    end
+  end
+
+  def test_decompress_reader_parallel_mode_corrupt_input
+    # Bad magic is reported at once, not after buffering the rest of the stream
+    io = StringIO.new("not zstd at all".b + ("\0".b * (8 << 20)))
+    reader = VibeZstd::DecompressReader.new(io, threads: 2)
+    error = assert_raises(RuntimeError) { reader.read(100) }
+    assert_match(/Unknown frame descriptor/, error.message)
+    assert_operator io.pos, :<, 8 << 20
+
+    # Frames ahead of the corruption are still served
+    good = VibeZstd.compress("good frame ")
+    reader = VibeZstd::DecompressReader.new(StringIO.new(good * 3 + "junk" * 100), threads: 2)
+    assert_equal "good frame " * 3, reader.read(33)
+    assert_raises(RuntimeError) { reader.read(1) }
+  end
+end
@@ -0,0 +1,92 @@
+# frozen_string_literal: true
+
+require "test_helper"
+
+class TestPool < Minitest::Test
+  def setup
+    @data = "pooled context payload " * 1_000
+  end
+
+  def test_round_trip_with_per_call_options
+    pool = VibeZstd::Pool.new
+    frame = pool.compress(@data, level: 19)
+    assert_equal VibeZstd.compress(@data, level: 19), frame
+    assert_equal @data, pool.decompress(frame, max_size: @data.bytesize)
+    assert_raises(VibeZstd::DecompressedSizeExceeded) { pool.decompress(frame, max_size: 10) }
+  end
+
+  def test_contexts_are_reused
+    pool = VibeZstd::Pool.new
+    5.times { pool.decompress(pool.compress(@data)) }
+    stats = pool.stats
+    assert_equal 1, stats[:compression_contexts_created]
+    assert_equal 1, stats[:decompression_contexts_created]
+    assert_equal 1, stats[:idle_compression_contexts]
+    assert_equal 0, stats[:compression_contexts_in_use]
+  end
+
+  def test_dictionaries_share_contexts
+    samples = 200.times.map { |i| "{\"id\":#{i},\"kind\":\"k#{i % 7}\"}" }
+    dicts = 3.times.map { |i| VibeZstd.train_dict(samples.rotate(i * 11)) }
+    pool = VibeZstd::Pool.new
+    dicts.each do |dict|
+      frame = pool.compress(samples.first, dict: VibeZstd::CDict.new(dict))
+      assert_equal samples.first, pool.decompress(frame, dict: VibeZstd::DDict.new(dict))
+    end
+    assert_equal samples.first, pool.decompress(pool.compress(samples.first))
+    assert_equal 1, pool.stats[:compression_contexts_created]
+    assert_equal 1, pool.stats[:decompression_contexts_created]
+  end
+
+  def test_max_idle_bounds_retained_contexts
+    pool = VibeZstd::Pool.new(max_idle: 2)
+    pool.with_cctx do
+      pool.with_cctx do
+        pool.with_cctx do
+          assert_equal 3, pool.stats[:compression_contexts_in_use]
+        end
+      end
+    end
+    stats = pool.stats
+    assert_equal 3, stats[:compression_contexts_created]
+    assert_equal 2, stats[:idle_compression_contexts]
+    assert_equal 0, stats[:compression_contexts_in_use]
+
+    pool.clear
+    assert_equal 0, pool.stats[:idle_compression_contexts]
+  end
+
+  def test_context_params
+    pool = VibeZstd::Pool.new(cctx_params: {checksum_flag: 1}, dctx_params: {max_decompressed_size: 100})
+    frame = pool.compress(@data)
+    assert pool.with_cctx { |cctx| cctx.checksum_flag }
+    assert_raises(VibeZstd::DecompressedSizeExceeded) { pool.decompress(frame) }
+    assert_raises(NoMethodError) { VibeZstd::Pool.new(cctx_params: {no_such_param: 1}) }
+  end
+
+  def test_context_returned_when_call_raises
+    pool = VibeZstd::Pool.new
+    assert_raises(RuntimeError) { pool.decompress("not a zstd frame") }
+    assert_raises(ArgumentError) { pool.with_dctx { raise ArgumentError } }
+    assert_equal 0, pool.stats[:decompression_contexts_in_use]
+    assert_equal 1, pool.stats[:idle_decompression_contexts]
+  end
+
+  def test_concurrent_use
+    pool = VibeZstd::Pool.new(max_idle: 4)
+    threads = 8.times.map do |i|
+      Thread.new do
+        payload = @data * (i + 1)
+        20.times { assert_equal payload, pool.decompress(pool.compress(payload)) }
+      end
+    end
+    threads.each(&:join)
+    assert_equal 0, pool.stats[:compression_contexts_in_use]
+    assert_operator pool.stats[:idle_compression_contexts], :<=, 4
+  end
+
+  def test_default_pool
+    assert_same VibeZstd::Pool.default, VibeZstd::Pool.default
+    assert_equal @data, VibeZstd::Pool.default.decompress(VibeZstd::Pool.default.compress(@data))
+  end
+end
@@ -0,0 +1,94 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "stringio"
+
+class TestPreload < Minitest::Test
+  # Large enough for zstd to hand the frame to its worker threads
+  DATA = (Random.new(42).bytes(1000).unpack1("H*") * 1500).freeze
+
+  def setup
+    skip "fork not available" unless Process.respond_to?(:fork)
+  end
+
+  # Run the block in a forked child; a child stuck waiting for worker threads
+  # that did not survive fork is killed and fails the test
+  def assert_in_child(timeout: 20)
+    pid = fork do
+      ok = begin
+        yield
+      rescue
+        false
+      end
+      exit!(ok ? 0 : 1)
+    end
+    deadline = Process.clock_gettime(Process::CLOCK_MONOTONIC) + timeout
+    until (status = Process.wait2(pid, Process::WNOHANG)&.last)
+      if Process.clock_gettime(Process::CLOCK_MONOTONIC) > deadline
+        Process.kill(:KILL, pid)
+        Process.wait(pid)
+        flunk "child hung"
+      end
+      sleep 0.02
+    end
+    assert status.success?, "child failed: #{status.inspect}"
+  end
+
+  def test_workers_started_before_fork
+    cctx = VibeZstd::CCtx.new(workers: 2)
+    cctx.compress(DATA)
+    assert_in_child { VibeZstd.decompress(cctx.compress(DATA)) == DATA && cctx.workers == 2 }
+    assert_in_child { cctx.memory_size > 0 }
+    assert_equal DATA, VibeZstd.decompress(cctx.compress(DATA))
+  end
+
+  def test_thread_pools_after_fork
+    pool = VibeZstd::ThreadPool.new(2)
+    shared = VibeZstd::CCtx.new(workers: 2, thread_pool: pool)
+    shared.compress(DATA)
+    default = VibeZstd::CCtx.new(workers: 2, thread_pool: VibeZstd::ThreadPool.default)
+    default.compress(DATA)
+    assert_in_child do
+      fresh = VibeZstd::CCtx.new(workers: 2, thread_pool: pool)
+      [shared, default, fresh].all? { |cctx| VibeZstd.decompress(cctx.compress(DATA)) == DATA }
+    end
+  end
+
+  def test_compress_writer_across_fork
+    writer = VibeZstd::CompressWriter.new(StringIO.new, workers: 2)
+    writer.write(DATA)
+    assert_in_child do
+      writer.write("more")
+      false
+    rescue RuntimeError => e
+      e.message.include?("fork")
+    end
+    writer.finish
+  end
+
+  def test_preload
+    samples = 100.times.map { |i| "preload sample #{i} with shared text #{i * 3} " * 3 }
+    dict_data = VibeZstd.train_dict(samples, max_dict_size: 4096)
+    pool = VibeZstd::Pool.new
+    preloaded = VibeZstd.preload!(levels: [1, 3], dicts: [dict_data], pool: pool, contexts: 2)
+    assert_equal [1, 3], preloaded[:cdicts].map { |cdict| cdict.instance_variable_get(:@compression_level) }
+    assert_equal [VibeZstd.get_dict_id(dict_data)], preloaded[:ddicts].map(&:dict_id)
+
+    stats = pool.stats
+    assert_equal 2, stats[:idle_compression_contexts]
+    assert_equal 2, stats[:idle_decompression_contexts]
+
+    cdict = preloaded[:cdicts].last
+    ddict = preloaded[:ddicts].first
+    assert_in_child do
+      frame = pool.compress(samples[7], dict: cdict)
+      pool.decompress(frame, dict: ddict) == samples[7] && pool.stats[:compression_contexts_created] == 2
+    end
+
+    # Ready-made dictionaries are passed through
+    registry = VibeZstd::DictionaryRegistry.new([ddict])
+    again = VibeZstd.preload!(dicts: [cdict, registry], pool: pool)
+    assert_equal [cdict], again[:cdicts]
+    assert_equal [ddict.dict_id], again[:ddicts].map(&:dict_id)
+  end
+end
@@ -0,0 +1,116 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "tmpdir"
+
+class TestRactor < Minitest::Test
+  def setup
+    skip "Ractor not available" unless defined?(Ractor)
+    @experimental = Warning[:experimental]
+    Warning[:experimental] = false
+    samples = 100.times.map { |i| "sample #{i} with common pattern #{i * 7} " * 4 }
+    @dict_data = VibeZstd.train_dict(samples, max_dict_size: 8192)
+    @data = "sample 42 with common pattern 294 " * 64
+  end
+
+  def teardown
+    Warning[:experimental] = @experimental if defined?(Ractor)
+  end
+
+  def test_dictionaries_are_shareable
+    Dir.mktmpdir do |dir|
+      path = File.join(dir, "sample.dict")
+      File.binwrite(path, @dict_data)
+      dicts = [
+        VibeZstd::CDict.new(@dict_data, 5),
+        VibeZstd::CDict.new(+@dict_data, by_reference: true),
+        VibeZstd::CDict.open(path),
+        VibeZstd::DDict.new(@dict_data),
+        VibeZstd::DDict.new(+@dict_data, by_reference: true),
+        VibeZstd::DDict.open(path)
+      ]
+      dicts.each do |dict|
+        assert dict.frozen?
+        assert Ractor.shareable?(dict), "#{dict.class} should be shareable"
+      end
+    end
+  end
+
+  def test_to_ddict_is_cached
+    cdict = VibeZstd::CDict.new(@dict_data)
+    ddict = cdict.to_ddict
+    assert_same ddict, cdict.ddict
+    assert Ractor.shareable?(cdict)
+    assert_equal @data, VibeZstd.decompress(VibeZstd.compress(@data, dict: cdict), dict: ddict)
+
+    # The CDict keeps its own frozen copy: changing the caller's String
+    # afterwards does not change the dictionary to_ddict builds
+    dict_data = +@dict_data
+    cdict = VibeZstd::CDict.new(dict_data)
+    dict_data.replace("changed")
+    assert_equal cdict.dict_id, cdict.to_ddict.dict_id
+  end
+
+  def test_compress_in_ractors
+    cdict = VibeZstd::CDict.new(@dict_data)
+    ddict = cdict.to_ddict
+    ractors = 4.times.map do |i|
+      Ractor.new(cdict, ddict, "#{@data}#{i}") do |c, d, data|
+        results = [
+          VibeZstd.decompress(VibeZstd.compress(data, dict: c), dict: d),
+          VibeZstd::ThreadLocal.decompress(VibeZstd::ThreadLocal.compress(data, dict: c), dict: d),
+          VibeZstd::Pool.default.decompress(VibeZstd::Pool.default.compress(data, level: 9)),
+          *VibeZstd.decompress_many(VibeZstd.compress_many([data] * 3))
+        ]
+        [results, c.to_ddict.equal?(d)]
+      end
+    end
+    ractors.each_with_index do |ractor, i|
+      results, same_ddict = ractor.take
+      results.each { |result| assert_equal "#{@data}#{i}", result }
+      assert same_ddict
+    end
+  end
+
+  def test_default_pools
+    thread_pool = VibeZstd::ThreadPool.default
+    ids = Ractor.new do
+      cctx = VibeZstd::CCtx.new(workers: 2)
+      cctx.thread_pool = VibeZstd::ThreadPool.default
+      cctx.compress("x" * 100_000)
+      [VibeZstd::ThreadPool.default.object_id, VibeZstd::Pool.default.object_id]
+    end.take
+
+    # One ThreadPool for the process, one Pool per Ractor
+    assert_equal thread_pool.object_id, ids[0]
+    refute_equal VibeZstd::Pool.default.object_id, ids[1]
+    assert Ractor.shareable?(thread_pool)
+  end
+
+  def test_class_defaults_are_process_wide
+    VibeZstd::DCtx.default_max_decompressed_size = 1024
+    limit = Ractor.new { VibeZstd::DCtx.default_max_decompressed_size }.take
+    assert_equal 1024, limit
+  ensure
+    VibeZstd::DCtx.default_max_decompressed_size = nil
+  end
+
+  def test_arena_dictionaries_shareable_once_sealed
+    arena = VibeZstd::DictArena.new(1024 * 1024)
+    cdict = arena.cdict(@dict_data)
+    ddict = arena.ddict(@dict_data)
+    assert cdict.frozen?
+    refute Ractor.shareable?(cdict)
+
+    arena.seal
+    assert arena.frozen?
+    assert Ractor.shareable?(cdict)
+    result = Ractor.new(cdict, ddict, @data) { |c, d, data| VibeZstd.decompress(VibeZstd.compress(data, dict: c), dict: d) }.take
+    assert_equal @data, result
+
+    # Freezing an unsealed arena (as Ractor.make_shareable does) stops it growing
+    arena = VibeZstd::DictArena.new(1024 * 1024)
+    Ractor.make_shareable(arena.ddict(@dict_data))
+    assert_raises(FrozenError) { arena.ddict(@dict_data) }
+  end
+end
@@ -0,0 +1,115 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "stringio"
+require "tempfile"
+
+class TestSeekable < Minitest::Test
+  # Exactly size bytes of 19-byte lines
+  def sample_data(size = 300_000)
+    Array.new(size / 19 + 1) { |i| format("event %012d\n", i) }.join.byteslice(0, size)
+  end
+
+  def write_seekable(data, **options)
+    io = StringIO.new(+"".b)
+    VibeZstd::SeekableWriter.open(io, **options) do |writer|
+      data.bytes.each_slice(7_001) { |slice| writer.write(slice.pack("C*")) }
+    end
+    io.string
+  end
+
+  def with_seekable_file(data, **options)
+    Tempfile.create(["seekable", ".zst"]) do |file|
+      file.binmode
+      file.write(write_seekable(data, **options))
+      file.flush
+      yield file.path
+    end
+  end
+
+  def test_output_is_plain_zstd
+    data = sample_data
+    assert_equal data, VibeZstd.decompress(write_seekable(data, frame_size: 32_768))
+  end
+
+  def test_frames_split_at_frame_size
+    data = sample_data(100_000)
+    with_seekable_file(data, frame_size: 10_000) do |path|
+      VibeZstd::SeekableReader.open(path) do |reader|
+        assert_equal 10, reader.frame_count
+        assert_equal data.bytesize, reader.size
+        assert_equal 10_000, reader.frame_decompressed_size(3)
+      end
+    end
+  end
+
+  def test_read_at_random_ranges
+    data = sample_data
+    with_seekable_file(data, frame_size: 16_384, level: 5) do |path|
+      VibeZstd::SeekableReader.open(path) do |reader|
+        rng = Random.new(1)
+        50.times do
+          offset = rng.rand(data.bytesize)
+          length = rng.rand(50_000)
+          assert_equal data.byteslice(offset, length), reader.read_at(offset, length)
+        end
+      end
+    end
+  end
+
+  def test_read_at_boundaries
+    data = sample_data(50_000)
+    with_seekable_file(data, frame_size: 10_000) do |path|
+      reader = VibeZstd::SeekableReader.new(File.open(path, "rb"))
+      assert_equal data.byteslice(9_990, 20), reader.read_at(9_990, 20)
+      # Reads past the end are clamped to the data that is there
+      assert_equal 50_000, data.bytesize
+      tail = reader.read_at(49_990, 100)
+      assert_equal 10, tail.bytesize
+      assert_equal data.byteslice(49_990, 10), tail
+      assert_equal data, reader.read_at(0, data.bytesize)
+      assert_equal "", reader.read_at(10, 0)
+      assert_nil reader.read_at(data.bytesize, 10)
+      assert_raises(ArgumentError) { reader.read_at(-1, 10) }
+    end
+  end
+
+  def test_with_dictionary
+    samples = 200.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\",\"active\":true}" }
+    dict_data = VibeZstd.train_dict(samples)
+    data = samples.join("\n")
+    with_seekable_file(data, frame_size: 512, dict: VibeZstd::CDict.new(dict_data)) do |path|
+      VibeZstd::SeekableReader.open(path, dict: VibeZstd::DDict.new(dict_data)) do |reader|
+        assert_equal data.byteslice(3_000, 1_000), reader.read_at(3_000, 1_000)
+      end
+    end
+  end
+
+  def test_empty_archive
+    with_seekable_file("") do |path|
+      VibeZstd::SeekableReader.open(path) do |reader|
+        assert_equal 0, reader.size
+        assert_equal 0, reader.frame_count
+        assert_nil reader.read_at(0, 10)
+      end
+    end
+  end
+
+  def test_rejects_data_without_seek_table
+    Tempfile.create(["plain", ".zst"]) do |file|
+      file.binmode
+      file.write(VibeZstd.compress(sample_data(1_000)))
+      file.flush
+      assert_raises(VibeZstd::Error) { VibeZstd::SeekableReader.new(file.path) }
+    end
+  end
+
+  def test_writer_argument_validation
+    assert_raises(ArgumentError) { VibeZstd::SeekableWriter.new(StringIO.new, frame_size: 0) }
+    assert_raises(ArgumentError) { VibeZstd::SeekableWriter.new(StringIO.new, pledged_size: 10) }
+
+    writer = VibeZstd::SeekableWriter.new(StringIO.new)
+    writer.finish
+    assert_raises(IOError) { writer.write("late") }
+  end
+end
@@ -730,4 +730,282 @@ class TestStreaming < Minitest::Test
     reader = VibeZstd::DecompressReader.new(wrapper_io)
     assert_equal(data, reader.read_all)
   end
+
+  def test_compress_writer_hands_io_full_buffers
+    data = Random.new(42).bytes(1_000_000)
+    sizes = []
+    sink = Object.new
+    sink.define_singleton_method(:write) { |chunk| sizes << chunk.bytesize }
+
+    writer = VibeZstd::CompressWriter.new(sink, level: 1)
+    writer.write(data)
+    writer.finish
+
+    # Every write except the trailing ones must be a completely filled buffer
+    assert_operator sizes.size, :>=, 2
+    full = sizes.first
+    assert sizes[0...-2].all? { |size| size == full }, "unexpected partial writes: #{sizes.inspect}"
+  end
+
+  def test_compress_writer_concurrent_writers
+    inputs = 4.times.map { |i| ("thread #{i} payload " * 5000) + Random.new(i).bytes(50_000) }
+    outputs = inputs.map do |data|
+      Thread.new do
+        io = StringIO.new
+        writer = VibeZstd::CompressWriter.new(io, level: 9)
+        data.bytes.each_slice(16_384) { |slice| writer.write(slice.pack("C*")) }
+        writer.flush
+        writer.finish
+        io.string
+      end
+    end.map(&:value)
+
+    outputs.zip(inputs).each { |compressed, data| assert_equal data, VibeZstd.decompress(compressed) }
+  end
+
+  def test_compress_writer_threads_share_input_string
+    chunk = "shared chunk " * 10_000
+    outputs = 4.times.map do
+      Thread.new do
+        io = StringIO.new
+        writer = VibeZstd::CompressWriter.new(io, level: 5)
+        20.times { writer.write(chunk) }
+        writer.finish
+        io.string
+      end
+    end.map(&:value)
+
+    outputs.each { |compressed| assert_equal chunk * 20, VibeZstd.decompress(compressed) }
+  end
+
+  def test_compress_writer_rejects_reentrant_use
+    writer = nil
+    sink = Object.new
+    sink.define_singleton_method(:write) { |_chunk| writer.write("nested") }
+    writer = VibeZstd::CompressWriter.new(sink)
+
+    writer.write("hello " * 100)
+    error = assert_raises(RuntimeError) { writer.finish }
+    assert_match(/already in use/, error.message)
+  end
+
+  def test_compress_writer_released_after_io_error
+    data = Random.new(7).bytes(500_000)
+    sink = Object.new
+    sink.define_singleton_method(:write) { |_chunk| raise IOError, "disk full" }
+    writer = VibeZstd::CompressWriter.new(sink)
+
+    assert_raises(IOError) { writer.write(data) }
+    data << "still mutable"
+    # The writer is not left marked busy, so the next call reaches io.write again
+    assert_raises(IOError) { writer.finish }
+  end
+
+  def test_compress_writer_accepts_cctx_parameters
+    data = ("database dump row " * 50 + "\n") * 5_000
+    io = StringIO.new(+"".b)
+    VibeZstd::CompressWriter.open(io, level: 5, workers: 2, job_size: 1 << 20,
+      long_distance_matching: true, window_log: 24, checksum_flag: true, format: 1) do |writer|
+      writer.write(data)
+    end
+    refute io.string.start_with?("\x28\xB5\x2F\xFD".b)
+    assert_equal data, VibeZstd.decompress(io.string, format: 1)
+    assert_raises(RuntimeError) { VibeZstd.decompress(io.string) }
+
+    assert_raises(NoMethodError) { VibeZstd::CompressWriter.new(StringIO.new, bogus: 1) }
+    assert_raises(ArgumentError) { VibeZstd::CompressWriter.new(StringIO.new, window_log: 5) }
+    assert_raises(ArgumentError) { VibeZstd::CompressWriter.new(StringIO.new, stable_in_buffer: true) }
+  end
+
+  def test_compress_writer_auto_workers_use_writer_level
+    # 1.8 MB fans out at level 12 (512 KiB minimum job) but not at the
+    # context's default level 3 (2 MiB), so :auto must see level: 12
+    rng = Random.new(16)
+    words = 4000.times.map { rng.bytes(5).unpack1("H*") }
+    data = Array.new(170_000) { words[rng.rand(4000)] }.join(" ")
+    pool = VibeZstd::ThreadPool.new(4)
+    compress = lambda do |**options|
+      io = StringIO.new(+"".b)
+      VibeZstd::CompressWriter.open(io, level: 12, pledged_size: data.bytesize, thread_pool: pool, **options) do |writer|
+        writer.write(data)
+      end
+      io.string
+    end
+    pick = VibeZstd::CCtx.auto_workers(data.bytesize, level: 12, threads: 4)
+    assert_operator pick[:workers], :>=, 2
+
+    frame = compress.call(workers: :auto)
+    assert_equal compress.call(workers: 4, job_size: pick[:job_size]), frame
+    refute_equal compress.call(workers: 0), frame
+    assert_equal data, VibeZstd.decompress(frame)
+  end
+
+  def test_compress_writer_copies_existing_cctx
+    data = "configured once " * 10_000
+    cctx = VibeZstd::CCtx.new(level: 19, checksum_flag: true)
+    io = StringIO.new(+"".b)
+    writer = VibeZstd::CompressWriter.new(io, cctx: cctx)
+    writer.write(data)
+    # The context stays independent of the open stream
+    assert_equal data, VibeZstd.decompress(cctx.compress(data))
+    writer.finish
+
+    # Frame header descriptor: checksum flag is bit 2
+    assert_equal 0x04, io.string.getbyte(4) & 0x04
+    assert_equal data, VibeZstd.decompress(io.string)
+    assert_equal 19, cctx.level
+    assert_raises(ArgumentError) { VibeZstd::CompressWriter.new(StringIO.new, cctx: cctx, workers: 2) }
+  end
+
+  def test_compress_writer_async
+    rows = 50_000.times.map { |i| "#{i},user#{i},#{i * 7 % 1000},active\n" }
+    io = StringIO.new(+"".b)
+    writer = VibeZstd::CompressWriter.new(io, async: true)
+    assert writer.async?
+    refute VibeZstd::CompressWriter.new(StringIO.new).async?
+
+    # Input is copied before write returns, so the caller may reuse its buffer
+    buffer = +""
+    rows.each_slice(1_000) do |slice|
+      buffer.replace(slice.join)
+      writer.write(buffer)
+    end
+    writer.flush
+    flushed = io.string.bytesize
+    assert_operator flushed, :>, 0
+    writer.finish
+    assert_equal rows.join, VibeZstd.decompress(io.string)
+  end
+
+  def test_decompress_reader_concurrent_readers
+    inputs = 4.times.map { |i| ("reader #{i} line\n" * 20_000) + Random.new(i).bytes(100_000) }
+    outputs = inputs.map do |data|
+      compressed = VibeZstd.compress(data)
+      Thread.new do
+        reader = VibeZstd::DecompressReader.new(StringIO.new(compressed))
+        out = +""
+        while (chunk = reader.read(7_777))
+          out << chunk
+        end
+        out
+      end
+    end.map(&:value)
+
+    assert_equal inputs, outputs
+  end
+
+  def test_decompress_reader_rejects_reentrant_read
+    compressed = VibeZstd.compress(Random.new(5).bytes(400_000))
+    source = StringIO.new(compressed)
+    reader = nil
+    io = Object.new
+    io.define_singleton_method(:read) do |n|
+      reader.read(10) if source.pos > 0
+      source.read(n)
+    end
+    reader = VibeZstd::DecompressReader.new(io)
+
+    reader.read(10)
+    error = assert_raises(RuntimeError) { reader.read(200_000) }
+    assert_match(/already in use/, error.message)
+  end
+
+  def test_decompress_reader_released_after_io_error
+    compressed = VibeZstd.compress(Random.new(3).bytes(500_000))
+    calls = 0
+    io = Object.new
+    io.define_singleton_method(:read) do |n|
+      calls += 1
+      raise IOError, "connection reset" if calls == 2
+      compressed.byteslice((calls - 1) * n, n)
+    end
+    reader = VibeZstd::DecompressReader.new(io)
+
+    assert_raises(IOError) { reader.read(400_000) }
+    # Not left marked busy: the next read reaches the IO again
+    assert reader.read(10)
+  end
+
+  def test_decompress_reader_readahead
+    data = ("readahead line\n" * 50_000) + Random.new(11).bytes(300_000)
+    compressed = VibeZstd.compress(data)
+
+    reader = VibeZstd::DecompressReader.new(StringIO.new(compressed), readahead: 4)
+    out = +""
+    while (chunk = reader.read(3_333))
+      out << chunk
+    end
+    assert_equal data, out
+    assert reader.eof?
+
+    lines = VibeZstd::DecompressReader.new(StringIO.new(VibeZstd.compress("a\nbb\nccc\n" * 10_000)), readahead: 2).each_line.to_a
+    assert_equal 30_000, lines.size
+    assert_equal "ccc\n", lines.last
+  end
+
+  def test_decompress_reader_readahead_small_chunks
+    data = Random.new(12).bytes(200_000)
+    reader = VibeZstd::DecompressReader.new(StringIO.new(VibeZstd.compress(data)), readahead: 1, initial_chunk_size: 1_000)
+    out = +""
+    while (chunk = reader.read)
+      assert_operator chunk.bytesize, :<=, 1_000
+      out << chunk
+    end
+    assert_equal data, out
+  end
+
+  def test_decompress_reader_readahead_errors
+    compressed = VibeZstd.compress(Random.new(13).bytes(500_000))
+    corrupt = compressed.dup
+    corrupt.setbyte(0, 0) # bad magic number
+    reader = VibeZstd::DecompressReader.new(StringIO.new(corrupt), readahead: 2)
+    assert_raises(RuntimeError) { loop { break unless reader.read } }
+
+    assert_raises(ArgumentError) { VibeZstd::DecompressReader.new(StringIO.new(compressed), readahead: 0) }
+    assert_raises(ArgumentError) { VibeZstd::DecompressReader.new(StringIO.new(compressed), readahead: 2, threads: 2) }
+  end
+
+  def test_decompress_reader_readahead_abandoned
+    compressed = VibeZstd.compress(Random.new(14).bytes(1_000_000))
+    # The decoder thread blocks on a full output ring; freeing the reader must stop it
+    10.times { VibeZstd::DecompressReader.new(StringIO.new(compressed), readahead: 1).read(10) }
+    GC.start
+    assert_equal 10, VibeZstd::DecompressReader.new(StringIO.new(compressed), readahead: 1).read(10).bytesize
+  end
+
+  def test_decompress_reader_reads_concatenated_frames
+    parts = ["first frame\n" * 1_000, "", Random.new(15).bytes(300_000), "last\n"]
+    compressed = VibeZstd.write_skippable_frame("header") +
+                 parts.map { |part| VibeZstd.compress(part) }.join +
+                 VibeZstd.write_skippable_frame("trailer", magic_number: 3)
+
+    [{}, { readahead: 2 }].each do |options|
+      frames = []
+      reader = VibeZstd::DecompressReader.new(StringIO.new(compressed), on_frame: ->(index, size) { frames << [index, size] }, **options)
+      out = +""
+      while (chunk = reader.read(5_000))
+        out << chunk
+      end
+      assert_equal parts.join, out
+      assert reader.eof?
+      assert_equal parts.each_with_index.map { |part, i| [i, part.bytesize] }, frames
+    end
+  end
+
+  def test_decompress_reader_reads_seekable_archive
+    data = "seekable line\n" * 20_000
+    io = StringIO.new(+"".b)
+    VibeZstd::SeekableWriter.open(io, frame_size: 64 * 1024) { |writer| writer.write(data) }
+
+    frames = 0
+    reader = VibeZstd::DecompressReader.new(StringIO.new(io.string), on_frame: proc { frames += 1 })
+    assert_equal data.lines, reader.each_line.to_a
+    assert_equal (data.bytesize / (64.0 * 1024)).ceil, frames
+  end
+
+  def test_decompress_reader_on_frame_validation
+    compressed = VibeZstd.compress("data")
+    assert_raises(TypeError) { VibeZstd::DecompressReader.new(StringIO.new(compressed), on_frame: 1) }
+    assert_raises(ArgumentError) { VibeZstd::DecompressReader.new(StringIO.new(compressed), on_frame: proc {}, threads: 2) }
+  end
 end
@@ -0,0 +1,122 @@
+# frozen_string_literal: true
+
+require "test_helper"
+require "stringio"
+
+class TestThreadPool < Minitest::Test
+  def setup
+    # Large enough for several 512 KB jobs per frame
+    @data = Random.new(7).bytes(1024) * 2048
+  end
+
+  def test_threads
+    assert_equal 3, VibeZstd::ThreadPool.new(3).threads
+    assert_operator VibeZstd::ThreadPool.new.threads, :>=, 1
+    assert_raises(ArgumentError) { VibeZstd::ThreadPool.new(0) }
+  end
+
+  def test_default_is_shared
+    assert_same VibeZstd::ThreadPool.default, VibeZstd::ThreadPool.default
+  end
+
+  def test_contexts_share_pool
+    pool = VibeZstd::ThreadPool.new(2)
+    cctxs = 4.times.map { VibeZstd::CCtx.new(workers: 2, job_size: 512 * 1024, thread_pool: pool) }
+    cctxs.each do |cctx|
+      assert_same pool, cctx.thread_pool
+      assert_equal @data, VibeZstd.decompress(cctx.compress(@data))
+    end
+  end
+
+  def test_concurrent_compression_on_shared_pool
+    pool = VibeZstd::ThreadPool.new(2)
+    frames = 4.times.map do
+      Thread.new do
+        cctx = VibeZstd::CCtx.new(workers: 2, thread_pool: pool)
+        data = @data.dup # the source is locked while compressing
+        3.times.map { cctx.compress(data) }
+      end
+    end.flat_map(&:value)
+    frames.each { |frame| assert_equal @data, VibeZstd.decompress(frame) }
+  end
+
+  def test_detach_with_nil
+    cctx = VibeZstd::CCtx.new(workers: 2)
+    cctx.thread_pool = VibeZstd::ThreadPool.new(2)
+    cctx.thread_pool = nil
+    assert_nil cctx.thread_pool
+    assert_equal @data, VibeZstd.decompress(cctx.compress(@data))
+  end
+
+  def test_compress_writer_uses_pool
+    pool = VibeZstd::ThreadPool.new(2)
+    outputs = 3.times.map do
+      io = StringIO.new(+"".b)
+      VibeZstd::CompressWriter.open(io, workers: 2, thread_pool: pool) do |writer|
+        0.step(@data.bytesize - 1, 256 * 1024) { |i| writer.write(@data.byteslice(i, 256 * 1024)) }
+      end
+      io.string
+    end
+    outputs.each { |frame| assert_equal @data, VibeZstd.decompress(frame) }
+  end
+
+  def test_pool_outlives_references
+    cctx = VibeZstd::CCtx.new(workers: 2, thread_pool: VibeZstd::ThreadPool.new(2))
+    GC.start
+    assert_equal @data, VibeZstd.decompress(cctx.compress(@data))
+  end
+
+  def test_workers_cannot_grow_the_pool
+    pool = VibeZstd::ThreadPool.new(2)
+    cctx = VibeZstd::CCtx.new(workers: 32, thread_pool: pool)
+    assert_equal 2, cctx.workers
+    threads_before = os_threads
+    assert_equal @data, VibeZstd.decompress(cctx.compress(@data))
+    cctx.workers = 30
+    assert_equal 2, cctx.workers
+    assert_equal @data, VibeZstd.decompress(cctx.compress(@data))
+    # Only the pool's two threads were started
+    assert_operator os_threads, :<=, threads_before + 2 if threads_before
+    cctx.workers = 0
+    assert_equal 0, cctx.workers
+
+    # Attaching the pool after setting workers applies it too
+    cctx = VibeZstd::CCtx.new(workers: 8)
+    cctx.thread_pool = pool
+    assert_equal 2, cctx.workers
+  end
+
+  def test_auto_workers_use_pool_size
+    cctx = VibeZstd::CCtx.new(workers: :auto, thread_pool: VibeZstd::ThreadPool.new(2))
+    assert_equal @data, VibeZstd.decompress(cctx.compress(@data, level: 19))
+    assert_equal VibeZstd::CCtx.auto_workers(@data.bytesize, level: 19, threads: 2)[:job_size], cctx.job_size
+  end
+
+  def test_auto_workers_share_pool_across_input_sizes
+    # Two :auto contexts on one pool, one compressing inputs that need fewer
+    # jobs than the pool has threads. nbWorkers stays at the pool size (any
+    # other value resizes the shared pool for both); only job_size varies.
+    pool = VibeZstd::ThreadPool.new(4)
+    small = VibeZstd::CCtx.new(workers: :auto, thread_pool: pool)
+    large = VibeZstd::CCtx.new(workers: :auto, thread_pool: pool)
+    inputs = {small => [@data.byteslice(0, 1 << 20), @data.byteslice(0, 100_000)], large => [@data]}
+    results = inputs.map do |cctx, datas|
+      Thread.new { 3.times.flat_map { datas.map { |data| [data, cctx.compress(data, level: 19)] } } }
+    end
+    results.flat_map(&:value).each { |data, frame| assert_equal data, VibeZstd.decompress(frame) }
+
+    small.compress(@data.byteslice(0, 1 << 20), level: 19)
+    assert_equal VibeZstd::CCtx.auto_workers(1 << 20, level: 19, threads: 4)[:job_size], small.job_size
+    large.compress(@data, level: 19)
+    assert_equal VibeZstd::CCtx.auto_workers(@data.bytesize, level: 19, threads: 4)[:job_size], large.job_size
+  end
+
+  # OS threads in this process, where /proc reports them
+  def os_threads
+    Dir.children("/proc/self/task").size if File.directory?("/proc/self/task")
+  end
+
+  def test_rejects_other_objects
+    assert_raises(TypeError) { VibeZstd::CCtx.new.thread_pool = Object.new }
+  end
+end
@@ -1060,6 +1060,70 @@ class TestVibeZstd < Minitest::Test
     VibeZstd::ThreadLocal.clear_thread_cache!
   end
 
+  def test_thread_local_evicts_least_recently_used
+    VibeZstd::ThreadLocal.clear_thread_cache!
+    VibeZstd::ThreadLocal.max_contexts = 2
+    samples = 100.times.map { |i| "{\"id\":#{i},\"name\":\"user#{i}\"}" }
+    cdicts = 3.times.map { |i| VibeZstd::CDict.new(VibeZstd.train_dict(samples.rotate(i * 7))) }
+
+    VibeZstd::ThreadLocal.compress("a", dict: cdicts[0])
+    VibeZstd::ThreadLocal.compress("b", dict: cdicts[1])
+    VibeZstd::ThreadLocal.compress("c", dict: cdicts[0]) # dict 0 becomes most recent
+    VibeZstd::ThreadLocal.compress("d", dict: cdicts[2]) # evicts dict 1
+
+    stats = VibeZstd::ThreadLocal.thread_cache_stats
+    assert_equal 2, stats[:compression_contexts]
+    assert_equal [cdicts[0].dict_id, cdicts[2].dict_id], stats[:compression_keys]
+  ensure
+    VibeZstd::ThreadLocal.max_contexts = VibeZstd::ThreadLocal::DEFAULT_MAX_CONTEXTS
+    VibeZstd::ThreadLocal.clear_thread_cache!
+  end
+
+  def test_thread_local_drops_idle_contexts
+    VibeZstd::ThreadLocal.clear_thread_cache!
+    VibeZstd::ThreadLocal.idle_timeout = 0.05
+    data = "idle trimming " * 1000
+    VibeZstd::ThreadLocal.compress(data, level: 19)
+    high_level_bytes = VibeZstd::ThreadLocal.thread_cache_stats[:compression_bytes]
+    VibeZstd::ThreadLocal.decompress(VibeZstd.compress(data))
+
+    stats = VibeZstd::ThreadLocal.thread_cache_stats
+    assert_operator stats[:compression_bytes], :>, VibeZstd::CCtx.new.memory_size, "level 19 workspace should be reported"
+    assert_operator stats[:decompression_bytes], :>, 0
+
+    sleep 0.1
+    # The next call drops the stale context before checking out a new one
+    VibeZstd::ThreadLocal.compress(data, level: 1)
+    stats = VibeZstd::ThreadLocal.thread_cache_stats
+    assert_equal 1, stats[:compression_contexts]
+    assert_operator stats[:compression_bytes], :<, high_level_bytes
+
+    sleep 0.1
+    assert_equal 2, VibeZstd::ThreadLocal.trim!
+    assert_equal 0, VibeZstd::ThreadLocal.thread_cache_stats[:decompression_contexts]
+  ensure
+    VibeZstd::ThreadLocal.idle_timeout = VibeZstd::ThreadLocal::DEFAULT_IDLE_TIMEOUT
+    VibeZstd::ThreadLocal.clear_thread_cache!
+  end
+
+  def test_thread_local_trim_all_threads
+    VibeZstd::ThreadLocal.clear_thread_cache!
+    ready = Queue.new
+    done = Queue.new
+    worker = Thread.new do
+      VibeZstd::ThreadLocal.compress("from another thread")
+      ready << true
+      done.pop
+      VibeZstd::ThreadLocal.thread_cache_stats[:compression_contexts]
+    end
+    ready.pop
+    assert_equal 0, VibeZstd::ThreadLocal.trim!(3600, all_threads: true)
+    assert_equal 1, VibeZstd::ThreadLocal.trim!(0, all_threads: true)
+    done << true
+    assert_equal 0, worker.value
+    assert_raises(ArgumentError) { VibeZstd::ThreadLocal.max_contexts = 0 }
+  end
+
   def test_decompress_reader_gets_with_multi_char_separator
     require "stringio"
 
@@ -1081,4 +1145,18 @@ class TestVibeZstd < Minitest::Test
     assert_equal(["a||", "b||", "c"], pieces,
       "gets with '||' separator should split the stream into three pieces")
   end
+
+  def test_native_memory_usage_tracks_contexts
+    GC.start
+    before = VibeZstd.native_memory_usage
+    contexts = 4.times.map do
+      VibeZstd::CCtx.new(compression_level: 19).tap { |cctx| cctx.compress("x" * 100_000) }
+    end
+    held = VibeZstd.native_memory_usage
+    assert_operator held - before, :>, 4 * 1_000_000, "level 19 contexts should be counted"
+
+    contexts = nil
+    GC.start
+    assert_operator VibeZstd.native_memory_usage, :<, held, "freed contexts should be uncounted"
+  end
 end